@@ -2,6 +2,13 @@ QT += core network sql concurrent
 CONFIG += c++14 console
 CONFIG -= app_bundle
 
+# 响应压缩使用 Qt 自带的 zlib（<QtZlib/zlib.h>，符号由 QtCore 导出），Windows MinGW 套件无需系统 zlib
+# Qt 以系统 zlib 构建时（configure -system-zlib，多数 Linux 发行版）没有 QtZlib 头文件，改用系统库
+qtConfig(system-zlib) {
+    DEFINES += PARKING_SYSTEM_ZLIB
+    LIBS += -lz
+}
+
 TEMPLATE = app
 
 SOURCES += \
@@ -13,16 +20,32 @@ SOURCES += \
     core/Router.cpp \
     core/Middleware.cpp \
     core/JsonBodyParser.cpp \
+    core/JsonWriter.cpp \
+    core/JsonReader.cpp \
+    core/FieldMask.cpp \
+    core/ResponseCompressor.cpp \
+    core/EventStreamHub.cpp \
+    core/WebSocketSession.cpp \
+    core/DeferredResponse.cpp \
+    core/SingleFlight.cpp \
+    core/CacheMiddleware.cpp \
     core/ErrorHandler.cpp \
     api/ApiRegister.cpp \
     api/ApiResponse.cpp \
     controllers/CarController.cpp \
     controllers/SpaceController.cpp \
     controllers/ReportController.cpp \
+    controllers/ExportController.cpp \
+    controllers/StreamController.cpp \
     services/CarService.cpp \
     services/SpaceService.cpp \
     services/BillingService.cpp \
     services/QueueProcessor.cpp \
+    services/SpaceJsonCache.cpp \
+    services/SpaceEventPublisher.cpp \
+    services/QueueWaitRegistry.cpp \
+    services/DashboardMaterializer.cpp \
+    services/ReportExecutor.cpp \
     models/Car.cpp \
     models/ParkingRecord.cpp \
     models/ParkingSpace.cpp \
@@ -30,9 +53,19 @@ SOURCES += \
     dao/SpaceRepository.cpp \
     dao/ParkingRecordRepository.cpp \
     dao/QueueRepository.cpp \
+    dao/ActiveSessionIndex.cpp \
+    dao/SpaceSnapshot.cpp \
+    dao/ParkingRecordCursor.cpp \
+    dao/RollupRepository.cpp \
+    dao/RevenueIndex.cpp \
+    dao/DatabaseSchema.cpp \
     utils/DateTimeUtil.cpp \
     utils/JsonUtil.cpp \
-    utils/Logger.cpp
+    utils/Logger.cpp \
+    utils/GateLock.cpp \
+    utils/PlateId.cpp \
+    utils/PlateValidator.cpp \
+    utils/DataVersion.cpp
 
 HEADERS += \
     ParkingServerApplication.h \
@@ -42,16 +75,33 @@ HEADERS += \
     core/Router.h \
     core/Middleware.h \
     core/JsonBodyParser.h \
+    core/JsonWriter.h \
+    core/JsonReader.h \
+    core/FieldMask.h \
+    core/ResponseCompressor.h \
+    core/EventStreamHub.h \
+    core/WebSocketSession.h \
+    core/DeferredResponse.h \
+    core/SingleFlight.h \
+    core/CacheMiddleware.h \
     core/ErrorHandler.h \
     api/ApiRegister.h \
     api/ApiResponse.h \
+    api/RequestDto.h \
     controllers/CarController.h \
     controllers/SpaceController.h \
     controllers/ReportController.h \
+    controllers/ExportController.h \
+    controllers/StreamController.h \
     services/CarService.h \
     services/SpaceService.h \
     services/BillingService.h \
     services/QueueProcessor.h \
+    services/SpaceJsonCache.h \
+    services/SpaceEventPublisher.h \
+    services/QueueWaitRegistry.h \
+    services/DashboardMaterializer.h \
+    services/ReportExecutor.h \
     models/Car.h \
     models/ParkingRecord.h \
     models/ParkingSpace.h \
@@ -59,9 +109,20 @@ HEADERS += \
     dao/SpaceRepository.h \
     dao/ParkingRecordRepository.h \
     dao/QueueRepository.h \
+    dao/ActiveSessionIndex.h \
+    dao/SpaceSnapshot.h \
+    dao/ParkingRecordCursor.h \
+    dao/RollupRepository.h \
+    dao/RevenueIndex.h \
+    dao/DatabaseSchema.h \
+    dao/WriteResult.h \
     utils/DateTimeUtil.h \
     utils/JsonUtil.h \
-    utils/Logger.h
+    utils/Logger.h \
+    utils/GateLock.h \
+    utils/PlateId.h \
+    utils/PlateValidator.h \
+    utils/DataVersion.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
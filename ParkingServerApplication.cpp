@@ -6,6 +6,15 @@
 #include "services/CarService.h"
 #include "services/SpaceService.h"
 #include "services/BillingService.h"
+#include "services/QueueProcessor.h"
+#include "services/SpaceEventPublisher.h"
+#include "services/QueueWaitRegistry.h"
+#include "services/DashboardMaterializer.h"
+#include "dao/ParkingRecordRepository.h"
+#include "dao/SpaceRepository.h"
+#include "dao/RollupRepository.h"
+#include "dao/RevenueIndex.h"
+#include "dao/DatabaseSchema.h"
 #include "controllers/CarController.h"
 #include "controllers/SpaceController.h"
 #include "controllers/ReportController.h"
@@ -64,6 +73,24 @@ bool ParkingServerApplication::initialize()
     return true;
 }
 
+bool ParkingServerApplication::rebuildRollups()
+{
+    LOG_INFO("Rebuilding rollup tables...");
+    
+    if (!initializeDatabase()) {
+        LOG_ERROR("Failed to initialize database");
+        return false;
+    }
+    
+    if (!RollupRepository::instance().rebuild()) {
+        LOG_ERROR("Failed to rebuild rollup tables");
+        return false;
+    }
+    
+    LOG_INFO("Rollup tables rebuilt successfully");
+    return true;
+}
+
 bool ParkingServerApplication::startServer()
 {
     if (m_isRunning) {
@@ -90,6 +117,8 @@ bool ParkingServerApplication::startServer()
 
 void ParkingServerApplication::stopServer()
 {
+    QueueProcessor::instance().stop();
+    
     if (m_server && m_server->isRunning()) {
         m_server->stop();
         m_isRunning = false;
@@ -159,122 +188,7 @@ bool ParkingServerApplication::createDatabaseTables()
         return false;
     }
     
-    QSqlQuery query(db);
-    
-    // 创建车辆表 - 与Car模型保持一致
-    QString createCarTable = R"(
-        CREATE TABLE IF NOT EXISTS cars (
-            plate TEXT PRIMARY KEY,
-            type TEXT DEFAULT '小型车',
-            color TEXT,
-            create_time DATETIME DEFAULT CURRENT_TIMESTAMP,
-            update_time DATETIME DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-    
-    if (!query.exec(createCarTable)) {
-        LOG_ERROR("Failed to create cars table: " + query.lastError().text());
-        return false;
-    }
-    
-    // 创建停车位表 - 与ParkingSpace模型保持一致
-    QString createSpaceTable = R"(
-        CREATE TABLE IF NOT EXISTS parking_spaces (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            location TEXT NOT NULL,
-            status TEXT DEFAULT 'available',
-            current_plate TEXT,
-            occupied_time DATETIME,
-            type TEXT DEFAULT '普通',
-            hourly_rate REAL DEFAULT 5.0
-        )
-    )";
-    
-    if (!query.exec(createSpaceTable)) {
-        LOG_ERROR("Failed to create spaces table: " + query.lastError().text());
-        return false;
-    }
-    
-    // 创建停车记录表 - 与ParkingRecord模型保持一致
-    QString createParkingRecordTable = R"(
-        CREATE TABLE IF NOT EXISTS parking_records (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            plate TEXT NOT NULL,
-            space_id INTEGER NOT NULL,
-            enter_time DATETIME NOT NULL,
-            exit_time DATETIME,
-            fee REAL DEFAULT 0.0,
-            is_paid INTEGER DEFAULT 0,
-            pay_time DATETIME,
-            pay_method TEXT,
-            FOREIGN KEY (plate) REFERENCES cars(plate),
-            FOREIGN KEY (space_id) REFERENCES parking_spaces(id)
-        )
-    )";
-    
-    if (!query.exec(createParkingRecordTable)) {
-        LOG_ERROR("Failed to create parking_records table: " + query.lastError().text());
-        return false;
-    }
-    
-    // 创建支付记录表
-    QString createPaymentTable = R"(
-        CREATE TABLE IF NOT EXISTS payments (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            parking_record_id INTEGER NOT NULL,
-            amount REAL NOT NULL,
-            payment_method TEXT NOT NULL,
-            payment_time DATETIME DEFAULT CURRENT_TIMESTAMP,
-            status TEXT DEFAULT '已完成',
-            transaction_id TEXT,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            FOREIGN KEY (parking_record_id) REFERENCES parking_records(id)
-        )
-    )";
-    
-    if (!query.exec(createPaymentTable)) {
-        LOG_ERROR("Failed to create payments table: " + query.lastError().text());
-        return false;
-    }
-    
-    // 创建计费规则表
-    QString createBillingTable = R"(
-        CREATE TABLE IF NOT EXISTS billing_rules (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            rule_name TEXT NOT NULL,
-            space_type TEXT DEFAULT '普通',
-            hourly_rate REAL DEFAULT 5.0,
-            daily_rate REAL DEFAULT 50.0,
-            monthly_rate REAL DEFAULT 800.0,
-            night_rate REAL DEFAULT 3.0,
-            weekend_rate REAL DEFAULT 6.0,
-            holiday_rate REAL DEFAULT 8.0,
-            min_fee REAL DEFAULT 5.0,
-            max_fee REAL DEFAULT 200.0,
-            is_active INTEGER DEFAULT 1,
-            effective_date DATETIME DEFAULT CURRENT_TIMESTAMP,
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
-        )
-    )";
-    
-    if (!query.exec(createBillingTable)) {
-        LOG_ERROR("Failed to create billing_rules table: " + query.lastError().text());
-        return false;
-    }
-    
-    // 创建排队表
-    QString createQueueTable = R"(
-        CREATE TABLE IF NOT EXISTS parking_queue (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            plate TEXT NOT NULL,
-            queue_time DATETIME DEFAULT CURRENT_TIMESTAMP,
-            UNIQUE(plate)
-        )
-    )";
-    
-    if (!query.exec(createQueueTable)) {
-        LOG_ERROR("Failed to create parking_queue table: " + query.lastError().text());
+    if (!DatabaseSchema::create(db)) {
         return false;
     }
     
@@ -388,6 +302,22 @@ bool ParkingServerApplication::initializeServices()
     SpaceService& spaceService = SpaceService::instance();
     BillingService& billingService = BillingService::instance();
     
+    // 加载活跃停车会话索引（失败时查询退回数据库）
+    if (!ParkingRecordRepository::instance().loadActiveSessions()) {
+        LOG_WARNING("Active session index not loaded, active session lookups will query the database");
+    }
+    
+    // 加载车位快照（失败时查询退回数据库）
+    if (!SpaceRepository::instance().loadSnapshot()) {
+        LOG_WARNING("Space snapshot not loaded, space queries will use the database");
+    }
+    
+    // 由小时汇总构建收入前缀和索引（汇总未回填时跳过）
+    RevenueIndex::instance().load();
+    
+    // 启动排队调度线程
+    QueueProcessor::instance().start();
+    
     LOG_INFO("Services initialized successfully");
     return true;
 }
@@ -415,6 +345,8 @@ bool ParkingServerApplication::initializeHttpServer()
     m_server->setPort(8080);
     m_server->setMaxConnections(100);
     m_server->setRequestTimeout(30000); // 30秒
+    m_server->setCompressionLevel(6);     // zlib 级别，0 关闭压缩
+    m_server->setCompressionThreshold(1024);
     
     // 创建并设置路由器 - 这是关键步骤！
     Router* router = new Router(this);
@@ -440,6 +372,13 @@ bool ParkingServerApplication::registerApiRoutes()
         return false;
     }
     
+    // 车位/排队变化推送到 SSE、WebSocket 订阅者和长轮询请求
+    SpaceEventPublisher::instance().attach(m_server->eventHub());
+    QueueWaitRegistry::instance().attach();
+    
+    // 仪表板在后台物化，随领域事件增量更新
+    DashboardMaterializer::instance().attach();
+    
     LOG_INFO("API routes registered successfully");
     return true;
 }
@@ -17,6 +17,9 @@ public:
     ~ParkingServerApplication();
 
     bool initialize();
+    
+    // 只初始化数据库并按全部停车记录重建汇总表（--rebuild-rollups）
+    bool rebuildRollups();
     bool startServer();
     void stopServer();
     bool isRunning() const;
@@ -1,6 +1,10 @@
 #include "ApiRegister.h"
 #include "../api/ApiResponse.h"
 #include "../utils/Logger.h"
+#include "../core/SingleFlight.h"
+#include "../services/DashboardMaterializer.h"
+#include "../services/ReportExecutor.h"
+#include "../dao/RevenueIndex.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -46,6 +50,18 @@ void ApiRegister::registerRoutes(Router& router)
     // 注册报告统计路由
     registerReportRoutes(router);
     
+    // 注册数据导出路由
+    registerExportRoutes(router);
+    registerStreamRoutes(router);
+    
+    // 领域事件使缓存的响应失效
+    registerCacheInvalidation();
+    
+    // 高频且计算量大的只读接口：并发的相同请求合并执行
+    router.coalesce("/api/spaces/statistics/usage");
+    // 详细报告在合并执行的线程中等待并行的子报表，不阻塞事件循环
+    router.coalesce("/api/reports/detailed");
+    
     Logger::info("All API routes registered");
 }
 
@@ -65,6 +81,12 @@ void ApiRegister::registerSystemRoutes(Router& router)
         this->handleApiInfo(req, res);
     });
     
+    // 运行指标
+    Router* routerPtr = &router;
+    router.get("/api/metrics", {}, [this, routerPtr](const HttpRequest& req, HttpResponse& res) {
+        this->handleMetrics(*routerPtr, req, res);
+    });
+    
     Logger::info("System routes registered");
 }
 
@@ -81,12 +103,12 @@ void ApiRegister::registerCarRoutes(Router& router)
     });
     
     // 获取所有车辆
-    router.get("/api/cars", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/cars", {cached(30000, {"cars"})}, [](const HttpRequest& req, HttpResponse& res) {
         CarController::instance().getAllCars(req, res);
     });
     
     // 按类型获取车辆
-    router.get("/api/cars/type/:type", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/cars/type/:type", {cached(30000, {"cars"})}, [](const HttpRequest& req, HttpResponse& res) {
         CarController::instance().getCarsByType(req, res);
     });
     
@@ -102,7 +124,7 @@ void ApiRegister::registerCarRoutes(Router& router)
 
     
     // 车辆统计
-    router.get("/api/cars/statistics/overview", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/cars/statistics/overview", {cached(30000, {"cars"})}, [](const HttpRequest& req, HttpResponse& res) {
         CarController::instance().getStatistics(req, res);
     });
     
@@ -127,7 +149,7 @@ void ApiRegister::registerSpaceRoutes(Router& router)
     });
     
     // 获取所有停车位
-    router.get("/api/spaces", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/spaces", {cached(5000, {"spaces"})}, [](const HttpRequest& req, HttpResponse& res) {
         SpaceController::instance().getAllSpaces(req, res);
     });
     
@@ -172,12 +194,12 @@ void ApiRegister::registerSpaceRoutes(Router& router)
     });
     
     // 停车位统计
-    router.get("/api/spaces/statistics/overview", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/spaces/statistics/overview", {cached(5000, {"spaces"})}, [](const HttpRequest& req, HttpResponse& res) {
         SpaceController::instance().getStatistics(req, res);
     });
     
     // 停车位使用率统计
-    router.get("/api/spaces/statistics/usage", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/spaces/statistics/usage", {cached(10000, {"spaces", "records"})}, [](const HttpRequest& req, HttpResponse& res) {
         SpaceController::instance().getUsageStatistics(req, res);
     });
     
@@ -186,28 +208,38 @@ void ApiRegister::registerSpaceRoutes(Router& router)
         SpaceController::instance().joinQueue(req, res);
     });
     
+    // 排队调度统计
+    router.get("/api/queue/statistics", {}, [](const HttpRequest& req, HttpResponse& res) {
+        SpaceController::instance().getQueueStatistics(req, res);
+    });
+    
+    // 长轮询等待排队位置变化
+    router.get("/api/queue/:plate/wait", {}, [](const HttpRequest& req, HttpResponse& res) {
+        SpaceController::instance().waitQueuePosition(req, res);
+    });
+    
     Logger::info("Space routes registered");
 }
 
 void ApiRegister::registerReportRoutes(Router& router)
 {
     // 收入报告
-    router.get("/api/reports/revenue", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/revenue", {cached(30000, {"records"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getRevenueReport(req, res);
     });
     
     // 停车统计报告
-    router.get("/api/reports/parking", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/parking", {cached(30000, {"records"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getParkingStatistics(req, res);
     });
     
     // 支付统计报告
-    router.get("/api/reports/payment", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/payment", {cached(30000, {"records"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getPaymentStatistics(req, res);
     });
     
     // 空间使用率报告
-    router.get("/api/reports/space-usage", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/space-usage", {cached(30000, {"spaces", "records"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getSpaceUsageReport(req, res);
     });
     
@@ -217,22 +249,22 @@ void ApiRegister::registerReportRoutes(Router& router)
     });
     
     // 车辆统计报告
-    router.get("/api/reports/car-statistics", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/car-statistics", {cached(30000, {"cars", "records"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getCarStatistics(req, res);
     });
     
     // 车辆类型分布报告
-    router.get("/api/reports/car-type-distribution", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/car-type-distribution", {cached(30000, {"cars"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getCarTypeDistribution(req, res);
     });
     
     // 欠费报告
-    router.get("/api/reports/unpaid", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/unpaid", {cached(30000, {"records"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getUnpaidReport(req, res);
     });
     
     // 逾期报告
-    router.get("/api/reports/overdue", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/overdue", {cached(10000, {"records"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getOverdueReport(req, res);
     });
     
@@ -242,7 +274,7 @@ void ApiRegister::registerReportRoutes(Router& router)
     });
     
     // 详细报告
-    router.get("/api/reports/detailed", {}, [](const HttpRequest& req, HttpResponse& res) {
+    router.get("/api/reports/detailed", {cached(30000, {"spaces", "cars", "records"})}, [](const HttpRequest& req, HttpResponse& res) {
         ReportController::instance().getDetailedReport(req, res);
     });
     
@@ -254,6 +286,68 @@ void ApiRegister::registerReportRoutes(Router& router)
     Logger::info("Report routes registered");
 }
 
+void ApiRegister::registerExportRoutes(Router& router)
+{
+    // 停车记录导出（流式，NDJSON/CSV）
+    router.get("/api/export/records", {}, [](const HttpRequest& req, HttpResponse& res) {
+        ExportController::instance().exportRecords(req, res);
+    });
+    
+    Logger::info("Export routes registered");
+}
+
+void ApiRegister::registerStreamRoutes(Router& router)
+{
+    // 车位变化事件流
+    router.get("/api/stream/spaces", {}, [](const HttpRequest& req, HttpResponse& res) {
+        StreamController::instance().streamSpaces(req, res);
+    });
+    
+    // 排队位置事件流
+    router.get("/api/stream/queue/:plate", {}, [](const HttpRequest& req, HttpResponse& res) {
+        StreamController::instance().streamQueue(req, res);
+    });
+    
+    Logger::info("Stream routes registered");
+}
+
+Middleware* ApiRegister::cached(int ttlMs, const QStringList& tags)
+{
+    m_cacheMiddlewares.emplace_back(new CacheMiddleware(m_responseCache, ttlMs, tags));
+    return m_cacheMiddlewares.back().get();
+}
+
+void ApiRegister::registerCacheInvalidation()
+{
+    // 直接连接：在发出信号的线程（包括调度线程）立即失效，缓存本身线程安全
+    auto invalidate = [this](const QStringList& tags) {
+        return [this, tags]() {
+            for (const QString& tag : tags) {
+                m_responseCache.invalidate(tag);
+            }
+        };
+    };
+    
+    SpaceService& spaceService = SpaceService::instance();
+    connect(&spaceService, &SpaceService::spaceAdded, this, invalidate({"spaces"}), Qt::DirectConnection);
+    connect(&spaceService, &SpaceService::spaceUpdated, this, invalidate({"spaces"}), Qt::DirectConnection);
+    connect(&spaceService, &SpaceService::spaceDeleted, this, invalidate({"spaces"}), Qt::DirectConnection);
+    connect(&spaceService, &SpaceService::spaceOccupied, this, invalidate({"spaces", "records"}), Qt::DirectConnection);
+    connect(&spaceService, &SpaceService::spaceReleased, this, invalidate({"spaces", "records"}), Qt::DirectConnection);
+    
+    BillingService& billingService = BillingService::instance();
+    connect(&billingService, &BillingService::parkingStarted, this, invalidate({"records"}), Qt::DirectConnection);
+    connect(&billingService, &BillingService::parkingEnded, this, invalidate({"records"}), Qt::DirectConnection);
+    connect(&billingService, &BillingService::paymentProcessed, this, invalidate({"records"}), Qt::DirectConnection);
+    
+    CarService& carService = CarService::instance();
+    connect(&carService, &CarService::carRegistered, this, invalidate({"cars"}), Qt::DirectConnection);
+    connect(&carService, &CarService::carUpdated, this, invalidate({"cars"}), Qt::DirectConnection);
+    connect(&carService, &CarService::carDeleted, this, invalidate({"cars"}), Qt::DirectConnection);
+    
+    Logger::info("Response cache invalidation registered");
+}
+
 void ApiRegister::handleHealthCheck(const HttpRequest& request, HttpResponse& response)
 {
     QJsonObject health;
@@ -265,6 +359,21 @@ void ApiRegister::handleHealthCheck(const HttpRequest& request, HttpResponse& re
     response.ok(health);
 }
 
+void ApiRegister::handleMetrics(Router& router, const HttpRequest& request, HttpResponse& response)
+{
+    Q_UNUSED(request);
+    
+    QJsonObject metrics;
+    metrics["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    metrics["singleFlight"] = router.singleFlight()->statistics();
+    metrics["responseCache"] = m_responseCache.statistics();
+    metrics["dashboard"] = DashboardMaterializer::instance().statistics();
+    metrics["reportExecutor"] = ReportExecutor::instance().statistics();
+    metrics["revenueIndex"] = RevenueIndex::instance().statistics();
+    
+    response.ok(ApiResponse::success(metrics));
+}
+
 void ApiRegister::handleApiInfo(const HttpRequest& request, HttpResponse& response)
 {
     QJsonObject info;
@@ -279,6 +388,7 @@ void ApiRegister::handleApiInfo(const HttpRequest& request, HttpResponse& respon
     QJsonArray systemEndpoints;
     systemEndpoints.append(QJsonObject{{"path", "/api/health"}, {"method", "GET"}, {"description", "Health check"}});
     systemEndpoints.append(QJsonObject{{"path", "/api/info"}, {"method", "GET"}, {"description", "API information"}});
+    systemEndpoints.append(QJsonObject{{"path", "/api/metrics"}, {"method", "GET"}, {"description", "Runtime metrics"}});
     endpoints["system"] = systemEndpoints;
     
     // 车辆管理端点
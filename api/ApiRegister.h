@@ -7,6 +7,11 @@
 #include "../controllers/CarController.h"
 #include "../controllers/SpaceController.h"
 #include "../controllers/ReportController.h"
+#include "../controllers/ExportController.h"
+#include "../controllers/StreamController.h"
+#include "../core/CacheMiddleware.h"
+#include <memory>
+#include <vector>
 
 class ApiRegister : public QObject
 {
@@ -35,14 +40,30 @@ private:
     // 报告统计API
     void registerReportRoutes(Router& router);
     
+    // 数据导出API
+    void registerExportRoutes(Router& router);
+    
+    // 事件流API（SSE）
+    void registerStreamRoutes(Router& router);
+    
     // 系统API
     void registerSystemRoutes(Router& router);
     
+    // 响应缓存：按路由的 TTL 和标签创建缓存中间件
+    Middleware* cached(int ttlMs, const QStringList& tags);
+    void registerCacheInvalidation();
+    
     // 健康检查
     void handleHealthCheck(const HttpRequest& request, HttpResponse& response);
     
     // API信息
     void handleApiInfo(const HttpRequest& request, HttpResponse& response);
+    
+    // 运行指标（请求合并等）
+    void handleMetrics(Router& router, const HttpRequest& request, HttpResponse& response);
+    
+    ResponseCache m_responseCache;
+    std::vector<std::unique_ptr<CacheMiddleware>> m_cacheMiddlewares;
 };
 
 #endif // APIREGISTER_H
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef REQUESTDTO_H
+#define REQUESTDTO_H
+
+#include <QString>
+
+// 请求体 DTO：字段在 bind() 中声明一次，由 HttpRequest::bindBody() 单遍解码填充
+// 必填/可选和缺失提示与改用 DTO 之前各处理器的校验一致，业务校验仍在处理器中
+
+// 添加/更新停车位
+struct SpaceRequest
+{
+    QString location;
+    QString type;
+    double hourlyRate = 0.0;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.missingMessage("Missing required fields: location, type, hourlyRate");
+        b.required("location", location);
+        b.required("type", type);
+        b.required("hourlyRate", hourlyRate);
+    }
+};
+
+// 占用停车位
+struct OccupyRequest
+{
+    QString plate;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.required("plate", plate);
+    }
+};
+
+// 更新停车位状态
+struct SpaceStatusRequest
+{
+    QString status;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.required("status", status);
+    }
+};
+
+// 加入排队（缺少车牌由处理器返回 "Plate number is required"）
+struct JoinQueueRequest
+{
+    QString plate;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.optional("plate", plate);
+    }
+};
+
+// 注册车辆
+struct RegisterCarRequest
+{
+    QString plate;
+    QString type;
+    QString color;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.missingMessage("Missing required fields: plate, type, owner");
+        b.required("plate", plate);
+        b.optional("type", type);
+        b.optional("color", color);
+    }
+};
+
+// 更新车辆信息
+struct UpdateCarRequest
+{
+    QString type;
+    QString owner;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.missingMessage("Missing required fields: type, owner");
+        b.required("type", type);
+        b.required("owner", owner);
+    }
+};
+
+// 支付停车费用（缺少或无效的 recordId 由处理器返回 "Invalid record ID"）
+struct PaymentRequest
+{
+    int recordId = 0;
+    QString paymentMethod;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.optional("recordId", recordId);
+        b.optional("paymentMethod", paymentMethod);
+    }
+};
+
+#endif // REQUESTDTO_H
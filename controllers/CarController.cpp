@@ -1,7 +1,9 @@
 #include "CarController.h"
 #include "../api/ApiResponse.h"
+#include "../api/RequestDto.h"
 #include "../utils/Logger.h"
 #include "../utils/JsonUtil.h"
+#include "../utils/PlateValidator.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -17,28 +19,17 @@ void CarController::registerCar(const HttpRequest& request, HttpResponse& respon
 {
     try {
         // 解析请求体
-        qDebug() << "api HTTP Request Body Raw:" << request.bodyRaw;
-        
-        QJsonDocument doc = QJsonDocument::fromJson(request.bodyRaw);
-        qDebug() << "api HTTP Request Body JSON:" << doc;
-        Logger::info("1");
-        if (!doc.isObject()) {
-            Logger::info("Invalid JSON format");
-            response.badRequest("Invalid JSON format");
+        RegisterCarRequest body;
+        QString error;
+        if (!request.bindBody(body, error)) {
+            Logger::info(QString("Invalid car registration body: %1").arg(error));
+            response.badRequest(error);
             return;
         }
         
-        QJsonObject body = doc.object();
-        Logger::info("2");
-        // 验证必填字段
-        if (!body.contains("plate")) {
-            response.badRequest("Missing required fields: plate, type, owner");
-            return;
-        }
-        Logger::info("3");
-        QString plate = body["plate"].toString().trimmed().toUpper();
-        QString type = body["type"].toString().trimmed().toLower();
-        QString color = body["color"].toString().trimmed();
+        QString plate = PlateValidator::normalize(body.plate);
+        QString type = body.type.trimmed().toLower();
+        QString color = body.color.trimmed();
         
         // 验证字段格式
         if (plate.isEmpty()) {
@@ -48,7 +39,7 @@ void CarController::registerCar(const HttpRequest& request, HttpResponse& respon
         
         // 调用服务层
         QJsonObject result = CarService::instance().registerCar(plate, type, color);
-        Logger::info("4");
+
         // 设置响应
         if (result["code"] == 0) {
             response.ok(result);
@@ -96,17 +87,13 @@ void CarController::getAllCars(const HttpRequest& request, HttpResponse& respons
 {
     try {
         // 调用服务层
-        QJsonArray cars = CarService::instance().getAllCars();
+        QByteArray body;
+        int count = CarService::instance().writeAllCars(body);
         
-        QJsonObject result;
-        result["success"] = true;
-        result["data"] = cars;
-        result["count"] = cars.size();
-        result["message"] = "Cars retrieved successfully";
+        response.setStatusCode(200);
+        response.rawJson(body);
         
-        response.ok(result);
-        
-        Logger::info("Get all cars request");
+        Logger::info(QString("Get all cars request: count=%1").arg(count));
         
     } catch (const std::exception& e) {
         Logger::error(QString("Error in getAllCars: %1").arg(e.what()));
@@ -158,22 +145,15 @@ void CarController::updateCar(const HttpRequest& request, HttpResponse& response
         }
         
         // 解析请求体
-        QJsonDocument doc = QJsonDocument::fromJson(request.bodyRaw);
-        if (!doc.isObject()) {
-            response.badRequest("Invalid JSON format");
-            return;
-        }
-        
-        QJsonObject body = doc.object();
-        
-        // 验证必填字段
-        if (!body.contains("type") || !body.contains("owner")) {
-            response.badRequest("Missing required fields: type, owner");
+        UpdateCarRequest body;
+        QString error;
+        if (!request.bindBody(body, error)) {
+            response.badRequest(error);
             return;
         }
         
-        QString type = body["type"].toString().trimmed().toLower();
-        QString owner = body["owner"].toString().trimmed();
+        QString type = body.type.trimmed().toLower();
+        QString owner = body.owner.trimmed();
         
         // 验证字段格式
         if (type.isEmpty() || owner.isEmpty()) {
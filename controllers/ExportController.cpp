@@ -0,0 +1,173 @@
+#include "ExportController.h"
+#include "../core/JsonWriter.h"
+#include "../dao/ParkingRecordRepository.h"
+#include "../utils/Logger.h"
+#include <QLocale>
+#include <memory>
+
+ExportController& ExportController::instance()
+{
+    static ExportController instance;
+    return instance;
+}
+
+void ExportController::exportRecords(const HttpRequest& request, HttpResponse& response)
+{
+    try {
+        QString format = request.getQueryParam("format").toLower();
+        if (format.isEmpty()) {
+            format = "ndjson";
+        }
+        if (format != "ndjson" && format != "csv") {
+            response.badRequest("Invalid format, expected ndjson or csv");
+            return;
+        }
+
+        QString fromStr = request.getQueryParam("from");
+        QString toStr = request.getQueryParam("to");
+        QDateTime from = fromStr.isEmpty() ? QDateTime(QDate(1970, 1, 1), QTime(0, 0)) : parseBound(fromStr, false);
+        QDateTime to = toStr.isEmpty() ? QDateTime::currentDateTime() : parseBound(toStr, true);
+        if (!from.isValid() || !to.isValid() || from > to) {
+            response.badRequest("Invalid date range");
+            return;
+        }
+
+        std::shared_ptr<ParkingRecordCursor> cursor(ParkingRecordRepository::instance().openCursor(from, to).release());
+        if (!cursor->isValid()) {
+            response.serverError("Failed to open export cursor");
+            return;
+        }
+
+        bool csv = format == "csv";
+        auto headerPending = std::make_shared<bool>(csv);
+
+        response.setStatusCode(200);
+        response.setHeader("Content-Disposition",
+                           QString("attachment; filename=\"parking_records.%1\"").arg(format));
+        response.stream(csv ? "text/csv; charset=utf-8" : "application/x-ndjson",
+                        [cursor, csv, headerPending](QByteArray& chunk) {
+            if (*headerPending) {
+                chunk.append("id,plate,space_id,enter_time,exit_time,fee,is_paid,pay_time,pay_method\r\n");
+                *headerPending = false;
+            }
+
+            chunk.reserve(CHUNK_SIZE + 512);
+            while (chunk.size() < CHUNK_SIZE) {
+                if (!cursor->nextRow()) {
+                    Logger::info(QString("Export finished: %1 records").arg(cursor->rowsRead()));
+                    return false;
+                }
+                if (csv) {
+                    writeCsvRow(*cursor, chunk);
+                } else {
+                    writeNdjsonRow(*cursor, chunk);
+                }
+            }
+            // 下一段要等 socket 发送缓冲区回落后才生产，期间不能占着读锁
+            cursor->suspend();
+            return true;
+        });
+
+        Logger::info(QString("Export records request: format=%1, from=%2, to=%3")
+                     .arg(format, from.toString(Qt::ISODate), to.toString(Qt::ISODate)));
+
+    } catch (const std::exception& e) {
+        Logger::error(QString("Error in exportRecords: %1").arg(e.what()));
+        response.serverError("Internal server error");
+    }
+}
+
+QDateTime ExportController::parseBound(const QString& value, bool endOfDay)
+{
+    QDateTime dateTime = QDateTime::fromString(value, Qt::ISODate);
+    if (dateTime.isValid() && value.contains('T')) {
+        return dateTime;
+    }
+
+    QDate date = QDate::fromString(value, Qt::ISODate);
+    if (!date.isValid()) {
+        return QDateTime();
+    }
+    return endOfDay ? QDateTime(date, QTime(23, 59, 59, 999)) : QDateTime(date, QTime(0, 0));
+}
+
+void ExportController::writeNdjsonRow(const ParkingRecordCursor& cursor, QByteArray& out)
+{
+    // 时间列按数据库中存储的字符串原样输出，不逐行解析为 QDateTime
+    const QSqlQuery& row = cursor.row();
+    QVariant exitTime = row.value(ParkingRecordCursor::COL_EXIT_TIME);
+    QVariant payTime = row.value(ParkingRecordCursor::COL_PAY_TIME);
+
+    JsonWriter writer(out);
+    writer.beginObject();
+    writer.field("id", row.value(ParkingRecordCursor::COL_ID).toInt());
+    writer.field("plate", row.value(ParkingRecordCursor::COL_PLATE).toString());
+    writer.field("spaceId", row.value(ParkingRecordCursor::COL_SPACE_ID).toInt());
+    writer.field("enterTime", row.value(ParkingRecordCursor::COL_ENTER_TIME).toString());
+    writer.key("exitTime");
+    if (exitTime.isNull()) {
+        writer.null();
+    } else {
+        writer.value(exitTime.toString());
+    }
+    writer.field("fee", row.value(ParkingRecordCursor::COL_FEE).toDouble());
+    writer.field("isPaid", row.value(ParkingRecordCursor::COL_IS_PAID).toInt() != 0);
+    writer.key("payTime");
+    if (payTime.isNull()) {
+        writer.null();
+    } else {
+        writer.value(payTime.toString());
+    }
+    writer.field("payMethod", row.value(ParkingRecordCursor::COL_PAY_METHOD).toString());
+    writer.endObject();
+    out.append('\n');
+}
+
+void ExportController::writeCsvRow(const ParkingRecordCursor& cursor, QByteArray& out)
+{
+    const QSqlQuery& row = cursor.row();
+    out.append(QByteArray::number(row.value(ParkingRecordCursor::COL_ID).toInt()));
+    out.append(',');
+    appendCsvField(row.value(ParkingRecordCursor::COL_PLATE).toString(), out);
+    out.append(',');
+    out.append(QByteArray::number(row.value(ParkingRecordCursor::COL_SPACE_ID).toInt()));
+    out.append(',');
+    appendCsvField(row.value(ParkingRecordCursor::COL_ENTER_TIME).toString(), out);
+    out.append(',');
+    appendCsvField(row.value(ParkingRecordCursor::COL_EXIT_TIME).toString(), out);
+    out.append(',');
+    out.append(QByteArray::number(row.value(ParkingRecordCursor::COL_FEE).toDouble(), 'g', QLocale::FloatingPointShortest));
+    out.append(',');
+    out.append(row.value(ParkingRecordCursor::COL_IS_PAID).toInt() != 0 ? '1' : '0');
+    out.append(',');
+    appendCsvField(row.value(ParkingRecordCursor::COL_PAY_TIME).toString(), out);
+    out.append(',');
+    appendCsvField(row.value(ParkingRecordCursor::COL_PAY_METHOD).toString(), out);
+    out.append("\r\n");
+}
+
+void ExportController::appendCsvField(const QString& field, QByteArray& out)
+{
+    QByteArray utf8 = field.toUtf8();
+    bool needsQuotes = false;
+    for (char c : utf8) {
+        if (c == ',' || c == '"' || c == '\r' || c == '\n') {
+            needsQuotes = true;
+            break;
+        }
+    }
+
+    if (!needsQuotes) {
+        out.append(utf8);
+        return;
+    }
+
+    out.append('"');
+    for (char c : utf8) {
+        if (c == '"') {
+            out.append('"');
+        }
+        out.append(c);
+    }
+    out.append('"');
+}
@@ -0,0 +1,36 @@
+#ifndef EXPORTCONTROLLER_H
+#define EXPORTCONTROLLER_H
+
+#include <QObject>
+#include <QDateTime>
+#include "../core/HttpRequest.h"
+#include "../core/HttpResponse.h"
+
+class ParkingRecordCursor;
+
+class ExportController : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ExportController& instance();
+
+    // 按进场时间范围流式导出停车记录（NDJSON 或 CSV）
+    void exportRecords(const HttpRequest& request, HttpResponse& response);
+
+private:
+    ExportController() = default;
+    ExportController(const ExportController&) = delete;
+    ExportController& operator=(const ExportController&) = delete;
+
+    // 解析 from/to；仅给出日期时 to 取当天结束
+    static QDateTime parseBound(const QString& value, bool endOfDay);
+
+    static void writeNdjsonRow(const ParkingRecordCursor& cursor, QByteArray& out);
+    static void writeCsvRow(const ParkingRecordCursor& cursor, QByteArray& out);
+    static void appendCsvField(const QString& field, QByteArray& out);
+
+    static const int CHUNK_SIZE = 64 * 1024;
+};
+
+#endif // EXPORTCONTROLLER_H
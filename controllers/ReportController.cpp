@@ -1,11 +1,16 @@
 #include "ReportController.h"
 #include "../api/ApiResponse.h"
+#include "../api/RequestDto.h"
 #include "../utils/Logger.h"
 #include "../utils/JsonUtil.h"
+#include "../utils/DataVersion.h"
+#include "../services/DashboardMaterializer.h"
+#include "../services/ReportExecutor.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDateTime>
+#include <stdexcept>
 
 ReportController& ReportController::instance()
 {
@@ -130,12 +135,21 @@ void ReportController::getSpaceUsageReport(const HttpRequest& request, HttpRespo
 void ReportController::getOccupancyRate(const HttpRequest& request, HttpResponse& response)
 {
     try {
+        // 条件请求：数据版本未变时直接返回 304，不做查询和序列化
+        QString etag = DataVersion::etag(DataVersion::instance().current());
+        if (request.matchesETag(etag)) {
+            response.notModified(etag);
+            return;
+        }
+        
         // 获取基本统计信息
         QJsonObject result = SpaceService::instance().getStatistics();
         
         // 设置响应
         if (result["code"] == 0) {
             response.ok(result);
+            response.setHeader("ETag", etag);
+            response.setHeader("Cache-Control", "no-cache");
         } else {
             response.badRequest("Failed to retrieve occupancy rate");
         }
@@ -193,18 +207,22 @@ void ReportController::getCarTypeDistribution(const HttpRequest& request, HttpRe
 void ReportController::getUnpaidReport(const HttpRequest& request, HttpResponse& response)
 {
     try {
-        // 获取未支付记录
-        QJsonArray unpaidRecords = BillingService::instance().getUnpaidRecords();
+        // 字段投影
+        FieldMask fields;
+        QString error;
+        if (!BillingService::parseFieldMask(request.getQueryParam("fields"), fields, error)) {
+            response.badRequest(error);
+            return;
+        }
         
-        QJsonObject result;
-        result["success"] = true;
-        result["data"] = unpaidRecords;
-        result["count"] = unpaidRecords.size();
-        result["message"] = "Unpaid records retrieved successfully";
+        // 获取未支付记录
+        QByteArray body;
+        int count = BillingService::instance().writeUnpaidRecords(body, fields);
         
-        response.ok(result);
+        response.setStatusCode(200);
+        response.rawJson(body);
         
-        Logger::info(QString("Unpaid report request: count=%1").arg(unpaidRecords.size()));
+        Logger::info(QString("Unpaid report request: count=%1").arg(count));
         
     } catch (const std::exception& e) {
         Logger::error(QString("Error in getUnpaidReport: %1").arg(e.what()));
@@ -223,40 +241,22 @@ void ReportController::getOverdueReport(const HttpRequest& request, HttpResponse
             return;
         }
         
-        // 获取指定时间范围内的停车记录
-        QJsonArray records = BillingService::instance().getAllParkingRecords(1000);
-        
-        QJsonArray overdueRecords;
-        QDateTime now = QDateTime::currentDateTime();
-        
-        for (const QJsonValue& value : records) {
-            QJsonObject record = value.toObject();
-            
-            // 检查是否欠费（停车结束超过24小时且未完全支付）
-            if (record.contains("endTime") && !record["endTime"].toString().isEmpty()) {
-                QDateTime endTime = QDateTime::fromString(record["endTime"].toString(), Qt::ISODate);
-                if (endTime.isValid() && endTime.secsTo(now) > 24 * 3600) { // 超过24小时
-                    double fee = record["fee"].toDouble();
-                    double paidAmount = record["paidAmount"].toDouble();
-                    if (paidAmount < fee) {
-                        QJsonObject overdueRecord = record;
-                        overdueRecord["overdueDays"] = endTime.daysTo(now);
-                        overdueRecord["unpaidAmount"] = fee - paidAmount;
-                        overdueRecords.append(overdueRecord);
-                    }
-                }
-            }
+        // 字段投影
+        FieldMask fields;
+        QString error;
+        if (!BillingService::parseFieldMask(request.getQueryParam("fields"), fields, error)) {
+            response.badRequest(error);
+            return;
         }
         
-        QJsonObject result;
-        result["success"] = true;
-        result["data"] = overdueRecords;
-        result["count"] = overdueRecords.size();
-        result["message"] = "Overdue records retrieved successfully";
+        // 欠费判定与序列化在服务层一次完成，直接写入响应体
+        QByteArray body;
+        int count = BillingService::instance().writeOverdueRecords(body, 1000, fields);
         
-        response.ok(result);
+        response.setStatusCode(200);
+        response.rawJson(body);
         
-        Logger::info(QString("Overdue report request: count=%1").arg(overdueRecords.size()));
+        Logger::info(QString("Overdue report request: count=%1").arg(count));
         
     } catch (const std::exception& e) {
         Logger::error(QString("Error in getOverdueReport: %1").arg(e.what()));
@@ -267,7 +267,15 @@ void ReportController::getOverdueReport(const HttpRequest& request, HttpResponse
 void ReportController::getDashboardSummary(const HttpRequest& request, HttpResponse& response)
 {
     try {
-        // 生成仪表板数据
+        // 后台物化的结果已是完整响应体，直接返回
+        std::shared_ptr<const QByteArray> materialized = DashboardMaterializer::instance().current();
+        if (materialized) {
+            response.setStatusCode(200);
+            response.rawJson(*materialized);
+            return;
+        }
+        
+        // 首次物化完成前同步生成
         QJsonObject dashboardData = generateDashboardData();
         
         QJsonObject result;
@@ -296,15 +304,39 @@ void ReportController::getDetailedReport(const HttpRequest& request, HttpRespons
             return;
         }
         
+        int deadlineMs = ReportExecutor::DEFAULT_DEADLINE_MS;
+        QString deadlineStr = request.getQueryParam("deadlineMs");
+        if (!deadlineStr.isEmpty()) {
+            bool ok = false;
+            deadlineMs = deadlineStr.toInt(&ok);
+            if (!ok || deadlineMs <= 0 || deadlineMs > ReportExecutor::MAX_DEADLINE_MS) {
+                response.badRequest(QString("deadlineMs must be between 1 and %1").arg(ReportExecutor::MAX_DEADLINE_MS));
+                return;
+            }
+        }
+        
         // 生成详细报告数据
-        QJsonObject detailedData = generateDetailedData(startTime, endTime);
+        QJsonObject detailedData = generateDetailedData(startTime, endTime, deadlineMs);
+        if (detailedData.isEmpty()) {
+            response.serverError("Report workers busy, please retry");
+            response.setStatusCode(503);
+            response.setHeader("Retry-After", "5");
+            response.setHeader("Cache-Control", "no-store");
+            return;
+        }
+        bool partial = detailedData["partial"].toBool();
         
         QJsonObject result;
         result["success"] = true;
         result["data"] = detailedData;
-        result["message"] = "Detailed report generated successfully";
+        result["message"] = partial ? "Detailed report generated with partial results"
+                                    : "Detailed report generated successfully";
         
         response.ok(result);
+        if (partial) {
+            // 部分结果不进入响应缓存
+            response.setHeader("Cache-Control", "no-store");
+        }
         
         Logger::info(QString("Detailed report request: start=%1, end=%2")
                     .arg(startTime.toString(Qt::ISODate))
@@ -366,59 +398,103 @@ QJsonObject ReportController::generateDashboardData()
     
     // 系统状态
     dashboard["systemTime"] = now.toString(Qt::ISODate);
+    dashboard["generatedAt"] = now.toString(Qt::ISODate);
     dashboard["serverStatus"] = "running";
     
     return dashboard;
 }
 
-QJsonObject ReportController::generateDetailedData(const QDateTime& startTime, const QDateTime& endTime)
+namespace {
+
+// 服务方法返回 ApiResponse 外壳，出错时转为异常交给执行器记为失败
+QJsonObject dataOf(const QJsonObject& apiResponse)
+{
+    if (apiResponse["code"].toInt() != 0) {
+        throw std::runtime_error(apiResponse["msg"].toString().toStdString());
+    }
+    return apiResponse["data"].toObject();
+}
+
+}
+
+QJsonObject ReportController::generateDetailedData(const QDateTime& startTime, const QDateTime& endTime, int deadlineMs)
 {
-    QJsonObject detailed;
+    // 各子报表互相独立，并行执行，总耗时接近最慢的一个
+    ReportExecutor::TaskList tasks;
     
     // 收入统计
-    QJsonObject revenueStats = BillingService::instance().getRevenueStatistics(startTime, endTime)["data"].toObject();
-    detailed["revenue"] = revenueStats;
+    tasks.append({"revenue", [startTime, endTime](const ReportExecutor::Cancellation&) -> QJsonValue {
+        return dataOf(BillingService::instance().getRevenueStatistics(startTime, endTime));
+    }});
     
     // 停车统计
-    QJsonObject parkingStats = BillingService::instance().getParkingStatistics(startTime, endTime)["data"].toObject();
-    detailed["parking"] = parkingStats;
+    tasks.append({"parking", [startTime, endTime](const ReportExecutor::Cancellation&) -> QJsonValue {
+        return dataOf(BillingService::instance().getParkingStatistics(startTime, endTime));
+    }});
     
     // 支付统计
-    QJsonObject paymentStats = BillingService::instance().getPaymentStatistics(startTime, endTime)["data"].toObject();
-    detailed["payment"] = paymentStats;
+    tasks.append({"payment", [startTime, endTime](const ReportExecutor::Cancellation&) -> QJsonValue {
+        return dataOf(BillingService::instance().getPaymentStatistics(startTime, endTime));
+    }});
     
     // 空间使用率
-    QJsonObject usageStats = SpaceService::instance().getUsageStatistics()["data"].toObject();
-    detailed["spaceUsage"] = usageStats;
+    tasks.append({"spaceUsage", [](const ReportExecutor::Cancellation&) -> QJsonValue {
+        return dataOf(SpaceService::instance().getUsageStatistics());
+    }});
     
     // 车辆统计
-    QJsonObject carStats = CarService::instance().getStatistics()["data"].toObject();
-    detailed["cars"] = carStats;
+    tasks.append({"cars", [](const ReportExecutor::Cancellation&) -> QJsonValue {
+        return dataOf(CarService::instance().getStatistics());
+    }});
     
     // 欠费统计
-    QJsonArray unpaidRecords = BillingService::instance().getUnpaidRecords();
-    
-    double totalUnpaid = 0;
-    QJsonObject unpaidByPlate;
-    
-    for (const QJsonValue& value : unpaidRecords) {
-        QJsonObject record = value.toObject();
-        QString plate = record["plate"].toString();
-        double unpaidAmount = record["unpaidAmount"].toDouble();
-        
-        totalUnpaid += unpaidAmount;
-        
-        if (!unpaidByPlate.contains(plate)) {
-            unpaidByPlate[plate] = 0;
+    tasks.append({"unpaid", [](const ReportExecutor::Cancellation& cancellation) -> QJsonValue {
+        // 逐页读取未支付记录，每页之间检查取消，超时后不再继续查询
+        std::unique_ptr<ParkingRecordCursor> cursor = ParkingRecordRepository::instance().openNewestFirstCursor(true);
+        
+        double totalUnpaid = 0;
+        int totalCount = 0;
+        QJsonObject unpaidByPlate;
+        
+        ParkingRecord row;
+        while (cursor->next(row)) {
+            QJsonObject record = BillingService::instance().recordToJson(row);
+            QString plate = record["plate"].toString();
+            double unpaidAmount = record["unpaidAmount"].toDouble();
+            
+            totalUnpaid += unpaidAmount;
+            totalCount++;
+            
+            if (!unpaidByPlate.contains(plate)) {
+                unpaidByPlate[plate] = 0;
+            }
+            unpaidByPlate[plate] = unpaidByPlate[plate].toDouble() + unpaidAmount;
+            
+            if (cursor->rowsRead() % ParkingRecordCursor::PAGE_SIZE == 0) {
+                cancellation.throwIfCancelled();
+            }
         }
-        unpaidByPlate[plate] = unpaidByPlate[plate].toDouble() + unpaidAmount;
+        
+        QJsonObject unpaidStats;
+        unpaidStats["totalUnpaid"] = totalUnpaid;
+        unpaidStats["totalCount"] = totalCount;
+        unpaidStats["byPlate"] = unpaidByPlate;
+        return unpaidStats;
+    }});
+    
+    ReportExecutor::Outcome outcome = ReportExecutor::instance().run(tasks, deadlineMs);
+    if (outcome.rejected) {
+        // 报表线程已被占满，返回空对象由调用方回复 503
+        return QJsonObject();
     }
+    QJsonObject detailed = outcome.results;
     
-    QJsonObject unpaidStats;
-    unpaidStats["totalUnpaid"] = totalUnpaid;
-    unpaidStats["totalCount"] = unpaidRecords.size();
-    unpaidStats["byPlate"] = unpaidByPlate;
-    detailed["unpaid"] = unpaidStats;
+    // 部分结果：未按时完成或失败的子报表不出现在结果中，在此列出
+    detailed["partial"] = outcome.isPartial();
+    detailed["timedOut"] = outcome.timedOut;
+    detailed["failed"] = outcome.failed;
+    detailed["timings"] = outcome.timings;
+    detailed["elapsedMs"] = outcome.elapsedMs;
     
     // 报告元数据
     detailed["reportPeriod"] = QJsonObject{
@@ -434,15 +510,15 @@ void ReportController::processPayment(const HttpRequest& request, HttpResponse&
 {
     try {
         // 从请求体获取参数
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(request.bodyRaw);
-        if (!jsonDoc.isObject()) {
-            response.badRequest("Invalid JSON format");
+        PaymentRequest body;
+        QString error;
+        if (!request.bindBody(body, error)) {
+            response.badRequest(error);
             return;
         }
         
-        QJsonObject json = jsonDoc.object();
-        int recordId = json["recordId"].toInt();
-        QString paymentMethod = json["paymentMethod"].toString();
+        int recordId = body.recordId;
+        QString paymentMethod = body.paymentMethod;
         
         if (recordId <= 0) {
             response.badRequest("Invalid record ID");
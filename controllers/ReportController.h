@@ -47,7 +47,8 @@ private:
     
     QPair<QDateTime, QDateTime> parseDateRange(const HttpRequest& request);
     QJsonObject generateDashboardData();
-    QJsonObject generateDetailedData(const QDateTime& startTime, const QDateTime& endTime);
+    // 报表线程已占满、未执行时返回空对象
+    QJsonObject generateDetailedData(const QDateTime& startTime, const QDateTime& endTime, int deadlineMs);
 };
 
 #endif // REPORTCONTROLLER_H
\ No newline at end of file
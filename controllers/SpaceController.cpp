@@ -1,7 +1,13 @@
 #include "SpaceController.h"
 #include "../api/ApiResponse.h"
+#include "../api/RequestDto.h"
 #include "../utils/Logger.h"
 #include "../utils/JsonUtil.h"
+#include "../utils/PlateValidator.h"
+#include "../utils/DataVersion.h"
+#include "../services/QueueProcessor.h"
+#include "../services/QueueWaitRegistry.h"
+#include "../dao/QueueRepository.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -17,23 +23,16 @@ void SpaceController::addSpace(const HttpRequest& request, HttpResponse& respons
 {
     try {
         // 解析请求体
-        QJsonDocument doc = QJsonDocument::fromJson(request.bodyRaw);
-        if (!doc.isObject()) {
-            response.badRequest("Invalid JSON format");
+        SpaceRequest body;
+        QString error;
+        if (!request.bindBody(body, error)) {
+            response.badRequest(error);
             return;
         }
         
-        QJsonObject body = doc.object();
-        
-        // 验证必填字段
-        if (!body.contains("location") || !body.contains("type") || !body.contains("hourlyRate")) {
-            response.badRequest("Missing required fields: location, type, hourlyRate");
-            return;
-        }
-        
-        QString location = body["location"].toString().trimmed();
-        QString type = body["type"].toString().trimmed().toLower();
-        double hourlyRate = body["hourlyRate"].toDouble();
+        QString location = body.location.trimmed();
+        QString type = body.type.trimmed().toLower();
+        double hourlyRate = body.hourlyRate;
         
         // 验证字段格式
         if (location.isEmpty() || type.isEmpty() || hourlyRate <= 0) {
@@ -78,24 +77,16 @@ void SpaceController::updateSpace(const HttpRequest& request, HttpResponse& resp
         }
         
         // 解析请求体
-        QJsonDocument doc = QJsonDocument::fromJson(request.bodyRaw);
-        if (!doc.isObject()) {
-            response.badRequest("Invalid JSON format");
-            return;
-        }
-        
-        QJsonObject body = doc.object();
-        
-        // 验证必填字段
-        if (!body.contains("location") || !body.contains("type") || !body.contains("hourlyRate")) {
-            response.badRequest("Missing required fields: location, type, hourlyRate");
+        SpaceRequest body;
+        QString error;
+        if (!request.bindBody(body, error)) {
+            response.badRequest(error);
             return;
         }
         
-        QString location = body["location"].toString().trimmed();
-        QString type = body["type"].toString().trimmed().toLower();
-        double hourlyRate = body["hourlyRate"].toDouble();
-        QString status = body["status"].toString().trimmed();
+        QString location = body.location.trimmed();
+        QString type = body.type.trimmed().toLower();
+        double hourlyRate = body.hourlyRate;
         
         // 验证字段格式
         if (location.isEmpty() || type.isEmpty() || hourlyRate <= 0) {
@@ -194,16 +185,19 @@ void SpaceController::getSpaceInfo(const HttpRequest& request, HttpResponse& res
 void SpaceController::getAllSpaces(const HttpRequest& request, HttpResponse& response)
 {
     try {
-        // 调用服务层
-        QJsonArray spaces = SpaceService::instance().getAllSpaces();
+        // 字段投影
+        FieldMask fields;
+        QString error;
+        if (!SpaceService::parseFieldMask(request.getQueryParam("fields"), fields, error)) {
+            response.badRequest(error);
+            return;
+        }
         
-        QJsonObject result;
-        result["success"] = true;
-        result["data"] = spaces;
-        result["count"] = spaces.size();
-        result["message"] = "Spaces retrieved successfully";
+        // 调用服务层
+        int count = 0;
+        QByteArray spaces = SpaceService::instance().getAllSpacesEncoded(count, fields);
         
-        response.ok(result);
+        response.okList(spaces, count, "Spaces retrieved successfully");
         
         Logger::info("Get all spaces request");
         
@@ -227,16 +221,19 @@ void SpaceController::getSpacesByStatus(const HttpRequest& request, HttpResponse
             return;
         }
         
-        // 调用服务层
-        QJsonArray spaces = SpaceService::instance().getSpacesByStatus(status);
+        // 字段投影
+        FieldMask fields;
+        QString error;
+        if (!SpaceService::parseFieldMask(request.getQueryParam("fields"), fields, error)) {
+            response.badRequest(error);
+            return;
+        }
         
-        QJsonObject result;
-        result["success"] = true;
-        result["data"] = spaces;
-        result["count"] = spaces.size();
-        result["message"] = QString("Spaces with status '%1' retrieved successfully").arg(status);
+        // 调用服务层
+        int count = 0;
+        QByteArray spaces = SpaceService::instance().getSpacesByStatusEncoded(status, count, fields);
         
-        response.ok(result);
+        response.okList(spaces, count, QString("Spaces with status '%1' retrieved successfully").arg(status));
         
         Logger::info(QString("Get spaces by status request: status=%1").arg(status));
         
@@ -249,16 +246,28 @@ void SpaceController::getSpacesByStatus(const HttpRequest& request, HttpResponse
 void SpaceController::getAvailableSpaces(const HttpRequest& request, HttpResponse& response)
 {
     try {
-        // 调用服务层
-        QJsonArray spaces = SpaceService::instance().getAvailableSpaces();
+        // 条件请求：数据版本未变时直接返回 304，不做查询和序列化
+        QString etag = DataVersion::etag(DataVersion::instance().current());
+        if (request.matchesETag(etag)) {
+            response.notModified(etag);
+            return;
+        }
         
-        QJsonObject result;
-        result["success"] = true;
-        result["data"] = spaces;
-        result["count"] = spaces.size();
-        result["message"] = "Available spaces retrieved successfully";
+        // 字段投影
+        FieldMask fields;
+        QString error;
+        if (!SpaceService::parseFieldMask(request.getQueryParam("fields"), fields, error)) {
+            response.badRequest(error);
+            return;
+        }
         
-        response.ok(result);
+        // 调用服务层
+        int count = 0;
+        QByteArray spaces = SpaceService::instance().getAvailableSpacesEncoded(count, fields);
+        
+        response.okList(spaces, count, "Available spaces retrieved successfully");
+        response.setHeader("ETag", etag);
+        response.setHeader("Cache-Control", "no-cache");
         
         Logger::info("Get available spaces request");
         
@@ -271,16 +280,19 @@ void SpaceController::getAvailableSpaces(const HttpRequest& request, HttpRespons
 void SpaceController::getOccupiedSpaces(const HttpRequest& request, HttpResponse& response)
 {
     try {
+        // 字段投影
+        FieldMask fields;
+        QString error;
+        if (!SpaceService::parseFieldMask(request.getQueryParam("fields"), fields, error)) {
+            response.badRequest(error);
+            return;
+        }
+        
         // 调用服务层
-        QJsonArray spaces = SpaceService::instance().getOccupiedSpaces();
+        int count = 0;
+        QByteArray spaces = SpaceService::instance().getOccupiedSpacesEncoded(count, fields);
         
-        QJsonObject result;
-        result["success"] = true;
-        result["data"] = spaces;
-        result["count"] = spaces.size();
-        result["message"] = "Occupied spaces retrieved successfully";
-        
-        response.ok(result);
+        response.okList(spaces, count, "Occupied spaces retrieved successfully");
         
         Logger::info("Get occupied spaces request");
         
@@ -308,21 +320,14 @@ void SpaceController::occupySpace(const HttpRequest& request, HttpResponse& resp
         }
         
         // 解析请求体
-        QJsonDocument doc = QJsonDocument::fromJson(request.bodyRaw);
-        if (!doc.isObject()) {
-            response.badRequest("Invalid JSON format");
-            return;
-        }
-        
-        QJsonObject body = doc.object();
-        
-        // 验证必填字段
-        if (!body.contains("plate")) {
-            response.badRequest("Missing required field: plate");
+        OccupyRequest body;
+        QString error;
+        if (!request.bindBody(body, error)) {
+            response.badRequest(error);
             return;
         }
         
-        QString plate = body["plate"].toString().trimmed().toUpper();
+        QString plate = PlateValidator::normalize(body.plate);
         
         // 验证车牌号格式
         if (plate.isEmpty()) {
@@ -401,21 +406,14 @@ void SpaceController::updateSpaceStatus(const HttpRequest& request, HttpResponse
         }
         
         // 解析请求体
-        QJsonDocument doc = QJsonDocument::fromJson(request.bodyRaw);
-        if (!doc.isObject()) {
-            response.badRequest("Invalid JSON format");
+        SpaceStatusRequest body;
+        QString error;
+        if (!request.bindBody(body, error)) {
+            response.badRequest(error);
             return;
         }
         
-        QJsonObject body = doc.object();
-        
-        // 验证必填字段
-        if (!body.contains("status")) {
-            response.badRequest("Missing required field: status");
-            return;
-        }
-        
-        QString status = body["status"].toString().trimmed().toLower();
+        QString status = body.status.trimmed().toLower();
         
         // 验证状态值
         QStringList validStatuses = {"available", "occupied", "reserved", "maintenance"};
@@ -445,12 +443,21 @@ void SpaceController::updateSpaceStatus(const HttpRequest& request, HttpResponse
 void SpaceController::getStatistics(const HttpRequest& request, HttpResponse& response)
 {
     try {
+        // 条件请求：数据版本未变时直接返回 304，不做查询和序列化
+        QString etag = DataVersion::etag(DataVersion::instance().current());
+        if (request.matchesETag(etag)) {
+            response.notModified(etag);
+            return;
+        }
+        
         // 调用服务层
         QJsonObject result = SpaceService::instance().getStatistics();
         
         // 设置响应
         if (result["code"] == 0) {
             response.ok(result);
+            response.setHeader("ETag", etag);
+            response.setHeader("Cache-Control", "no-cache");
         } else {
             response.badRequest(result["msg"].toString());
         }
@@ -566,14 +573,14 @@ void SpaceController::joinQueue(const HttpRequest& request, HttpResponse& respon
 {
     try {
         // 从请求体获取车牌号
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(request.bodyRaw);
-        if (!jsonDoc.isObject()) {
-            response.badRequest("Invalid JSON format");
+        JoinQueueRequest body;
+        QString error;
+        if (!request.bindBody(body, error)) {
+            response.badRequest(error);
             return;
         }
         
-        QJsonObject json = jsonDoc.object();
-        QString plate = json["plate"].toString();
+        QString plate = PlateValidator::normalize(body.plate);
         
         if (plate.isEmpty()) {
             response.badRequest("Plate number is required");
@@ -596,3 +603,63 @@ void SpaceController::joinQueue(const HttpRequest& request, HttpResponse& respon
         response.serverError("Internal server error");
     }
 }
+
+
+void SpaceController::getQueueStatistics(const HttpRequest& request, HttpResponse& response)
+{
+    try {
+        // 调度统计（分配延迟、批次大小）
+        QJsonObject stats = QueueProcessor::instance().getDispatchStatistics();
+        stats["queueLength"] = QueueRepository::instance().count();
+        
+        response.ok(ApiResponse::success(stats));
+        
+        Logger::info("Get queue statistics request");
+        
+    } catch (const std::exception& e) {
+        Logger::error(QString("Error in getQueueStatistics: %1").arg(e.what()));
+        response.serverError("Internal server error");
+    }
+}
+
+void SpaceController::waitQueuePosition(const HttpRequest& request, HttpResponse& response)
+{
+    try {
+        QString plate = PlateValidator::normalize(request.getPathParam("plate"));
+        if (!PlateValidator::isValid(plate)) {
+            response.badRequest("Invalid plate number");
+            return;
+        }
+        
+        // since 为上次响应中的 version；缺省时立即返回当前位置
+        quint64 since = 0;
+        QString sinceStr = request.getQueryParam("since");
+        if (!sinceStr.isEmpty()) {
+            bool ok = false;
+            since = sinceStr.toULongLong(&ok);
+            if (!ok) {
+                response.badRequest("Invalid since parameter");
+                return;
+            }
+        }
+        
+        // timeout 单位为秒
+        int timeoutMs = QueueWaitRegistry::DEFAULT_TIMEOUT_MS;
+        QString timeoutStr = request.getQueryParam("timeout");
+        if (!timeoutStr.isEmpty()) {
+            bool ok = false;
+            int seconds = timeoutStr.toInt(&ok);
+            if (!ok || seconds <= 0) {
+                response.badRequest("Invalid timeout parameter");
+                return;
+            }
+            timeoutMs = qMin(seconds, QueueWaitRegistry::MAX_TIMEOUT_MS / 1000) * 1000;
+        }
+        
+        QueueWaitRegistry::instance().wait(plate, since, timeoutMs, response);
+        
+    } catch (const std::exception& e) {
+        Logger::error(QString("Error in waitQueuePosition: %1").arg(e.what()));
+        response.serverError("Internal server error");
+    }
+}
\ No newline at end of file
@@ -41,6 +41,10 @@ public:
     
     // 排队系统
     void joinQueue(const HttpRequest& request, HttpResponse& response);
+    void getQueueStatistics(const HttpRequest& request, HttpResponse& response);
+    
+    // 长轮询等待排队位置或分配结果变化
+    void waitQueuePosition(const HttpRequest& request, HttpResponse& response);
 
 private:
     SpaceController() = default;
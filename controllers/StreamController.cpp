@@ -0,0 +1,53 @@
+#include "StreamController.h"
+#include "../core/EventStreamHub.h"
+#include "../services/SpaceEventPublisher.h"
+#include "../utils/PlateValidator.h"
+#include "../utils/Logger.h"
+
+StreamController& StreamController::instance()
+{
+    static StreamController instance;
+    return instance;
+}
+
+void StreamController::streamSpaces(const HttpRequest& request, HttpResponse& response)
+{
+    Q_UNUSED(request);
+
+    try {
+        openStream(SpaceEventPublisher::spacesChannel(), response);
+    } catch (const std::exception& e) {
+        Logger::error(QString("Error in streamSpaces: %1").arg(e.what()));
+        response.serverError("Failed to open space stream");
+    }
+}
+
+void StreamController::streamQueue(const HttpRequest& request, HttpResponse& response)
+{
+    try {
+        QString plate = PlateValidator::normalize(request.getPathParam("plate"));
+        if (!PlateValidator::isValid(plate)) {
+            response.badRequest("Invalid plate number");
+            return;
+        }
+
+        openStream(SpaceEventPublisher::queueChannel(plate), response);
+    } catch (const std::exception& e) {
+        Logger::error(QString("Error in streamQueue: %1").arg(e.what()));
+        response.serverError("Failed to open queue stream");
+    }
+}
+
+void StreamController::openStream(QString channel, HttpResponse& response)
+{
+    EventStreamHub::Snapshot snapshot;
+    if (!SpaceEventPublisher::instance().snapshot(channel, snapshot)) {
+        response.notFound("Unknown event channel");
+        return;
+    }
+
+    // retry 告诉客户端断线后 3 秒重连
+    QByteArray events("retry: 3000\n\n");
+    events.append(EventStreamHub::encodeEvent(snapshot.event, snapshot.data, snapshot.id));
+    response.eventStream(channel, events);
+}
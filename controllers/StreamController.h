@@ -0,0 +1,30 @@
+#ifndef STREAMCONTROLLER_H
+#define STREAMCONTROLLER_H
+
+#include <QObject>
+#include "../core/HttpRequest.h"
+#include "../core/HttpResponse.h"
+
+class StreamController : public QObject
+{
+    Q_OBJECT
+
+public:
+    static StreamController& instance();
+
+    // 车位变化事件流（SSE）
+    void streamSpaces(const HttpRequest& request, HttpResponse& response);
+
+    // 指定车牌的排队位置事件流（SSE）
+    void streamQueue(const HttpRequest& request, HttpResponse& response);
+
+private:
+    StreamController() = default;
+    StreamController(const StreamController&) = delete;
+    StreamController& operator=(const StreamController&) = delete;
+
+    // 取频道初始事件并把响应切换为事件流
+    static void openStream(QString channel, HttpResponse& response);
+};
+
+#endif // STREAMCONTROLLER_H
@@ -0,0 +1,224 @@
+#include "CacheMiddleware.h"
+#include "ResponseCompressor.h"
+#include "../utils/Logger.h"
+#include <QDateTime>
+#include <QMutexLocker>
+
+ResponseCache::ResponseCache(qint64 capacityBytes)
+{
+    // QCache 的成本为 int，容量按 KB 计
+    int shardCapacityKb = static_cast<int>(qMax<qint64>(1, capacityBytes / SHARD_COUNT / 1024));
+    for (Shard& shard : m_shards) {
+        shard.entries.setMaxCost(shardCapacityKb);
+    }
+}
+
+int ResponseCache::tagId(const QString& tag)
+{
+    QMutexLocker locker(&m_tagMutex);
+    auto it = m_tagIds.constFind(tag);
+    if (it != m_tagIds.constEnd()) {
+        return it.value();
+    }
+    if (m_tagIds.size() >= MAX_TAGS) {
+        Logger::error(QString("Response cache tag limit reached, ignoring tag %1").arg(tag));
+        return -1;
+    }
+    int id = m_tagIds.size();
+    m_tagIds.insert(tag, id);
+    return id;
+}
+
+void ResponseCache::invalidate(const QString& tag)
+{
+    int id;
+    {
+        QMutexLocker locker(&m_tagMutex);
+        id = m_tagIds.value(tag, -1);
+    }
+    if (id >= 0) {
+        m_tagGenerations[id].fetchAndAddOrdered(1);
+    }
+}
+
+ResponseCache::Generations ResponseCache::generations(const QVector<int>& tagIds) const
+{
+    Generations result;
+    result.reserve(tagIds.size());
+    for (int id : tagIds) {
+        result.append(qMakePair(id, m_tagGenerations[id].loadAcquire()));
+    }
+    return result;
+}
+
+bool ResponseCache::isCurrent(const Generations& generations) const
+{
+    for (const auto& generation : generations) {
+        if (m_tagGenerations[generation.first].loadAcquire() != generation.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ResponseCache::lookup(const QString& key, HttpResponse& response)
+{
+    Shard& shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+
+    Entry* entry = shard.entries.object(key);
+    if (!entry) {
+        m_misses.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    if (entry->expiresAt <= QDateTime::currentMSecsSinceEpoch()) {
+        shard.entries.remove(key);
+        m_expired.fetchAndAddRelaxed(1);
+        m_misses.fetchAndAddRelaxed(1);
+        return false;
+    }
+    if (!isCurrent(entry->generations)) {
+        shard.entries.remove(key);
+        m_invalidated.fetchAndAddRelaxed(1);
+        m_misses.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    // 响应体隐式共享，不复制字节
+    response.statusCode = entry->statusCode;
+    response.headers = entry->headers;
+    response.body = entry->body;
+    m_hits.fetchAndAddRelaxed(1);
+    return true;
+}
+
+void ResponseCache::store(const QString& key, const HttpResponse& response, qint64 ttlMs, const Generations& generations)
+{
+    // 处理器执行期间标签已失效，结果可能基于旧数据，不写入
+    if (!isCurrent(generations)) {
+        return;
+    }
+
+    Entry* entry = new Entry;
+    entry->statusCode = response.statusCode;
+    entry->headers = response.headers;
+    entry->body = response.body;
+    entry->expiresAt = QDateTime::currentMSecsSinceEpoch() + ttlMs;
+    entry->generations = generations;
+
+    int cost = qMax(1, (response.body.size() + key.size() * 2 + 256) / 1024);
+
+    Shard& shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+    shard.entries.insert(key, entry, cost);
+    m_stores.fetchAndAddRelaxed(1);
+}
+
+QJsonObject ResponseCache::statistics() const
+{
+    int entries = 0;
+    qint64 memoryKb = 0;
+    qint64 capacityKb = 0;
+    for (const Shard& shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        entries += shard.entries.size();
+        memoryKb += shard.entries.totalCost();
+        capacityKb += shard.entries.maxCost();
+    }
+
+    qint64 hits = m_hits.loadAcquire();
+    qint64 misses = m_misses.loadAcquire();
+
+    QJsonObject stats;
+    stats["hits"] = hits;
+    stats["misses"] = misses;
+    stats["hitRatio"] = hits + misses > 0 ? (double)hits / (hits + misses) : 0.0;
+    stats["stores"] = m_stores.loadAcquire();
+    stats["expired"] = m_expired.loadAcquire();
+    stats["invalidated"] = m_invalidated.loadAcquire();
+    stats["entries"] = entries;
+    stats["memoryBytes"] = memoryKb * 1024;
+    stats["capacityBytes"] = capacityKb * 1024;
+    stats["shards"] = SHARD_COUNT;
+    return stats;
+}
+
+CacheMiddleware::CacheMiddleware(ResponseCache& cache, int ttlMs, const QStringList& tags)
+    : m_cache(cache), m_ttlMs(ttlMs)
+{
+    for (const QString& tag : tags) {
+        int id = m_cache.tagId(tag);
+        if (id >= 0) {
+            m_tagIds.append(id);
+        }
+    }
+}
+
+bool CacheMiddleware::handle(HttpRequest& request, HttpResponse& response)
+{
+    if (request.method != "GET") {
+        return true;
+    }
+
+    QString key = representationKey(keyFor(request), request.acceptsCbor(), request.getHeader("accept-encoding"));
+    HttpResponse cached;
+    if (m_cache.lookup(key, cached)) {
+        QString etag = cached.getHeader("ETag");
+        if (!etag.isEmpty() && request.matchesETag(etag)) {
+            response.notModified(etag);
+            response.setHeader("Vary", cached.getHeader("Vary"));
+        } else {
+            response = cached;
+        }
+        response.encoded = true;
+        response.setHeader("X-Cache", "HIT");
+        return false;   // 命中，中断处理链
+    }
+
+    // 在处理器执行前记录标签代数，执行期间发生的失效会让这次结果不被写入
+    ResponseCache::Generations generations = m_cache.generations(m_tagIds);
+    request.setContext("cache.generations", QVariant::fromValue(generations));
+    return true;
+}
+
+void CacheMiddleware::after(const HttpRequest& request, HttpResponse& response)
+{
+    QVariant generations = request.getContext("cache.generations");
+    if (!generations.isValid()) {
+        return;
+    }
+
+    response.setHeader("X-Cache", "MISS");
+    if (response.statusCode != 200 || response.isStreaming() || response.isEventStream()
+        || response.isDeferred() || response.body.size() > ResponseCache::MAX_ENTRY_BYTES
+        || response.getHeader("Cache-Control").contains("no-store")) {
+        return;
+    }
+
+    // 表示形式由服务器按连接协商，编码完成后按实际的协商结果写入；
+    // 合并请求的每个等待者各自编码，各种表示形式分别写入
+    response.setHeader("Vary", "Accept");
+    ResponseCache* cache = &m_cache;
+    QString key = keyFor(request);
+    qint64 ttlMs = m_ttlMs;
+    ResponseCache::Generations tagGenerations = generations.value<ResponseCache::Generations>();
+    response.onEncoded = [cache, key, ttlMs, tagGenerations](const HttpResponse& encoded, bool acceptsCbor, const QString& acceptEncoding) {
+        if (encoded.body.size() <= ResponseCache::MAX_ENTRY_BYTES) {
+            cache->store(representationKey(key, acceptsCbor, acceptEncoding), encoded, ttlMs, tagGenerations);
+        }
+    };
+}
+
+QString CacheMiddleware::keyFor(const HttpRequest& request)
+{
+    return request.method + ' ' + request.normalizedTarget();
+}
+
+QString CacheMiddleware::representationKey(const QString& key, bool acceptsCbor, const QString& acceptEncoding)
+{
+    return QString("%1 %2/%3")
+        .arg(key)
+        .arg(acceptsCbor ? "cbor" : "json")
+        .arg(static_cast<int>(ResponseCompressor::negotiate(acceptEncoding)));
+}
@@ -0,0 +1,93 @@
+#ifndef CACHEMIDDLEWARE_H
+#define CACHEMIDDLEWARE_H
+
+#include "Middleware.h"
+#include <QAtomicInteger>
+#include <QCache>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+// 已编码响应的缓存：按键哈希分片的 LRU，每个分片一把锁，按字节数限制容量
+// 条目记录写入时各标签的代数，标签失效只递增代数，过期条目在下次读取时丢弃
+// 读取、写入和失效都可在任意线程调用
+class ResponseCache
+{
+public:
+    explicit ResponseCache(qint64 capacityBytes = DEFAULT_CAPACITY);
+
+    // 注册标签并返回其编号；只在启动时（注册路由）调用
+    int tagId(const QString& tag);
+
+    // 使带该标签的所有条目失效；未注册的标签忽略
+    void invalidate(const QString& tag);
+
+    // 当前各标签代数，处理器执行前取得，写入时随条目保存
+    typedef QVector<QPair<int, quint64>> Generations;
+    Generations generations(const QVector<int>& tagIds) const;
+
+    bool lookup(const QString& key, HttpResponse& response);
+    void store(const QString& key, const HttpResponse& response, qint64 ttlMs, const Generations& generations);
+
+    // 命中率、内存占用等统计
+    QJsonObject statistics() const;
+
+    static const qint64 DEFAULT_CAPACITY = 32 * 1024 * 1024;
+    static const int MAX_ENTRY_BYTES = 1024 * 1024;   // 超过此大小的响应不缓存
+
+private:
+    struct Entry {
+        int statusCode;
+        QMap<QString, QString> headers;
+        QByteArray body;
+        qint64 expiresAt;
+        Generations generations;
+    };
+
+    struct Shard {
+        mutable QMutex mutex;
+        QCache<QString, Entry> entries;
+    };
+
+    Shard& shardFor(const QString& key) { return m_shards[qHash(key) % SHARD_COUNT]; }
+    bool isCurrent(const Generations& generations) const;
+
+    static const int SHARD_COUNT = 16;
+    static const int MAX_TAGS = 32;
+
+    Shard m_shards[SHARD_COUNT];
+    QAtomicInteger<quint64> m_tagGenerations[MAX_TAGS];
+    QHash<QString, int> m_tagIds;
+    mutable QMutex m_tagMutex;
+
+    QAtomicInteger<qint64> m_hits;
+    QAtomicInteger<qint64> m_misses;
+    QAtomicInteger<qint64> m_stores;
+    QAtomicInteger<qint64> m_expired;       // 超过 TTL 被丢弃
+    QAtomicInteger<qint64> m_invalidated;   // 因标签失效被丢弃
+};
+
+// 按路由配置的缓存中间件：命中时直接返回已编码响应并中断处理链，未命中时在服务器完成编码后写入
+// 每种表示形式（JSON/CBOR × 压缩方式）单独缓存最终发送的字节，命中时不再转码和压缩
+// 只缓存 200 且未标记 Cache-Control: no-store 的普通响应；命中的响应带 ETag 且与 If-None-Match 一致时返回 304
+class CacheMiddleware : public Middleware
+{
+public:
+    CacheMiddleware(ResponseCache& cache, int ttlMs, const QStringList& tags);
+
+    bool handle(HttpRequest& request, HttpResponse& response) override;
+    void after(const HttpRequest& request, HttpResponse& response) override;
+
+private:
+    static QString keyFor(const HttpRequest& request);
+    static QString representationKey(const QString& key, bool acceptsCbor, const QString& acceptEncoding);
+
+    ResponseCache& m_cache;
+    int m_ttlMs;
+    QVector<int> m_tagIds;
+};
+
+#endif // CACHEMIDDLEWARE_H
@@ -0,0 +1,23 @@
+#include "DeferredResponse.h"
+#include "HttpResponse.h"
+
+void DeferredResponse::complete(HttpResponse& response)
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+
+    // 先取出发送函数，发送过程中可能处理后续请求并再次挂起
+    Completion completion;
+    completion.swap(m_completion);
+    if (completion) {
+        completion(response);
+    }
+}
+
+void DeferredResponse::cancel()
+{
+    m_finished = true;
+    m_completion = nullptr;
+}
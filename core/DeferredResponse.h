@@ -0,0 +1,34 @@
+#ifndef DEFERREDRESPONSE_H
+#define DEFERREDRESPONSE_H
+
+#include <functional>
+
+class HttpResponse;
+
+// 挂起的响应：处理函数返回后连接保持等待，由持有者稍后在事件循环中完成
+// 不占用线程，只在 HttpServer 所在线程使用
+class DeferredResponse
+{
+public:
+    typedef std::function<void(HttpResponse& response)> Completion;
+
+    // 尚未完成且连接仍在等待
+    bool isPending() const { return !m_finished; }
+
+    // 发送最终响应；已完成或连接已断开时忽略
+    void complete(HttpResponse& response);
+
+private:
+    friend class HttpServer;
+
+    // 服务器挂起连接时绑定发送函数
+    void bind(const Completion& completion) { m_completion = completion; }
+
+    // 连接断开或无法挂起（如 WebSocket RPC），持有者应丢弃该句柄
+    void cancel();
+
+    Completion m_completion;
+    bool m_finished = false;
+};
+
+#endif // DEFERREDRESPONSE_H
@@ -0,0 +1,200 @@
+#include "EventStreamHub.h"
+#include "WebSocketSession.h"
+#include "JsonWriter.h"
+#include "../utils/Logger.h"
+#include <QTcpSocket>
+#include <QTimer>
+
+EventStreamHub::EventStreamHub(QObject* parent) : QObject(parent)
+{
+    // 定期发送注释行（WebSocket 为 ping 帧），防止代理和负载均衡器因空闲断开连接
+    m_heartbeat = new QTimer(this);
+    m_heartbeat->setInterval(HEARTBEAT_INTERVAL_MS);
+    connect(m_heartbeat, &QTimer::timeout, this, &EventStreamHub::sendHeartbeat);
+}
+
+bool EventStreamHub::resolveChannel(QString& channel, Snapshot& snapshot) const
+{
+    return m_snapshotProvider && m_snapshotProvider(channel, snapshot);
+}
+
+void EventStreamHub::subscribe(const QString& channel, QTcpSocket* socket)
+{
+    unsubscribe(socket);
+
+    m_channels[channel].append(socket);
+    m_socketChannels.insert(socket, channel);
+    updateHeartbeat();
+
+    Logger::debug(QString("Event stream subscribed: channel=%1, subscribers=%2")
+                  .arg(channel).arg(m_socketChannels.size()));
+}
+
+void EventStreamHub::subscribeWebSocket(const QString& channel, QTcpSocket* socket)
+{
+    if (m_wsSocketChannels.contains(socket, channel)) {
+        return;
+    }
+
+    m_wsChannels[channel].append(socket);
+    m_wsSocketChannels.insert(socket, channel);
+    updateHeartbeat();
+}
+
+void EventStreamHub::unsubscribeWebSocket(const QString& channel, QTcpSocket* socket)
+{
+    if (m_wsSocketChannels.remove(socket, channel) == 0) {
+        return;
+    }
+
+    auto channelIt = m_wsChannels.find(channel);
+    if (channelIt != m_wsChannels.end()) {
+        channelIt->removeOne(socket);
+        if (channelIt->isEmpty()) {
+            m_wsChannels.erase(channelIt);
+        }
+    }
+    updateHeartbeat();
+}
+
+void EventStreamHub::unsubscribe(QTcpSocket* socket)
+{
+    for (const QString& channel : m_wsSocketChannels.values(socket)) {
+        unsubscribeWebSocket(channel, socket);
+    }
+
+    auto it = m_socketChannels.find(socket);
+    if (it == m_socketChannels.end()) {
+        return;
+    }
+
+    QString channel = it.value();
+    m_socketChannels.erase(it);
+
+    auto channelIt = m_channels.find(channel);
+    if (channelIt != m_channels.end()) {
+        channelIt->removeOne(socket);
+        if (channelIt->isEmpty()) {
+            m_channels.erase(channelIt);
+        }
+    }
+    updateHeartbeat();
+}
+
+void EventStreamHub::publish(const QString& channel, const QByteArray& event, const QByteArray& data, quint64 id)
+{
+    // 每种协议只编码一次，QByteArray 隐式共享给所有订阅者
+    auto it = m_channels.constFind(channel);
+    if (it != m_channels.constEnd()) {
+        broadcast(it.value(), chunk(encodeEvent(event, data, id)));
+    }
+
+    auto wsIt = m_wsChannels.constFind(channel);
+    if (wsIt != m_wsChannels.constEnd()) {
+        broadcast(wsIt.value(), encodeWebSocketEvent(channel, event, data, id));
+    }
+}
+
+QStringList EventStreamHub::channels(const QString& prefix) const
+{
+    QStringList result;
+    for (auto it = m_channels.constBegin(); it != m_channels.constEnd(); ++it) {
+        if (it.key().startsWith(prefix)) {
+            result.append(it.key());
+        }
+    }
+    for (auto it = m_wsChannels.constBegin(); it != m_wsChannels.constEnd(); ++it) {
+        if (it.key().startsWith(prefix) && !m_channels.contains(it.key())) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+QByteArray EventStreamHub::encodeEvent(const QByteArray& event, const QByteArray& data, quint64 id)
+{
+    QByteArray text;
+    text.reserve(data.size() + event.size() + 40);
+    if (id != 0) {
+        text.append("id: ");
+        text.append(QByteArray::number(id));
+        text.append('\n');
+    }
+    if (!event.isEmpty()) {
+        text.append("event: ");
+        text.append(event);
+        text.append('\n');
+    }
+    // data 为紧凑 JSON，不含换行
+    text.append("data: ");
+    text.append(data);
+    text.append("\n\n");
+    return text;
+}
+
+QByteArray EventStreamHub::chunk(const QByteArray& payload)
+{
+    QByteArray frame = QByteArray::number(payload.size(), 16);
+    frame.reserve(frame.size() + payload.size() + 4);
+    frame.append("\r\n");
+    frame.append(payload);
+    frame.append("\r\n");
+    return frame;
+}
+
+QByteArray EventStreamHub::encodeWebSocketEvent(const QString& channel, const QByteArray& event,
+                                                const QByteArray& data, quint64 id)
+{
+    QByteArray text;
+    text.reserve(data.size() + channel.size() + event.size() + 64);
+    JsonWriter writer(text);
+    writer.beginObject();
+    writer.field("type", "event");
+    writer.field("channel", channel);
+    writer.field("event", QString::fromUtf8(event));
+    if (id != 0) {
+        writer.field("id", static_cast<qint64>(id));
+    }
+    writer.key("data");
+    writer.raw(data);
+    writer.endObject();
+    return WebSocketSession::encodeFrame(WebSocketSession::TEXT, text);
+}
+
+void EventStreamHub::sendHeartbeat()
+{
+    static const QByteArray frame = chunk(": ping\n\n");
+    static const QByteArray wsFrame = WebSocketSession::encodeFrame(WebSocketSession::PING, QByteArray());
+    broadcast(m_socketChannels.keys(), frame);
+    broadcast(m_wsSocketChannels.uniqueKeys(), wsFrame);
+}
+
+void EventStreamHub::updateHeartbeat()
+{
+    bool needed = !m_socketChannels.isEmpty() || !m_wsSocketChannels.isEmpty();
+    if (needed && !m_heartbeat->isActive()) {
+        m_heartbeat->start();
+    } else if (!needed) {
+        m_heartbeat->stop();
+    }
+}
+
+void EventStreamHub::broadcast(const QList<QTcpSocket*>& sockets, const QByteArray& frame)
+{
+    QList<QTcpSocket*> slowConsumers;
+    for (QTcpSocket* socket : sockets) {
+        if (socket->bytesToWrite() > MAX_PENDING_BYTES) {
+            slowConsumers.append(socket);
+            continue;
+        }
+        socket->write(frame);
+    }
+
+    // 遍历结束后再断开，避免修改正在遍历的订阅列表
+    for (QTcpSocket* socket : slowConsumers) {
+        Logger::warning(QString("Dropping slow event stream subscriber on channel %1")
+                        .arg(m_socketChannels.value(socket, m_wsSocketChannels.value(socket))));
+        unsubscribe(socket);
+        socket->abort();
+    }
+}
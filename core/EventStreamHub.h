@@ -0,0 +1,85 @@
+#ifndef EVENTSTREAMHUB_H
+#define EVENTSTREAMHUB_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+class QTcpSocket;
+class QTimer;
+
+// 事件订阅中心：按频道保存长连接，事件编码一次后所有订阅者共享同一帧
+// SSE 连接只订阅一个频道；WebSocket 连接可同时订阅多个频道
+// 只在 HttpServer 所在线程使用；其他线程的事件应通过排队信号转发过来
+class EventStreamHub : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 频道的初始事件，订阅时先发送给新订阅者
+    struct Snapshot {
+        QByteArray event;
+        QByteArray data;
+        quint64 id = 0;
+    };
+
+    // 校验并规范化频道名，填充初始事件；不认识的频道返回 false
+    typedef std::function<bool(QString& channel, Snapshot& snapshot)> SnapshotProvider;
+
+    explicit EventStreamHub(QObject* parent = nullptr);
+
+    void setSnapshotProvider(const SnapshotProvider& provider) { m_snapshotProvider = provider; }
+    bool resolveChannel(QString& channel, Snapshot& snapshot) const;
+
+    // SSE 订阅
+    void subscribe(const QString& channel, QTcpSocket* socket);
+    bool isSubscribed(QTcpSocket* socket) const { return m_socketChannels.contains(socket); }
+
+    // WebSocket 订阅
+    void subscribeWebSocket(const QString& channel, QTcpSocket* socket);
+    void unsubscribeWebSocket(const QString& channel, QTcpSocket* socket);
+    int webSocketSubscriptionCount(QTcpSocket* socket) const { return m_wsSocketChannels.count(socket); }
+
+    // 取消连接上的所有订阅（SSE 和 WebSocket）
+    void unsubscribe(QTcpSocket* socket);
+
+    // 向频道推送事件；id 非 0 时写入 SSE 的 id 字段（客户端重连时回传 Last-Event-ID）
+    void publish(const QString& channel, const QByteArray& event, const QByteArray& data, quint64 id = 0);
+
+    // 当前有订阅者的频道（按前缀过滤）
+    QStringList channels(const QString& prefix) const;
+    int subscriberCount() const { return m_socketChannels.size(); }
+
+    // 编码一条 SSE 事件文本（不含分块传输的帧头）
+    static QByteArray encodeEvent(const QByteArray& event, const QByteArray& data, quint64 id = 0);
+
+    // 包装为 HTTP 分块传输的一个数据块
+    static QByteArray chunk(const QByteArray& payload);
+
+    // 编码一条 WebSocket 推送：{"type":"event","channel":...,"event":...,"id":...,"data":...} 的文本帧
+    static QByteArray encodeWebSocketEvent(const QString& channel, const QByteArray& event,
+                                           const QByteArray& data, quint64 id = 0);
+
+private slots:
+    void sendHeartbeat();
+
+private:
+    void broadcast(const QList<QTcpSocket*>& sockets, const QByteArray& frame);
+    void updateHeartbeat();
+
+    QHash<QString, QList<QTcpSocket*>> m_channels;        // SSE
+    QHash<QTcpSocket*, QString> m_socketChannels;
+    QHash<QString, QList<QTcpSocket*>> m_wsChannels;      // WebSocket
+    QMultiHash<QTcpSocket*, QString> m_wsSocketChannels;
+    SnapshotProvider m_snapshotProvider;
+    QTimer* m_heartbeat;
+
+    static const int HEARTBEAT_INTERVAL_MS = 15000;
+    static const qint64 MAX_PENDING_BYTES = 1024 * 1024;   // 发送积压超过此值视为慢消费者并断开
+};
+
+#endif // EVENTSTREAMHUB_H
@@ -0,0 +1,37 @@
+#include "FieldMask.h"
+#include <QStringList>
+
+bool FieldMask::parse(const QString& spec, const char* const* names, int count,
+                      FieldMask& mask, QString& error)
+{
+    Q_ASSERT(count <= 32);
+
+    mask.m_bits = ALL;
+    if (spec.trimmed().isEmpty()) {
+        return true;
+    }
+
+    quint32 bits = 0;
+    const QStringList items = spec.split(',', QString::SkipEmptyParts);
+    for (const QString& item : items) {
+        QString name = item.trimmed();
+        if (name.isEmpty()) {
+            continue;
+        }
+
+        int index = 0;
+        while (index < count && name != QLatin1String(names[index])) {
+            ++index;
+        }
+        if (index == count) {
+            error = QString("Unknown field: %1").arg(name);
+            return false;
+        }
+        bits |= 1u << index;
+    }
+
+    // 列出了全部字段时按未投影处理，可走整行缓存
+    quint32 full = count == 32 ? ALL : ((1u << count) - 1);
+    mask.m_bits = (bits == full || bits == 0) ? ALL : bits;
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef FIELDMASK_H
+#define FIELDMASK_H
+
+#include <QString>
+#include <QtGlobal>
+
+// 字段投影掩码：由 ?fields=a,b,c 解析一次，序列化时按位判断是否输出
+// 每个资源用字段名表定义位序（下标即位号），默认构造表示全部字段
+class FieldMask
+{
+public:
+    FieldMask() : m_bits(ALL) {}
+
+    // spec 为空时返回全部字段；出现未知字段时返回 false 并设置 error
+    static bool parse(const QString& spec, const char* const* names, int count,
+                      FieldMask& mask, QString& error);
+
+    bool has(int field) const { return (m_bits >> field) & 1u; }
+    bool isAll() const { return m_bits == ALL; }
+
+private:
+    static const quint32 ALL = 0xFFFFFFFFu;
+    quint32 m_bits;
+};
+
+#endif // FIELDMASK_H
@@ -1,6 +1,10 @@
 #include "HttpRequest.h"
 #include <QUrlQuery>
 #include <QUrl>
+#include <QJsonDocument>
+#include <QCborMap>
+#include <QCborValue>
+#include <QStringList>
 
 HttpRequest::HttpRequest()
 {
@@ -21,6 +25,20 @@ QString HttpRequest::getHeader(const QString& name) const
     return headers.value(name.toLower());
 }
 
+QString HttpRequest::normalizedTarget() const
+{
+    if (queryParams.isEmpty()) {
+        return path;
+    }
+    
+    // queryParams 为 QMap，已按参数名排序
+    QUrlQuery query;
+    for (auto it = queryParams.constBegin(); it != queryParams.constEnd(); ++it) {
+        query.addQueryItem(it.key(), it.value());
+    }
+    return path + '?' + query.toString(QUrl::FullyEncoded);
+}
+
 QString HttpRequest::getQueryParam(const QString& name) const
 {
     return queryParams.value(name);
@@ -39,4 +57,63 @@ QVariant HttpRequest::getContext(const QString& key) const
 void HttpRequest::setContext(const QString& key, const QVariant& value)
 {
     context[key] = value;
-}
\ No newline at end of file
+}
+
+bool HttpRequest::acceptsCbor() const
+{
+    return getHeader("accept").contains("application/cbor", Qt::CaseInsensitive);
+}
+
+bool HttpRequest::hasCborBody() const
+{
+    return getHeader("content-type").contains("application/cbor", Qt::CaseInsensitive);
+}
+
+QJsonObject HttpRequest::jsonBody(bool* ok) const
+{
+    if (m_jsonState == 0 && hasCborBody()) {
+        QCborParserError error;
+        QCborValue value = QCborValue::fromCbor(bodyRaw, &error);
+        m_jsonState = (error.error == QCborError::NoError && value.isMap()) ? 1 : -1;
+        if (m_jsonState == 1) {
+            m_jsonBody = value.toMap().toJsonObject();
+        }
+    } else if (m_jsonState == 0) {
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(bodyRaw, &error);
+        m_jsonState = (error.error == QJsonParseError::NoError && doc.isObject()) ? 1 : -1;
+        if (m_jsonState == 1) {
+            m_jsonBody = doc.object();
+        }
+    }
+
+    if (ok) {
+        *ok = m_jsonState == 1;
+    }
+    return m_jsonBody;
+}
+
+bool HttpRequest::matchesETag(const QString& etag) const
+{
+    QString header = getHeader("if-none-match");
+    if (header.isEmpty()) {
+        return false;
+    }
+
+    // 同一版本的 gzip/CBOR 表示形式带 "-后缀"，其数据与基础 ETag 相同
+    QString variantPrefix = etag.left(etag.size() - 1) + "-";
+    const QStringList candidates = header.split(',', QString::SkipEmptyParts);
+    for (QString candidate : candidates) {
+        candidate = candidate.trimmed();
+        if (candidate == "*") {
+            return true;
+        }
+        if (candidate.startsWith("W/")) {
+            candidate = candidate.mid(2);
+        }
+        if (candidate == etag || candidate.startsWith(variantPrefix)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -7,6 +7,7 @@
 #include <QJsonObject>
 #include <QByteArray>
 #include <QVariant>
+#include "JsonReader.h"
 
 class HttpRequest
 {
@@ -17,7 +18,6 @@ public:
     QMap<QString, QString> queryParams;
     QMap<QString, QString> pathParams;  // 路径参数
     QByteArray bodyRaw;
-    QJsonObject jsonBody;
     QVariantMap context;
 
     HttpRequest();
@@ -26,10 +26,36 @@ public:
     QString getHeader(const QString& name) const;
     QString getQueryParam(const QString& name) const;
     QString getPathParam(const QString& name) const;
+    
+    // 路径 + 按参数名排序的查询串，参数顺序不同的相同请求得到相同结果；用作合并和缓存的键
+    QString normalizedTarget() const;
+    bool acceptsCbor() const;
+    
+    // If-None-Match 是否命中给定 ETag（忽略压缩/CBOR 等表示形式后缀）
+    bool matchesETag(const QString& etag) const;
+    
+    // 请求体是否为 CBOR（Content-Type: application/cbor）；CBOR 请求体保持原样，由以下方法直接解码
+    bool hasCborBody() const;
+    
+    // 按需把请求体解码到 DTO（单遍解析，不构建 DOM）；处理器不调用则不解析
+    template <typename Dto>
+    bool bindBody(Dto& dto, QString& error) const
+    {
+        if (hasCborBody()) {
+            return JsonReader::decodeCbor(bodyRaw, dto, error);
+        }
+        return JsonReader::decode(bodyRaw, dto, error);
+    }
+    
+    // 按需解析为 QJsonObject，结果缓存；供字段不固定的处理器使用（CBOR map 直接转换，不经过 JSON 文本）
+    QJsonObject jsonBody(bool* ok = nullptr) const;
     QVariant getContext(const QString& key) const;
     void setContext(const QString& key, const QVariant& value);
     
 private:
+    mutable QJsonObject m_jsonBody;
+    mutable int m_jsonState = 0;   // 0 未解析，1 成功，-1 失败
+    
     void parseQueryParam(const QString& key, const QString& value);
 };
 
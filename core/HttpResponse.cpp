@@ -1,5 +1,8 @@
 #include "HttpResponse.h"
 #include <QJsonDocument>
+#include <QJsonArray>
+#include <QCborValue>
+#include "JsonReader.h"
 
 HttpResponse::HttpResponse() : statusCode(200)
 {
@@ -43,11 +46,47 @@ void HttpResponse::unauthorized(const QString& message)
     json(createApiResponse(4011, message));
 }
 
+void HttpResponse::notModified(const QString& etag)
+{
+    statusCode = 304;
+    body.clear();
+    headers.remove("Content-Type");
+    headers["ETag"] = etag;
+}
+
+void HttpResponse::okList(const QByteArray& encodedArray, int count, const QString& message)
+{
+    // 键按字母序排列，与 QJsonDocument 对 ok() 包装结果的输出逐字节一致
+    QByteArray escapedMessage = QJsonDocument(QJsonArray{message}).toJson(QJsonDocument::Compact);
+    escapedMessage = escapedMessage.mid(1, escapedMessage.size() - 2);
+
+    QByteArray out;
+    out.reserve(encodedArray.size() + escapedMessage.size() + 96);
+    out.append("{\"code\":0,\"data\":{\"count\":");
+    out.append(QByteArray::number(count));
+    out.append(",\"data\":");
+    out.append(encodedArray);
+    out.append(",\"message\":");
+    out.append(escapedMessage);
+    out.append(",\"success\":true},\"msg\":\"success\"}");
+
+    statusCode = 200;
+    rawJson(out);
+}
+
+void HttpResponse::rawJson(const QByteArray& data)
+{
+    headers["Content-Type"] = "application/json";
+    body = data;
+}
+
 void HttpResponse::json(const QJsonObject& data)
 {
     headers["Content-Type"] = "application/json";
     QJsonDocument doc(data);
     body = doc.toJson(QJsonDocument::Compact);
+    m_jsonValue = data;
+    m_jsonSource = body;
 }
 
 void HttpResponse::json(const QJsonArray& data)
@@ -55,6 +94,8 @@ void HttpResponse::json(const QJsonArray& data)
     headers["Content-Type"] = "application/json";
     QJsonDocument doc(data);
     body = doc.toJson(QJsonDocument::Compact);
+    m_jsonValue = data;
+    m_jsonSource = body;
 }
 
 void HttpResponse::text(const QString& text)
@@ -69,6 +110,49 @@ void HttpResponse::html(const QString& html)
     body = html.toUtf8();
 }
 
+void HttpResponse::stream(const QString& contentType, StreamProducer streamProducer)
+{
+    headers["Content-Type"] = contentType;
+    body.clear();
+    producer = std::move(streamProducer);
+}
+
+void HttpResponse::eventStream(const QString& channel, const QByteArray& initialEvents)
+{
+    statusCode = 200;
+    headers["Content-Type"] = "text/event-stream";
+    headers["Cache-Control"] = "no-cache";
+    body = initialEvents;
+    producer = nullptr;
+    eventChannel = channel;
+}
+
+void HttpResponse::defer(const std::shared_ptr<DeferredResponse>& handle)
+{
+    deferred = handle;
+}
+
+bool HttpResponse::encodeAsCbor()
+{
+    if (isStreaming() || isEventStream() || !headers.value("Content-Type").startsWith("application/json")) {
+        return false;
+    }
+
+    QByteArray cbor;
+    // body 与 json() 序列化的结果共享同一份数据，说明之后没有被替换或修改
+    if (!m_jsonValue.isUndefined() && !m_jsonSource.isEmpty() && body.constData() == m_jsonSource.constData() && body.size() == m_jsonSource.size()) {
+        cbor = QCborValue::fromJsonValue(m_jsonValue).toCbor();
+    } else if (!JsonReader::transcodeToCbor(body, cbor)) {
+        return false;
+    }
+
+    body = cbor;
+    m_jsonValue = QJsonValue(QJsonValue::Undefined);
+    m_jsonSource.clear();
+    headers["Content-Type"] = "application/cbor";
+    return true;
+}
+
 void HttpResponse::setHeader(const QString& name, const QString& value)
 {
     headers[name] = value;
@@ -84,6 +168,15 @@ void HttpResponse::setStatusCode(int code)
     statusCode = code;
 }
 
+void HttpResponse::appendETagSuffix(const QString& suffix)
+{
+    QString etag = headers.value("ETag");
+    if (etag.size() < 2 || !etag.endsWith('"') || etag.startsWith("W/")) {
+        return;
+    }
+    headers["ETag"] = etag.left(etag.size() - 1) + "-" + suffix + "\"";
+}
+
 QJsonObject HttpResponse::createApiResponse(int code, const QString& message, const QJsonValue& data)
 {
     QJsonObject response;
@@ -6,13 +6,28 @@
 #include <QMap>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QJsonValue>
+#include <functional>
+#include <memory>
+#include "DeferredResponse.h"
 
 class HttpResponse
 {
 public:
+    // 流式响应的数据生产者：向 chunk 追加下一段数据，返回 false 表示已结束
+    // 服务器在 socket 发送缓冲区低于水位线时反复调用，每次调用应只产生有限的数据
+    using StreamProducer = std::function<bool(QByteArray& chunk)>;
+    // 服务器按连接的 Accept / Accept-Encoding 完成编码后调用，参数为最终发送的响应
+    using EncodedCallback = std::function<void(const HttpResponse& encoded, bool acceptsCbor, const QString& acceptEncoding)>;
+
     int statusCode;
     QMap<QString, QString> headers;
     QByteArray body;
+    StreamProducer producer;
+    QString eventChannel;   // 非空时为 SSE 订阅，连接保持打开
+    std::shared_ptr<DeferredResponse> deferred;   // 非空时为挂起的长轮询
+    bool encoded = false;   // 已是按请求协商好的表示形式（CBOR、压缩），服务器不再转换
+    EncodedCallback onEncoded;   // 编码完成后调用一次，用于缓存最终字节
 
     HttpResponse();
     
@@ -23,19 +38,47 @@ public:
     void notFound(const QString& message = "Not Found");
     void serverError(const QString& message = "Internal Server Error");
     void unauthorized(const QString& message = "Unauthorized");
+    void notModified(const QString& etag);
+    
+    // 列表响应：encodedArray 为已编码的 JSON 数组，直接拼接进响应体
+    void okList(const QByteArray& encodedArray, int count, const QString& message);
     
     // 设置响应数据
     void json(const QJsonObject& data);
     void json(const QJsonArray& data);
+    void rawJson(const QByteArray& data);
     void text(const QString& text);
     void html(const QString& html);
     
+    // 流式响应：以 Transfer-Encoding: chunked 发送，body 不再使用
+    void stream(const QString& contentType, StreamProducer streamProducer);
+    bool isStreaming() const { return static_cast<bool>(producer); }
+    
+    // SSE 订阅：initialEvents 为已编码的初始事件，之后由服务器按频道推送
+    void eventStream(const QString& channel, const QByteArray& initialEvents = QByteArray());
+    bool isEventStream() const { return !eventChannel.isEmpty(); }
+    
+    // 长轮询：不立即发送，连接保持打开直到 handle 被完成
+    void defer(const std::shared_ptr<DeferredResponse>& handle);
+    bool isDeferred() const { return static_cast<bool>(deferred); }
+    
+    // 将 JSON 响应体转为 CBOR（客户端 Accept: application/cbor 时由服务器调用）
+    // json()/ok() 等构建的响应直接从保留的 QJsonValue 编码；rawJson()/okList() 的响应体逐词转写，都不重新解析为 DOM
+    bool encodeAsCbor();
+    
     // 工具方法
     void setHeader(const QString& name, const QString& value);
     QString getHeader(const QString& name) const;
     void setStatusCode(int code);
     
+    // 响应体转换为另一种表示形式（压缩、CBOR）时给强 ETag 追加后缀
+    void appendETagSuffix(const QString& suffix);
+    
 private:
+    // json() 写入 body 时保留的数据；仅当 body 仍是当时序列化的那份数据时使用
+    QJsonValue m_jsonValue{QJsonValue::Undefined};
+    QByteArray m_jsonSource;
+
     QJsonObject createApiResponse(int code, const QString& message, const QJsonValue& data = QJsonValue());
 };
 
@@ -1,13 +1,23 @@
 #include "HttpServer.h"
+#include "JsonBodyParser.h"
+#include "JsonWriter.h"
+#include "../utils/Logger.h"
 #include <QTextStream>
 #include <QStringList>
 #include <QDebug>
 #include <QHostAddress>
 #include <QUrl>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QPointer>
+
+const char* const HttpServer::WEBSOCKET_PATH = "/api/ws";
 
 HttpServer::HttpServer(QObject *parent) : QObject(parent)
 {
     server = new QTcpServer(this);
+    m_eventHub = new EventStreamHub(this);
     m_router = nullptr;
     m_port = 8080;
     m_maxConnections = 100;
@@ -21,6 +31,7 @@ HttpServer::~HttpServer()
     if (server->isListening()) {
         server->close();
     }
+    qDeleteAll(m_webSockets);
 }
 
 bool HttpServer::start()
@@ -59,6 +70,16 @@ void HttpServer::setRequestTimeout(int timeout)
     m_requestTimeout = timeout;
 }
 
+void HttpServer::setCompressionLevel(int level)
+{
+    m_compressor.setLevel(level);
+}
+
+void HttpServer::setCompressionThreshold(int bytes)
+{
+    m_compressor.setThreshold(bytes);
+}
+
 void HttpServer::setRouter(Router* router)
 {
     this->m_router = router;
@@ -81,6 +102,7 @@ void HttpServer::onNewConnection()
         
         connect(socket, &QTcpSocket::readyRead, this, &HttpServer::onReadyRead);
         connect(socket, &QTcpSocket::disconnected, this, &HttpServer::onDisconnected);
+        connect(socket, &QTcpSocket::bytesWritten, this, &HttpServer::onBytesWritten);
     }
 }
 
@@ -90,6 +112,14 @@ void HttpServer::onReadyRead()
     if (!socket) return;
     
     QByteArray data = socket->readAll();
+    WebSocketSession* session = m_webSockets.value(socket);
+    if (session) {
+        session->feed(data);
+        return;
+    }
+    if (m_eventHub->isSubscribed(socket)) {
+        return;  // SSE 连接只下行，忽略客户端后续数据
+    }
     socketBuffers[socket].append(data);
     
     // 处理累积的缓冲区数据
@@ -101,6 +131,18 @@ void HttpServer::onDisconnected()
     QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
     if (socket) {
         socketBuffers.remove(socket);  // 清理缓冲区
+        m_streams.remove(socket);      // 释放生产者持有的游标等资源
+        m_closeDelimited.remove(socket);
+        std::shared_ptr<DeferredResponse> deferred = m_deferred.take(socket);
+        if (deferred) {
+            deferred->cancel();        // 持有者在下次检查时丢弃该等待
+        }
+        m_eventHub->unsubscribe(socket);
+        WebSocketSession* session = m_webSockets.take(socket);
+        if (session) {
+            // 断开可能发生在会话处理帧的过程中，延迟释放
+            session->deleteLater();
+        }
         socket->deleteLater();
     }
 }
@@ -109,12 +151,68 @@ void HttpServer::processBufferedData(QTcpSocket* socket)
 {
     QByteArray& buffer = socketBuffers[socket];
     
-    // 循环处理缓冲区中的所有完整请求
-    while (tryParseCompleteRequest(socket, buffer)) {
+    // 循环处理缓冲区中的所有完整请求；流式响应未结束时保持请求顺序，暂不处理
+    while (!m_streams.contains(socket) && !m_deferred.contains(socket) && !m_eventHub->isSubscribed(socket)
+           && !m_webSockets.contains(socket) && tryParseCompleteRequest(socket, buffer)) {
         // 继续处理下一个请求
     }
 }
 
+void HttpServer::onBytesWritten(qint64 bytes)
+{
+    Q_UNUSED(bytes);
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (socket && m_streams.contains(socket)) {
+        pumpStream(socket);
+    }
+}
+
+void HttpServer::pumpStream(QTcpSocket* socket)
+{
+    // 背压：仅在发送缓冲区低于水位线时继续生产
+    while (socket->bytesToWrite() < STREAM_HIGH_WATERMARK) {
+        auto it = m_streams.find(socket);
+        if (it == m_streams.end()) {
+            return;
+        }
+        
+        QByteArray chunk;
+        bool more = (*it)(chunk);
+        bool closeDelimited = m_closeDelimited.contains(socket);
+        
+        if (closeDelimited) {
+            if (!chunk.isEmpty()) {
+                socket->write(chunk);
+            }
+            if (!more) {
+                // 响应体以连接关闭为结束标志；已缓冲的数据发送完后才真正断开，后续请求不再处理
+                m_streams.remove(socket);
+                m_closeDelimited.remove(socket);
+                socketBuffers.remove(socket);
+                socket->disconnectFromHost();
+                return;
+            }
+            continue;
+        }
+        
+        if (!chunk.isEmpty()) {
+            QByteArray frame = QByteArray::number(chunk.size(), 16);
+            frame.append("\r\n");
+            frame.append(chunk);
+            frame.append("\r\n");
+            socket->write(frame);
+        }
+        
+        if (!more) {
+            socket->write("0\r\n\r\n");
+            m_streams.remove(socket);
+            // 继续处理流式响应期间到达的请求
+            processBufferedData(socket);
+            return;
+        }
+    }
+}
+
 bool HttpServer::tryParseCompleteRequest(QTcpSocket* socket, QByteArray& buffer)
 {
     // 查找头部结束标记 \r\n\r\n
@@ -192,47 +290,347 @@ bool HttpServer::tryParseCompleteRequest(QTcpSocket* socket, QByteArray& buffer)
     request.path = url.path();
     request.parseQueryString(url.query());
     
-    // 处理请求
+    // WebSocket 升级：握手后该连接改为按帧处理，不再解析 HTTP 请求
+    if (request.path == WEBSOCKET_PATH && !request.getHeader("upgrade").isEmpty()) {
+        buffer.remove(0, totalRequestLength);
+        upgradeToWebSocket(socket, request, buffer);
+        return true;
+    }
+    
+    // 处理请求；CBOR 请求体保持原样，由 bindBody()/jsonBody() 直接解码
     HttpResponse response;
-    if (m_router) {
+    QString cborError;
+    if (!JsonBodyParser::checkCborBody(request, cborError)) {
+        response.badRequest(cborError);
+    } else if (m_router) {
         m_router->handleRequest(request, response);
     } else {
         response.serverError("No router configured");
     }
     
-    sendHttpResponse(socket, response);
-    
-    // 从缓冲区移除已处理的请求数据
+    // 从缓冲区移除已处理的请求数据（流式响应可能在发送过程中继续处理后续请求）
     buffer.remove(0, totalRequestLength);
     
+    if (response.isDeferred()) {
+        parkResponse(socket, request, response.deferred);
+        return true;
+    }
+    
+    if (response.isEventStream() && httpVersion == "HTTP/1.0") {
+        response = HttpResponse();
+        response.badRequest("Event streams require HTTP/1.1");
+    }
+    
+    if (response.isStreaming() && httpVersion == "HTTP/1.0") {
+        // HTTP/1.0 不支持分块传输：不带 Content-Length，按发送进度逐段写出，结束时关闭连接
+        m_closeDelimited.insert(socket);
+    }
+    
+    encodeResponse(response, request.acceptsCbor(), request.getHeader("accept-encoding"));
+    
+    sendHttpResponse(socket, response);
+    
     return true;  // 成功处理了一个请求
 }
 
+void HttpServer::encodeResponse(HttpResponse& response, bool acceptsCbor, const QString& acceptEncoding)
+{
+    // 缓存命中的响应已按同样的协商结果编码过
+    if (response.encoded) {
+        return;
+    }
+    
+    // 内容协商：终端请求 CBOR 时转码 JSON 响应体
+    if (acceptsCbor && response.encodeAsCbor()) {
+        response.setHeader("Vary", "Accept");
+        response.appendETagSuffix("cbor");
+    }
+    
+    m_compressor.apply(response, acceptEncoding);
+    response.encoded = true;
+    
+    if (response.onEncoded) {
+        HttpResponse::EncodedCallback callback = std::move(response.onEncoded);
+        response.onEncoded = nullptr;
+        callback(response, acceptsCbor, acceptEncoding);
+    }
+}
+
+void HttpServer::parkResponse(QTcpSocket* socket, const HttpRequest& request, const std::shared_ptr<DeferredResponse>& handle)
+{
+    bool acceptsCbor = request.acceptsCbor();
+    QString acceptEncoding = request.getHeader("accept-encoding");
+    
+    m_deferred.insert(socket, handle);
+    handle->bind([this, socket, acceptsCbor, acceptEncoding](HttpResponse& response) {
+        m_deferred.remove(socket);
+        encodeResponse(response, acceptsCbor, acceptEncoding);
+        sendHttpResponse(socket, response);
+        // 继续处理挂起期间到达的请求
+        processBufferedData(socket);
+    });
+}
+
 void HttpServer::sendHttpResponse(QTcpSocket* socket, const HttpResponse& response)
 {
     QString responseLine = QString("HTTP/1.1 %1 %2\r\n")
         .arg(response.statusCode)
-        .arg(response.statusCode == 200 ? "OK" : 
-             response.statusCode == 400 ? "Bad Request" :
-             response.statusCode == 404 ? "Not Found" : "Internal Server Error");
+        .arg(statusText(response.statusCode));
     
     QString headers;
     for (auto it = response.headers.constBegin(); it != response.headers.constEnd(); ++it) {
         headers += QString("%1: %2\r\n").arg(it.key()).arg(it.value());
     }
     
-    headers += QString("Content-Length: %1\r\n").arg(response.body.size());
+    if (response.isStreaming() && m_closeDelimited.contains(socket)) {
+        headers += "Connection: close\r\n";
+    } else if (response.isStreaming() || response.isEventStream()) {
+        headers += "Transfer-Encoding: chunked\r\n";
+    } else if (response.statusCode >= 200 && response.statusCode != 304 && response.statusCode != 204) {
+        headers += QString("Content-Length: %1\r\n").arg(response.body.size());
+    }
     headers += "\r\n";
     
     QByteArray fullResponse;
     fullResponse.append(responseLine.toUtf8());
     fullResponse.append(headers.toUtf8());
+    
+    if (response.isEventStream()) {
+        // 初始事件作为第一个数据块，之后连接交给订阅中心
+        if (!response.body.isEmpty()) {
+            fullResponse.append(EventStreamHub::chunk(response.body));
+        }
+        socket->write(fullResponse);
+        m_eventHub->subscribe(response.eventChannel, socket);
+        return;
+    }
+    
     fullResponse.append(response.body);
     
     socket->write(fullResponse);
+    
+    if (response.isStreaming()) {
+        m_streams.insert(socket, response.producer);
+        pumpStream(socket);
+        return;
+    }
+    
     socket->flush();
 }
 
+void HttpServer::upgradeToWebSocket(QTcpSocket* socket, const HttpRequest& request, QByteArray& buffer)
+{
+    HttpResponse response;
+    QByteArray key = request.getHeader("sec-websocket-key").toLatin1();
+    
+    if (request.method != "GET" || key.isEmpty()
+        || request.getHeader("upgrade").compare("websocket", Qt::CaseInsensitive) != 0
+        || !request.getHeader("connection").contains("upgrade", Qt::CaseInsensitive)) {
+        response.badRequest("Invalid WebSocket handshake");
+        sendHttpResponse(socket, response);
+        return;
+    }
+    
+    if (request.getHeader("sec-websocket-version") != "13") {
+        response.badRequest("Unsupported WebSocket version");
+        response.setStatusCode(426);
+        response.setHeader("Sec-WebSocket-Version", "13");
+        sendHttpResponse(socket, response);
+        return;
+    }
+    
+    response.setStatusCode(101);
+    response.headers.clear();
+    response.body.clear();
+    response.setHeader("Upgrade", "websocket");
+    response.setHeader("Connection", "Upgrade");
+    response.setHeader("Sec-WebSocket-Accept", QString::fromLatin1(WebSocketSession::acceptKey(key)));
+    sendHttpResponse(socket, response);
+    
+    WebSocketSession* session = new WebSocketSession(socket,
+        [this](WebSocketSession* s, const QByteArray& message) {
+            handleWebSocketMessage(s, message);
+        });
+    m_webSockets.insert(socket, session);
+    Logger::debug(QString("WebSocket session opened, sessions: %1").arg(m_webSockets.size()));
+    
+    // 客户端可能紧跟握手发送了帧
+    if (!buffer.isEmpty()) {
+        QByteArray pending;
+        pending.swap(buffer);
+        session->feed(pending);
+    }
+}
+
+void HttpServer::handleWebSocketMessage(WebSocketSession* session, const QByteArray& message)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(message, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        sendWebSocketReply(session, "error", 0, QString(), "Invalid JSON message");
+        return;
+    }
+    
+    QJsonObject object = doc.object();
+    QString type = object.value("type").toString();
+    int id = object.value("id").toInt();
+    
+    if (type == "request") {
+        handleWebSocketRequest(session, id, object);
+    } else if (type == "subscribe") {
+        handleWebSocketSubscription(session, id, object, true);
+    } else if (type == "unsubscribe") {
+        handleWebSocketSubscription(session, id, object, false);
+    } else {
+        sendWebSocketReply(session, "error", id, QString(), "Unknown message type");
+    }
+}
+
+void HttpServer::handleWebSocketRequest(WebSocketSession* session, int id, const QJsonObject& message)
+{
+    // 把 RPC 帧还原为 HTTP 请求，走与普通请求相同的路由和中间件
+    HttpRequest request;
+    request.method = message.value("method").toString("GET").toUpper();
+    QUrl url(message.value("path").toString());
+    request.path = url.path();
+    request.parseQueryString(url.query());
+    
+    QJsonObject headers = message.value("headers").toObject();
+    for (auto it = headers.constBegin(); it != headers.constEnd(); ++it) {
+        request.headers[it.key().toLower()] = it.value().toString();
+    }
+    
+    QJsonValue body = message.value("body");
+    if (body.isObject()) {
+        request.bodyRaw = QJsonDocument(body.toObject()).toJson(QJsonDocument::Compact);
+    } else if (body.isArray()) {
+        request.bodyRaw = QJsonDocument(body.toArray()).toJson(QJsonDocument::Compact);
+    }
+    if (!request.bodyRaw.isEmpty()) {
+        request.headers["content-type"] = "application/json";
+    }
+    
+    HttpResponse response;
+    if (!request.path.startsWith("/api/") || request.path == WEBSOCKET_PATH) {
+        response.badRequest("Invalid request path");
+    } else if (m_router) {
+        m_router->handleRequest(request, response);
+    } else {
+        response.serverError("No router configured");
+    }
+    
+    if (response.isDeferred()) {
+        // 挂起的响应（长轮询、合并执行）完成时再应答；会话已关闭则丢弃
+        QPointer<WebSocketSession> guard(session);
+        response.deferred->bind([guard, id](HttpResponse& result) {
+            if (guard && !guard->isClosing()) {
+                sendWebSocketResponse(guard, id, result);
+            }
+        });
+        return;
+    }
+    
+    if (response.isStreaming() || response.isEventStream()) {
+        // 流式导出和 SSE 不能装进单个应答；事件流改用 subscribe
+        response = HttpResponse();
+        response.badRequest("Streaming responses are not available over WebSocket");
+    }
+    
+    sendWebSocketResponse(session, id, response);
+}
+
+void HttpServer::sendWebSocketResponse(WebSocketSession* session, int id, const HttpResponse& response)
+{
+    QByteArray text;
+    text.reserve(response.body.size() + 64);
+    JsonWriter writer(text);
+    writer.beginObject();
+    writer.field("type", "response");
+    writer.field("id", id);
+    writer.field("status", response.statusCode);
+    QString etag = response.getHeader("ETag");
+    if (!etag.isEmpty()) {
+        writer.field("etag", etag);
+    }
+    writer.key("body");
+    if (response.body.isEmpty()) {
+        writer.null();
+    } else if (response.getHeader("Content-Type").contains("json")) {
+        writer.raw(response.body);
+    } else {
+        writer.value(QString::fromUtf8(response.body));
+    }
+    writer.endObject();
+    
+    session->sendText(text);
+}
+
+void HttpServer::handleWebSocketSubscription(WebSocketSession* session, int id, const QJsonObject& message, bool subscribe)
+{
+    QTcpSocket* socket = session->socket();
+    QString channel = message.value("channel").toString();
+    EventStreamHub::Snapshot snapshot;
+    
+    if (!m_eventHub->resolveChannel(channel, snapshot)) {
+        sendWebSocketReply(session, "error", id, channel, "Unknown event channel");
+        return;
+    }
+    
+    if (!subscribe) {
+        m_eventHub->unsubscribeWebSocket(channel, socket);
+        sendWebSocketReply(session, "unsubscribed", id, channel);
+        return;
+    }
+    
+    if (m_eventHub->webSocketSubscriptionCount(socket) >= MAX_WEBSOCKET_SUBSCRIPTIONS) {
+        sendWebSocketReply(session, "error", id, channel, "Too many subscriptions");
+        return;
+    }
+    
+    // 先确认订阅并发送当前状态，之后的增量事件由订阅中心推送
+    m_eventHub->subscribeWebSocket(channel, socket);
+    sendWebSocketReply(session, "subscribed", id, channel);
+    socket->write(EventStreamHub::encodeWebSocketEvent(channel, snapshot.event, snapshot.data, snapshot.id));
+}
+
+void HttpServer::sendWebSocketReply(WebSocketSession* session, const char* type, int id,
+                                    const QString& channel, const QString& error)
+{
+    QByteArray text;
+    JsonWriter writer(text);
+    writer.beginObject();
+    writer.field("type", type);
+    writer.field("id", id);
+    if (!channel.isEmpty()) {
+        writer.field("channel", channel);
+    }
+    if (!error.isEmpty()) {
+        writer.field("message", error);
+    }
+    writer.endObject();
+    session->sendText(text);
+}
+
+QString HttpServer::statusText(int statusCode)
+{
+    switch (statusCode) {
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 426: return "Upgrade Required";
+        case 429: return "Too Many Requests";
+        case 503: return "Service Unavailable";
+        default: return "Internal Server Error";
+    }
+}
+
 QString HttpServer::parseRequestLine(const QString& line, QString& method, QString& path, QString& httpVersion)
 {
     QStringList parts = line.split(' ');
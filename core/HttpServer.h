@@ -5,7 +5,11 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QByteArray>
+#include <QSet>
 #include "Router.h"
+#include "ResponseCompressor.h"
+#include "EventStreamHub.h"
+#include "WebSocketSession.h"
 
 class HttpServer : public QObject
 {
@@ -23,10 +27,20 @@ public:
     void setMaxConnections(int max);
     void setRequestTimeout(int timeout);
     
+    // 响应压缩：zlib 级别（0 关闭）和最小压缩字节数
+    void setCompressionLevel(int level);
+    void setCompressionThreshold(int bytes);
+    
     bool listen(const QString& address = "127.0.0.1", quint16 port = 8080);
     void setRouter(Router* router);
     Router* router() const;
     
+    // 事件订阅中心，领域事件通过它推送给 SSE 和 WebSocket 长连接
+    EventStreamHub* eventHub() const { return m_eventHub; }
+    
+    // WebSocket 升级路径：一条连接上承载 RPC 请求和事件订阅
+    static const char* const WEBSOCKET_PATH;
+    
 signals:
     void requestReceived(HttpRequest& request, HttpResponse& response);
     
@@ -34,6 +48,7 @@ private slots:
     void onNewConnection();
     void onReadyRead();
     void onDisconnected();
+    void onBytesWritten(qint64 bytes);
     
 private:
     QTcpServer* server;
@@ -41,13 +56,45 @@ private:
     quint16 m_port;
     int m_maxConnections;
     int m_requestTimeout;
+    ResponseCompressor m_compressor;
+    EventStreamHub* m_eventHub;
     
     // 为每个socket维护的缓冲区，用于累积TCP数据
     QMap<QTcpSocket*, QByteArray> socketBuffers;
     
+    // 正在发送流式响应的socket；流结束前暂停处理该连接上的后续请求
+    QMap<QTcpSocket*, HttpResponse::StreamProducer> m_streams;
+    // HTTP/1.0 客户端的流式响应：不分块，以关闭连接表示响应结束
+    QSet<QTcpSocket*> m_closeDelimited;
+    static const qint64 STREAM_HIGH_WATERMARK = 256 * 1024;  // 发送缓冲区高于此值时暂停生产
+    
+    // 挂起的长轮询响应；完成前暂停处理该连接上的后续请求
+    QMap<QTcpSocket*, std::shared_ptr<DeferredResponse>> m_deferred;
+    
+    // 已升级为 WebSocket 的连接
+    QMap<QTcpSocket*, WebSocketSession*> m_webSockets;
+    static const int MAX_WEBSOCKET_SUBSCRIPTIONS = 32;  // 单连接最多订阅的频道数
+    
     void processBufferedData(QTcpSocket* socket);
     bool tryParseCompleteRequest(QTcpSocket* socket, QByteArray& buffer);
     void sendHttpResponse(QTcpSocket* socket, const HttpResponse& response);
+    void pumpStream(QTcpSocket* socket);
+    
+    // 内容协商：CBOR 转码和压缩
+    void encodeResponse(HttpResponse& response, bool acceptsCbor, const QString& acceptEncoding);
+    
+    // 长轮询：挂起连接，完成时按原请求的协商结果编码并发送
+    void parkResponse(QTcpSocket* socket, const HttpRequest& request, const std::shared_ptr<DeferredResponse>& handle);
+    
+    // WebSocket：握手、消息分发（request/subscribe/unsubscribe）
+    void upgradeToWebSocket(QTcpSocket* socket, const HttpRequest& request, QByteArray& buffer);
+    void handleWebSocketMessage(WebSocketSession* session, const QByteArray& message);
+    void handleWebSocketRequest(WebSocketSession* session, int id, const QJsonObject& message);
+    void handleWebSocketSubscription(WebSocketSession* session, int id, const QJsonObject& message, bool subscribe);
+    static void sendWebSocketResponse(WebSocketSession* session, int id, const HttpResponse& response);
+    static void sendWebSocketReply(WebSocketSession* session, const char* type, int id,
+                                   const QString& channel, const QString& error = QString());
+    static QString statusText(int statusCode);
     QString extractHeaderValue(const QString& headers, const QString& headerName);
     QString parseRequestLine(const QString& line, QString& method, QString& path, QString& httpVersion);
 };
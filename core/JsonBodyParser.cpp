@@ -2,34 +2,26 @@
 
 bool JsonBodyParser::handle(HttpRequest& request, HttpResponse& response)
 {
-    QString contentType = request.getHeader("content-type");
-    
-    if (!isJsonContentType(contentType)) {
-        return true; // 不是JSON内容，继续处理
-    }
-    
-    if (request.bodyRaw.isEmpty()) {
-        return true; // 没有body，继续处理
-    }
-    
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(request.bodyRaw, &error);
-    
-    if (error.error != QJsonParseError::NoError) {
-        response.badRequest("Invalid JSON format");
+    QString cborError;
+    if (!checkCborBody(request, cborError)) {
+        response.badRequest(cborError);
         return false; // 中断处理
     }
     
-    if (!doc.isObject()) {
-        response.badRequest("JSON must be an object");
-        return false; // 中断处理
-    }
-    
-    request.jsonBody = doc.object();
     return true; // 继续处理
 }
 
-bool JsonBodyParser::isJsonContentType(const QString& contentType) const
+bool JsonBodyParser::checkCborBody(const HttpRequest& request, QString& error)
 {
-    return contentType.contains("application/json", Qt::CaseInsensitive);
-}
\ No newline at end of file
+    if (!request.hasCborBody() || request.bodyRaw.isEmpty()) {
+        return true;
+    }
+
+    // 只看首字节的主类型（5 为 map），完整的格式校验在解码时进行
+    unsigned char initial = static_cast<unsigned char>(request.bodyRaw.at(0));
+    if ((initial >> 5) != 5) {
+        error = "CBOR body must be a map";
+        return false;
+    }
+    return true;
+}
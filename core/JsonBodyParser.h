@@ -6,13 +6,14 @@
 #include <QJsonObject>
 #include <QDebug>
 
+// 请求体中间件：只做 CBOR 请求体的快速检查，JSON 和 CBOR 的解析都推迟到处理器调用 bindBody()/jsonBody() 时
 class JsonBodyParser : public Middleware
 {
 public:
     bool handle(HttpRequest& request, HttpResponse& response) override;
     
-private:
-    bool isJsonContentType(const QString& contentType) const;
+    // CBOR 请求体的顶层必须是 map；请求体保持原样，由 HttpRequest 按 CBOR 直接解码。非 CBOR 请求直接返回 true
+    static bool checkCborBody(const HttpRequest& request, QString& error);
 };
 
 #endif // JSONBODYPARSER_H
\ No newline at end of file
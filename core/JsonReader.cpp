@@ -0,0 +1,736 @@
+#include "JsonReader.h"
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <cmath>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void appendUtf8(QByteArray& out, uint codePoint)
+{
+    if (codePoint < 0x80) {
+        out.append(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        out.append(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.append(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.append(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out.append(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// 读取（可能分段的）文本串，读取后 reader 已前进到下一个元素
+bool readCborString(QCborStreamReader& reader, QString& out)
+{
+    out.clear();
+    auto result = reader.readString();
+    while (result.status == QCborStreamReader::Ok) {
+        out += result.data;
+        result = reader.readString();
+    }
+    return result.status == QCborStreamReader::EndOfString;
+}
+
+}
+
+void JsonReader::addField(const char* name, int length, FieldType type, void* target, bool required)
+{
+    m_fields.append(Field{name, length, type, target, required, false});
+}
+
+bool JsonReader::run(QString& error)
+{
+    if (!parseObject()) {
+        error = m_error;
+        return false;
+    }
+    return checkRequired(error);
+}
+
+bool JsonReader::runCbor(const QByteArray& raw, QString& error)
+{
+    QCborStreamReader reader(raw);
+    if (!parseCborMap(reader)) {
+        error = m_error;
+        return false;
+    }
+    return checkRequired(error);
+}
+
+bool JsonReader::checkRequired(QString& error) const
+{
+    for (const Field& field : m_fields) {
+        if (field.required && !field.seen) {
+            error = m_missingMessage ? QString::fromUtf8(m_missingMessage)
+                                     : QString("Missing required field: %1").arg(QString::fromLatin1(field.name, field.length));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JsonReader::parseObject()
+{
+    skipWhitespace();
+    if (m_pos == m_end) {
+        return fail("Invalid JSON format");
+    }
+    if (*m_pos != '{') {
+        return fail("Invalid JSON format");
+    }
+    ++m_pos;
+
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == '}') {
+        ++m_pos;
+    } else {
+        forever {
+            const char* keyStart = nullptr;
+            int keyLength = 0;
+            QByteArray unescaped;
+            if (!readKey(keyStart, keyLength, unescaped) || !expect(':')) {
+                return false;
+            }
+
+            Field* field = findField(keyStart, keyLength);
+            if (field ? !readField(*field) : !skipValue(0)) {
+                return false;
+            }
+
+            skipWhitespace();
+            if (m_pos < m_end && *m_pos == ',') {
+                ++m_pos;
+                continue;
+            }
+            if (!expect('}')) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    // 对象之后只允许空白
+    skipWhitespace();
+    if (m_pos != m_end) {
+        return fail("Invalid JSON format");
+    }
+    return true;
+}
+
+bool JsonReader::parseCborMap(QCborStreamReader& reader)
+{
+    if (reader.lastError() != QCborError::NoError || !reader.isValid()) {
+        return fail("Invalid CBOR format");
+    }
+    if (!reader.isMap()) {
+        return fail("CBOR body must be a map");
+    }
+    if (!reader.enterContainer()) {
+        return fail("Invalid CBOR format");
+    }
+
+    while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        // 非文本键不可能对应声明的字段，连同值一起跳过
+        Field* field = nullptr;
+        if (reader.isString()) {
+            QString key;
+            if (!readCborString(reader, key)) {
+                return fail("Invalid CBOR format");
+            }
+            QByteArray name = key.toUtf8();
+            field = findField(name.constData(), name.size());
+        } else if (!reader.next()) {
+            return fail("Invalid CBOR format");
+        }
+
+        if (field) {
+            if (!readCborField(reader, *field)) {
+                return false;
+            }
+        } else if (!reader.next()) {
+            return fail("Invalid CBOR format");
+        }
+    }
+
+    if (reader.lastError() != QCborError::NoError || !reader.leaveContainer()) {
+        return fail("Invalid CBOR format");
+    }
+    return true;
+}
+
+bool JsonReader::readCborField(QCborStreamReader& reader, Field& field)
+{
+    // null/undefined 与类型不符的值一样按已提供、取默认值处理
+    if (reader.isNull() || reader.isUndefined()) {
+        return skipCborMismatched(reader, field);
+    }
+
+    switch (field.type) {
+        case FIELD_STRING:
+            if (!reader.isString()) {
+                return skipCborMismatched(reader, field);
+            }
+            if (!readCborString(reader, *static_cast<QString*>(field.target))) {
+                return fail("Invalid CBOR format");
+            }
+            field.seen = true;
+            return true;
+
+        case FIELD_INT:
+        case FIELD_DOUBLE: {
+            double number = 0.0;
+            if (reader.isUnsignedInteger()) {
+                quint64 value = reader.toUnsignedInteger();
+                if (field.type == FIELD_INT && value > static_cast<quint64>(INT_MAX)) {
+                    return skipCborMismatched(reader, field);
+                }
+                number = static_cast<double>(value);
+            } else if (reader.isNegativeInteger()) {
+                // 超出 qint64 的负数 toInteger() 会回绕为非负数
+                qint64 value = reader.toInteger();
+                if (field.type == FIELD_INT && (value >= 0 || value < INT_MIN)) {
+                    return skipCborMismatched(reader, field);
+                }
+                number = static_cast<double>(value);
+            } else if (reader.isDouble()) {
+                number = reader.toDouble();
+            } else if (reader.isFloat()) {
+                number = reader.toFloat();
+            } else if (reader.isFloat16()) {
+                number = reader.toFloat16();
+            } else {
+                return skipCborMismatched(reader, field);
+            }
+
+            if (!std::isfinite(number)) {
+                return skipCborMismatched(reader, field);
+            }
+            if (field.type == FIELD_DOUBLE) {
+                *static_cast<double*>(field.target) = number;
+            } else {
+                if (number != std::trunc(number) || number < INT_MIN || number > INT_MAX) {
+                    return skipCborMismatched(reader, field);
+                }
+                *static_cast<int*>(field.target) = static_cast<int>(number);
+            }
+            break;
+        }
+
+        case FIELD_BOOL:
+            if (!reader.isBool()) {
+                return skipCborMismatched(reader, field);
+            }
+            *static_cast<bool*>(field.target) = reader.toBool();
+            break;
+    }
+
+    if (!reader.next()) {
+        return fail("Invalid CBOR format");
+    }
+    field.seen = true;
+    return true;
+}
+
+bool JsonReader::transcodeToCbor(const QByteArray& json, QByteArray& cbor)
+{
+    JsonReader reader(json);
+    QByteArray out;
+    out.reserve(json.size());
+    {
+        QCborStreamWriter writer(&out);
+        if (!reader.transcodeValue(writer, 0)) {
+            return false;
+        }
+    }
+
+    reader.skipWhitespace();
+    if (reader.m_pos != reader.m_end) {
+        return false;
+    }
+    cbor.swap(out);
+    return true;
+}
+
+bool JsonReader::transcodeValue(QCborStreamWriter& writer, int depth)
+{
+    if (depth > MAX_DEPTH) {
+        return fail("Invalid JSON format");
+    }
+
+    skipWhitespace();
+    if (m_pos >= m_end) {
+        return fail("Invalid JSON format");
+    }
+
+    char c = *m_pos;
+    if (c == '"') {
+        return transcodeString(writer);
+    }
+
+    if (c == '{' || c == '[') {
+        const bool isObject = c == '{';
+        const char close = isObject ? '}' : ']';
+        ++m_pos;
+        if (isObject) {
+            writer.startMap();
+        } else {
+            writer.startArray();
+        }
+
+        skipWhitespace();
+        if (m_pos < m_end && *m_pos == close) {
+            ++m_pos;
+        } else {
+            forever {
+                if (isObject) {
+                    skipWhitespace();
+                    if (m_pos >= m_end || *m_pos != '"') {
+                        return fail("Invalid JSON format");
+                    }
+                    if (!transcodeString(writer) || !expect(':')) {
+                        return false;
+                    }
+                }
+                if (!transcodeValue(writer, depth + 1)) {
+                    return false;
+                }
+                skipWhitespace();
+                if (m_pos < m_end && *m_pos == ',') {
+                    ++m_pos;
+                    continue;
+                }
+                if (!expect(close)) {
+                    return false;
+                }
+                break;
+            }
+        }
+        return isObject ? writer.endMap() : writer.endArray();
+    }
+
+    if (m_end - m_pos >= 4 && std::memcmp(m_pos, "true", 4) == 0) {
+        m_pos += 4;
+        writer.append(true);
+        return true;
+    }
+    if (m_end - m_pos >= 5 && std::memcmp(m_pos, "false", 5) == 0) {
+        m_pos += 5;
+        writer.append(false);
+        return true;
+    }
+    if (m_end - m_pos >= 4 && std::memcmp(m_pos, "null", 4) == 0) {
+        m_pos += 4;
+        writer.appendNull();
+        return true;
+    }
+
+    if (c != '-' && (c < '0' || c > '9')) {
+        return fail("Invalid JSON format");
+    }
+    double number = 0.0;
+    if (!readNumber(number)) {
+        return fail("Invalid JSON format");
+    }
+    // 9223372036854775808 = 2^63，qint64 可表示的整数值写为整数
+    if (number == std::trunc(number) && number >= -9223372036854775808.0 && number < 9223372036854775808.0) {
+        writer.append(static_cast<qint64>(number));
+    } else {
+        writer.append(number);
+    }
+    return true;
+}
+
+bool JsonReader::transcodeString(QCborStreamWriter& writer)
+{
+    // 常见情况：没有转义字符，UTF-8 字节原样写入
+    const char* begin = m_pos + 1;
+    const char* p = begin;
+    while (p < m_end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20) {
+        ++p;
+    }
+    if (p < m_end && *p == '"') {
+        writer.appendTextString(begin, p - begin);
+        m_pos = p + 1;
+        return true;
+    }
+
+    QString text;
+    if (!readString(text)) {
+        return false;
+    }
+    writer.append(text);
+    return true;
+}
+
+void JsonReader::skipWhitespace()
+{
+    while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r')) {
+        ++m_pos;
+    }
+}
+
+bool JsonReader::expect(char c)
+{
+    skipWhitespace();
+    if (m_pos >= m_end || *m_pos != c) {
+        return fail("Invalid JSON format");
+    }
+    ++m_pos;
+    return true;
+}
+
+bool JsonReader::readKey(const char*& start, int& length, QByteArray& unescaped)
+{
+    skipWhitespace();
+    if (m_pos >= m_end || *m_pos != '"') {
+        return fail("Invalid JSON format");
+    }
+
+    // 常见情况：键中没有转义字符，直接引用原始字节
+    const char* begin = m_pos + 1;
+    const char* p = begin;
+    while (p < m_end && *p != '"' && *p != '\\') {
+        ++p;
+    }
+    if (p < m_end && *p == '"') {
+        start = begin;
+        length = static_cast<int>(p - begin);
+        m_pos = p + 1;
+        return true;
+    }
+
+    QString key;
+    if (!readString(key)) {
+        return false;
+    }
+    unescaped = key.toUtf8();
+    start = unescaped.constData();
+    length = unescaped.size();
+    return true;
+}
+
+bool JsonReader::readString(QString& out)
+{
+    skipWhitespace();
+    if (m_pos >= m_end || *m_pos != '"') {
+        return fail("Invalid JSON format");
+    }
+    ++m_pos;
+
+    const char* runStart = m_pos;
+    QByteArray buffer;
+    bool escaped = false;
+
+    while (m_pos < m_end) {
+        unsigned char c = static_cast<unsigned char>(*m_pos);
+        if (c == '"') {
+            if (escaped) {
+                buffer.append(runStart, static_cast<int>(m_pos - runStart));
+                out = QString::fromUtf8(buffer);
+            } else {
+                out = QString::fromUtf8(runStart, static_cast<int>(m_pos - runStart));
+            }
+            ++m_pos;
+            return true;
+        }
+        if (c < 0x20) {
+            return fail("Invalid JSON format");
+        }
+        if (c != '\\') {
+            ++m_pos;
+            continue;
+        }
+
+        escaped = true;
+        buffer.append(runStart, static_cast<int>(m_pos - runStart));
+        if (m_end - m_pos < 2) {
+            return fail("Invalid JSON format");
+        }
+
+        char e = m_pos[1];
+        m_pos += 2;
+        switch (e) {
+            case '"': buffer.append('"'); break;
+            case '\\': buffer.append('\\'); break;
+            case '/': buffer.append('/'); break;
+            case 'b': buffer.append('\b'); break;
+            case 'f': buffer.append('\f'); break;
+            case 'n': buffer.append('\n'); break;
+            case 'r': buffer.append('\r'); break;
+            case 't': buffer.append('\t'); break;
+            case 'u': {
+                uint codePoint = 0;
+                for (int pass = 0; pass < 2; ++pass) {
+                    if (m_end - m_pos < 4) {
+                        return fail("Invalid JSON format");
+                    }
+                    uint unit = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        int v = hexValue(m_pos[i]);
+                        if (v < 0) {
+                            return fail("Invalid JSON format");
+                        }
+                        unit = (unit << 4) | static_cast<uint>(v);
+                    }
+                    m_pos += 4;
+
+                    if (pass == 0) {
+                        codePoint = unit;
+                        // 单独的低代理项不是合法字符
+                        if (unit >= 0xDC00 && unit <= 0xDFFF) {
+                            return fail("Invalid JSON format");
+                        }
+                        // 高代理项后面必须紧跟 \uXXXX 低代理项
+                        if (unit < 0xD800 || unit > 0xDBFF) {
+                            break;
+                        }
+                        if (m_end - m_pos < 2 || m_pos[0] != '\\' || m_pos[1] != 'u') {
+                            return fail("Invalid JSON format");
+                        }
+                        m_pos += 2;
+                    } else {
+                        if (unit < 0xDC00 || unit > 0xDFFF) {
+                            return fail("Invalid JSON format");
+                        }
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (unit - 0xDC00);
+                    }
+                }
+                appendUtf8(buffer, codePoint);
+                break;
+            }
+            default:
+                return fail("Invalid JSON format");
+        }
+        runStart = m_pos;
+    }
+
+    return fail("Invalid JSON format");
+}
+
+bool JsonReader::readNumber(double& out)
+{
+    skipWhitespace();
+    const char* begin = m_pos;
+    auto isDigit = [this](const char* p) { return p < m_end && *p >= '0' && *p <= '9'; };
+
+    // JSON 数字：-? (0 | [1-9][0-9]*) (.[0-9]+)? ([eE][+-]?[0-9]+)?
+    if (m_pos < m_end && *m_pos == '-') {
+        ++m_pos;
+    }
+    if (!isDigit(m_pos)) {
+        return false;
+    }
+    if (*m_pos == '0') {
+        ++m_pos;
+    } else {
+        while (isDigit(m_pos)) {
+            ++m_pos;
+        }
+    }
+    if (m_pos < m_end && *m_pos == '.') {
+        ++m_pos;
+        if (!isDigit(m_pos)) {
+            return false;
+        }
+        while (isDigit(m_pos)) {
+            ++m_pos;
+        }
+    }
+    if (m_pos < m_end && (*m_pos == 'e' || *m_pos == 'E')) {
+        ++m_pos;
+        if (m_pos < m_end && (*m_pos == '+' || *m_pos == '-')) {
+            ++m_pos;
+        }
+        if (!isDigit(m_pos)) {
+            return false;
+        }
+        while (isDigit(m_pos)) {
+            ++m_pos;
+        }
+    }
+
+    bool ok = false;
+    out = QByteArray::fromRawData(begin, static_cast<int>(m_pos - begin)).toDouble(&ok);
+    return ok && std::isfinite(out);
+}
+
+bool JsonReader::readField(Field& field)
+{
+    skipWhitespace();
+    if (m_pos >= m_end) {
+        return fail("Invalid JSON format");
+    }
+
+    // null 与类型不符的值一样按已提供、取默认值处理
+    if (m_end - m_pos >= 4 && std::memcmp(m_pos, "null", 4) == 0) {
+        m_pos += 4;
+        resetField(field);
+        field.seen = true;
+        return true;
+    }
+
+    switch (field.type) {
+        case FIELD_STRING:
+            if (*m_pos != '"') {
+                return skipMismatched(field);
+            }
+            if (!readString(*static_cast<QString*>(field.target))) {
+                return false;
+            }
+            break;
+
+        case FIELD_INT:
+        case FIELD_DOUBLE: {
+            if (*m_pos != '-' && (*m_pos < '0' || *m_pos > '9')) {
+                return skipMismatched(field);
+            }
+            double number = 0.0;
+            if (!readNumber(number)) {
+                return fail("Invalid JSON format");
+            }
+            if (field.type == FIELD_DOUBLE) {
+                *static_cast<double*>(field.target) = number;
+            } else if (number != std::trunc(number) || number < INT_MIN || number > INT_MAX) {
+                // 与 QJsonValue::toInt() 相同，非整数或超出 int 范围时取默认值
+                resetField(field);
+            } else {
+                *static_cast<int*>(field.target) = static_cast<int>(number);
+            }
+            break;
+        }
+
+        case FIELD_BOOL:
+            if (m_end - m_pos >= 4 && std::memcmp(m_pos, "true", 4) == 0) {
+                *static_cast<bool*>(field.target) = true;
+                m_pos += 4;
+            } else if (m_end - m_pos >= 5 && std::memcmp(m_pos, "false", 5) == 0) {
+                *static_cast<bool*>(field.target) = false;
+                m_pos += 5;
+            } else {
+                return skipMismatched(field);
+            }
+            break;
+    }
+
+    field.seen = true;
+    return true;
+}
+
+bool JsonReader::skipValue(int depth)
+{
+    if (depth > MAX_DEPTH) {
+        return fail("Invalid JSON format");
+    }
+
+    skipWhitespace();
+    if (m_pos >= m_end) {
+        return fail("Invalid JSON format");
+    }
+
+    char c = *m_pos;
+    if (c == '"') {
+        QString ignored;
+        return readString(ignored);
+    }
+
+    if (c == '{' || c == '[') {
+        const char close = c == '{' ? '}' : ']';
+        ++m_pos;
+        skipWhitespace();
+        if (m_pos < m_end && *m_pos == close) {
+            ++m_pos;
+            return true;
+        }
+        forever {
+            if (c == '{') {
+                const char* keyStart = nullptr;
+                int keyLength = 0;
+                QByteArray unescaped;
+                if (!readKey(keyStart, keyLength, unescaped) || !expect(':')) {
+                    return false;
+                }
+            }
+            if (!skipValue(depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (m_pos < m_end && *m_pos == ',') {
+                ++m_pos;
+                continue;
+            }
+            return expect(close);
+        }
+    }
+
+    static const char* const literals[] = {"true", "false", "null"};
+    for (const char* literal : literals) {
+        int length = static_cast<int>(std::strlen(literal));
+        if (m_end - m_pos >= length && std::memcmp(m_pos, literal, length) == 0) {
+            m_pos += length;
+            return true;
+        }
+    }
+
+    double ignored = 0.0;
+    if (!readNumber(ignored)) {
+        return fail("Invalid JSON format");
+    }
+    return true;
+}
+
+bool JsonReader::fail(const QString& message)
+{
+    if (m_error.isEmpty()) {
+        m_error = message;
+    }
+    return false;
+}
+
+void JsonReader::resetField(Field& field)
+{
+    switch (field.type) {
+        case FIELD_STRING: static_cast<QString*>(field.target)->clear(); break;
+        case FIELD_INT: *static_cast<int*>(field.target) = 0; break;
+        case FIELD_DOUBLE: *static_cast<double*>(field.target) = 0.0; break;
+        case FIELD_BOOL: *static_cast<bool*>(field.target) = false; break;
+    }
+}
+
+bool JsonReader::skipMismatched(Field& field)
+{
+    resetField(field);
+    field.seen = true;
+    return skipValue(0);
+}
+
+bool JsonReader::skipCborMismatched(QCborStreamReader& reader, Field& field)
+{
+    resetField(field);
+    field.seen = true;
+    return reader.next() || fail("Invalid CBOR format");
+}
+
+JsonReader::Field* JsonReader::findField(const char* name, int length)
+{
+    for (Field& field : m_fields) {
+        if (field.length == length && std::memcmp(field.name, name, length) == 0) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
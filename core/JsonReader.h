@@ -0,0 +1,119 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVarLengthArray>
+#include <cstddef>
+
+class QCborStreamReader;
+class QCborStreamWriter;
+
+// 单遍 JSON 解码器：按 DTO 声明的字段直接从原始字节填充，不构建 QJsonDocument
+// 只处理顶层对象；未声明的字段跳过；遇到第一个语法错误即停止
+// 字段值为 null 或类型不符时按已提供、取默认值处理，与 QJsonObject::contains() 加 toXxx() 的旧写法一致
+// 同一组字段声明也可从 CBOR map 填充（decodeCbor），类型规则与 JSON 相同
+//
+// DTO 需提供 template <typename Binder> void bind(Binder& b)，在其中声明字段：
+//     b.required("plate", plate);
+//     b.optional("paymentMethod", paymentMethod);
+class JsonReader
+{
+public:
+    template <typename Dto>
+    static bool decode(const QByteArray& raw, Dto& dto, QString& error)
+    {
+        JsonReader reader(raw);
+        dto.bind(reader);
+        return reader.run(error);
+    }
+
+    template <typename Dto>
+    static bool decodeCbor(const QByteArray& raw, Dto& dto, QString& error)
+    {
+        JsonReader reader(raw);
+        dto.bind(reader);
+        return reader.runCbor(raw, error);
+    }
+
+    // JSON 文本逐词转写为 CBOR，不构建 QJsonDocument/QCborValue；容器使用不定长编码
+    // 整数值的数字写为 CBOR 整数，与 QCborValue::fromJsonValue 一致
+    static bool transcodeToCbor(const QByteArray& json, QByteArray& cbor);
+
+    // 字段名必须是字符串字面量；支持 QString、int、double、bool
+    template <std::size_t N, typename T>
+    void required(const char (&name)[N], T& target)
+    {
+        addField(name, static_cast<int>(N - 1), typeOf(&target), &target, true);
+    }
+
+    template <std::size_t N, typename T>
+    void optional(const char (&name)[N], T& target)
+    {
+        addField(name, static_cast<int>(N - 1), typeOf(&target), &target, false);
+    }
+
+    // 缺少任一必填字段时的提示；未设置时为 "Missing required field: <字段名>"
+    void missingMessage(const char* message) { m_missingMessage = message; }
+
+private:
+    enum FieldType {
+        FIELD_STRING,
+        FIELD_INT,
+        FIELD_DOUBLE,
+        FIELD_BOOL
+    };
+
+    struct Field {
+        const char* name;
+        int length;
+        FieldType type;
+        void* target;
+        bool required;
+        bool seen;
+    };
+
+    explicit JsonReader(const QByteArray& raw)
+        : m_pos(raw.constData()), m_end(raw.constData() + raw.size()) {}
+
+    static FieldType typeOf(QString*) { return FIELD_STRING; }
+    static FieldType typeOf(int*) { return FIELD_INT; }
+    static FieldType typeOf(double*) { return FIELD_DOUBLE; }
+    static FieldType typeOf(bool*) { return FIELD_BOOL; }
+
+    void addField(const char* name, int length, FieldType type, void* target, bool required);
+    bool run(QString& error);
+    bool runCbor(const QByteArray& raw, QString& error);
+    bool checkRequired(QString& error) const;
+    bool parseObject();
+    bool parseCborMap(QCborStreamReader& reader);
+    bool readCborField(QCborStreamReader& reader, Field& field);
+    bool transcodeValue(QCborStreamWriter& writer, int depth);
+    bool transcodeString(QCborStreamWriter& writer);
+
+    // 词法辅助，失败时返回 false 并设置 m_error
+    void skipWhitespace();
+    bool expect(char c);
+    bool readKey(const char*& start, int& length, QByteArray& unescaped);
+    bool readString(QString& out);
+    bool readNumber(double& out);
+    bool readField(Field& field);
+    bool skipValue(int depth);
+    bool fail(const QString& message);
+    // 类型不符的值与 QJsonValue::toXxx() 一样取默认值（字段仍算已提供），并跳过该值
+    static void resetField(Field& field);
+    bool skipMismatched(Field& field);
+    bool skipCborMismatched(QCborStreamReader& reader, Field& field);
+
+    Field* findField(const char* name, int length);
+
+    const char* m_pos;
+    const char* m_end;
+    QVarLengthArray<Field, 8> m_fields;
+    QString m_error;
+    const char* m_missingMessage = nullptr;
+
+    static const int MAX_DEPTH = 32;
+};
+
+#endif // JSONREADER_H
@@ -0,0 +1,160 @@
+#include "JsonWriter.h"
+#include <QLocale>
+#include <cmath>
+
+void JsonWriter::value(const QString& text)
+{
+    separate();
+    writeString(text);
+}
+
+void JsonWriter::value(bool flag)
+{
+    separate();
+    if (flag) {
+        m_out.append("true", 4);
+    } else {
+        m_out.append("false", 5);
+    }
+}
+
+void JsonWriter::value(int number)
+{
+    separate();
+    m_out.append(QByteArray::number(number));
+}
+
+void JsonWriter::value(qint64 number)
+{
+    separate();
+    m_out.append(QByteArray::number(number));
+}
+
+void JsonWriter::value(double number)
+{
+    separate();
+    if (!std::isfinite(number)) {
+        m_out.append("null", 4);
+        return;
+    }
+
+    // 与 QJsonDocument 相同：可精确表示的整数按整数输出，其余取最短往返表示
+    double integral = std::floor(number);
+    if (integral == number && std::fabs(number) <= 9007199254740992.0) {
+        m_out.append(QByteArray::number(static_cast<qint64>(number)));
+    } else {
+        m_out.append(QByteArray::number(number, 'g', QLocale::FloatingPointShortest));
+    }
+}
+
+void JsonWriter::null()
+{
+    separate();
+    m_out.append("null", 4);
+}
+
+void JsonWriter::raw(const QByteArray& json)
+{
+    separate();
+    m_out.append(json);
+}
+
+void JsonWriter::beginApiList(int count)
+{
+    beginObject();
+    field("code", 0);
+    key("data");
+    beginObject();
+    field("count", count);
+    key("data");
+    beginArray();
+}
+
+void JsonWriter::beginApiList()
+{
+    beginObject();
+    field("code", 0);
+    key("data");
+    beginObject();
+    key("count");
+    // 值暂缺，下一个键照常写逗号
+    m_afterKey = false;
+    m_countOffset = m_out.size();
+    key("data");
+    beginArray();
+}
+
+void JsonWriter::endApiList(const QString& message, int count)
+{
+    // 插入一次，移动的是已写出的数组字节，不再为每条记录保留中间结果
+    m_out.insert(m_countOffset, QByteArray::number(count));
+    m_countOffset = -1;
+    endApiList(message);
+}
+
+void JsonWriter::endApiList(const QString& message)
+{
+    endArray();
+    field("message", message);
+    field("success", true);
+    endObject();
+    field("msg", "success");
+    endObject();
+}
+
+void JsonWriter::separate()
+{
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_first.isEmpty()) {
+        return;
+    }
+    if (m_first.last()) {
+        m_first.last() = false;
+    } else {
+        m_out.append(',');
+    }
+}
+
+void JsonWriter::writeString(const QString& text)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    m_out.append('"');
+
+    QByteArray utf8 = text.toUtf8();
+    const char* data = utf8.constData();
+    const int length = utf8.size();
+
+    // 不需要转义的连续字节整段追加
+    int runStart = 0;
+    for (int i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        m_out.append(data + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (c) {
+            case '"': m_out.append("\\\"", 2); break;
+            case '\\': m_out.append("\\\\", 2); break;
+            case '\b': m_out.append("\\b", 2); break;
+            case '\f': m_out.append("\\f", 2); break;
+            case '\n': m_out.append("\\n", 2); break;
+            case '\r': m_out.append("\\r", 2); break;
+            case '\t': m_out.append("\\t", 2); break;
+            default:
+                m_out.append("\\u00", 4);
+                m_out.append(hexDigits[c >> 4]);
+                m_out.append(hexDigits[c & 0xF]);
+                break;
+        }
+    }
+    m_out.append(data + runStart, length - runStart);
+
+    m_out.append('"');
+}
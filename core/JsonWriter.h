@@ -0,0 +1,68 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVarLengthArray>
+#include <cstddef>
+
+// 只进不退的紧凑 JSON 写入器，直接追加到目标缓冲区，不构建中间 DOM
+// 数值与字符串的输出格式与 QJsonDocument::Compact 一致；
+// 对象键按调用顺序输出，需要与 QJsonDocument 逐字节一致时由调用方按字母序写键
+class JsonWriter
+{
+public:
+    explicit JsonWriter(QByteArray& out) : m_out(out) {}
+
+    void beginObject() { separate(); m_out.append('{'); m_first.append(true); }
+    void endObject() { m_first.removeLast(); m_out.append('}'); }
+    void beginArray() { separate(); m_out.append('['); m_first.append(true); }
+    void endArray() { m_first.removeLast(); m_out.append(']'); }
+
+    // 键必须是字符串字面量，长度在编译期确定，且不含需要转义的字符
+    template <std::size_t N>
+    void key(const char (&name)[N])
+    {
+        separate();
+        m_out.append('"');
+        m_out.append(name, static_cast<int>(N - 1));
+        m_out.append("\":", 2);
+        m_afterKey = true;
+    }
+
+    void value(const QString& text);
+    void value(const char* text) { value(QString::fromUtf8(text)); }
+    void value(bool flag);
+    void value(int number);
+    void value(qint64 number);
+    void value(double number);
+    void null();
+
+    // 追加已编码的 JSON 值
+    void raw(const QByteArray& json);
+
+    template <std::size_t N, typename T>
+    void field(const char (&name)[N], const T& v)
+    {
+        key(name);
+        value(v);
+    }
+
+    // 标准列表响应外壳：{"code":0,"data":{"count":N,"data":[ ... ],"message":...,"success":true},"msg":"success"}
+    void beginApiList(int count);
+    void endApiList(const QString& message);
+    // 条数事先未知时（逐行写出的游标结果）：count 在结束时补写到外壳中的位置，输出与上面相同
+    void beginApiList();
+    void endApiList(const QString& message, int count);
+
+private:
+    void separate();
+    void writeString(const QString& text);
+
+    QByteArray& m_out;
+    QVarLengthArray<bool, 16> m_first;   // 每层容器是否尚未写入元素
+    bool m_afterKey = false;
+    int m_countOffset = -1;              // beginApiList() 中 count 值的插入位置
+};
+
+#endif // JSONWRITER_H
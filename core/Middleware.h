@@ -11,6 +11,13 @@ public:
     
     // 处理请求，返回true继续执行，返回false中断执行
     virtual bool handle(HttpRequest& request, HttpResponse& response) = 0;
+    
+    // 处理器执行之后按注册的逆序调用；合并执行的路由在线程池线程中调用，实现必须线程安全
+    virtual void after(const HttpRequest& request, HttpResponse& response)
+    {
+        Q_UNUSED(request);
+        Q_UNUSED(response);
+    }
 };
 
 #endif // MIDDLEWARE_H
\ No newline at end of file
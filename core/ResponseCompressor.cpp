@@ -0,0 +1,225 @@
+#include "ResponseCompressor.h"
+#include <QStringList>
+#include <memory>
+#ifdef PARKING_SYSTEM_ZLIB
+#include <zlib.h>
+#else
+#include <QtZlib/zlib.h>
+#endif
+
+namespace {
+
+// 增量压缩流，流式响应每段数据做一次同步刷新，保证客户端能及时解出已发送的内容
+class DeflateStream
+{
+public:
+    DeflateStream(int level, bool gzip)
+    {
+        m_stream.zalloc = Z_NULL;
+        m_stream.zfree = Z_NULL;
+        m_stream.opaque = Z_NULL;
+        m_ok = deflateInit2(&m_stream, level, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~DeflateStream()
+    {
+        if (m_ok) {
+            deflateEnd(&m_stream);
+        }
+    }
+
+    bool isValid() const { return m_ok; }
+
+    // 压缩 input 并追加到 out，finish 为 true 时写出流尾
+    bool feed(const QByteArray& input, bool finish, QByteArray& out)
+    {
+        if (!m_ok) {
+            return false;
+        }
+
+        m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.constData()));
+        m_stream.avail_in = static_cast<uInt>(input.size());
+        int flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+
+        char buffer[16 * 1024];
+        int ret;
+        do {
+            m_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            m_stream.avail_out = sizeof(buffer);
+            ret = deflate(&m_stream, flush);
+            if (ret == Z_STREAM_ERROR) {
+                return false;
+            }
+            out.append(buffer, static_cast<int>(sizeof(buffer) - m_stream.avail_out));
+        } while (m_stream.avail_out == 0 || (finish && ret != Z_STREAM_END));
+
+        return true;
+    }
+
+private:
+    DeflateStream(const DeflateStream&) = delete;
+    DeflateStream& operator=(const DeflateStream&) = delete;
+
+    z_stream m_stream;
+    bool m_ok = false;
+};
+
+}
+
+ResponseCompressor::ResponseCompressor()
+{
+    m_cache.setMaxCost(CACHE_MAX_BYTES);
+}
+
+void ResponseCompressor::setLevel(int level)
+{
+    m_level = qBound(0, level, 9);
+}
+
+void ResponseCompressor::setThreshold(int bytes)
+{
+    m_threshold = qMax(0, bytes);
+}
+
+void ResponseCompressor::apply(HttpResponse& response, const QString& acceptEncoding)
+{
+    if (m_level == 0 || !isCompressible(response)) {
+        return;
+    }
+
+    // 可压缩的响应都随 Accept-Encoding 变化，供中间缓存区分
+    QString vary = response.getHeader("Vary");
+    response.setHeader("Vary", vary.isEmpty() ? QString("Accept-Encoding") : vary + ", Accept-Encoding");
+
+    Encoding encoding = negotiate(acceptEncoding);
+    if (encoding == IDENTITY) {
+        return;
+    }
+
+    if (response.isStreaming()) {
+        auto deflater = std::make_shared<DeflateStream>(m_level, encoding == GZIP);
+        if (!deflater->isValid()) {
+            return;
+        }
+
+        HttpResponse::StreamProducer source = response.producer;
+        response.producer = [source, deflater](QByteArray& chunk) {
+            QByteArray plain;
+            bool more = source(plain);
+            if (!deflater->feed(plain, !more, chunk)) {
+                return false;
+            }
+            return more;
+        };
+        response.setHeader("Content-Encoding", encodingName(encoding));
+        response.appendETagSuffix(encodingName(encoding));
+        return;
+    }
+
+    if (response.body.size() < m_threshold) {
+        return;
+    }
+
+    QByteArray compressed = compressBody(response.body, encoding);
+    if (compressed.isEmpty() || compressed.size() >= response.body.size()) {
+        return;
+    }
+
+    response.body = compressed;
+    response.setHeader("Content-Encoding", encodingName(encoding));
+    response.appendETagSuffix(encodingName(encoding));
+}
+
+ResponseCompressor::Encoding ResponseCompressor::negotiate(const QString& acceptEncoding)
+{
+    if (acceptEncoding.isEmpty()) {
+        return IDENTITY;
+    }
+
+    double gzipQ = -1.0;
+    double deflateQ = -1.0;
+    double wildcardQ = -1.0;
+
+    const QStringList items = acceptEncoding.split(',', QString::SkipEmptyParts);
+    for (const QString& item : items) {
+        QStringList parts = item.split(';');
+        QString coding = parts.takeFirst().trimmed().toLower();
+
+        double q = 1.0;
+        for (const QString& param : parts) {
+            QString p = param.trimmed();
+            if (p.startsWith("q=", Qt::CaseInsensitive)) {
+                bool ok = false;
+                q = p.mid(2).toDouble(&ok);
+                if (!ok) {
+                    q = 0.0;
+                }
+            }
+        }
+
+        if (coding == "gzip" || coding == "x-gzip") {
+            gzipQ = q;
+        } else if (coding == "deflate") {
+            deflateQ = q;
+        } else if (coding == "*") {
+            wildcardQ = q;
+        }
+    }
+
+    // 未显式列出的编码按通配符的 q 值处理
+    if (gzipQ < 0.0) {
+        gzipQ = wildcardQ;
+    }
+    if (deflateQ < 0.0) {
+        deflateQ = wildcardQ;
+    }
+
+    if (gzipQ > 0.0 && gzipQ >= deflateQ) {
+        return GZIP;
+    }
+    if (deflateQ > 0.0) {
+        return DEFLATE;
+    }
+    return IDENTITY;
+}
+
+bool ResponseCompressor::isCompressible(const HttpResponse& response)
+{
+    if (response.statusCode == 204 || response.statusCode == 304 || response.isEventStream()) {
+        return false;
+    }
+    if (!response.getHeader("Content-Encoding").isEmpty()) {
+        return false;
+    }
+
+    QString contentType = response.getHeader("Content-Type").toLower();
+    return contentType.startsWith("application/json")
+        || contentType.startsWith("application/cbor")
+        || contentType.startsWith("application/x-ndjson")
+        || contentType.startsWith("text/");
+}
+
+const char* ResponseCompressor::encodingName(Encoding encoding)
+{
+    return encoding == GZIP ? "gzip" : "deflate";
+}
+
+QByteArray ResponseCompressor::compressBody(const QByteArray& body, Encoding encoding)
+{
+    QPair<int, uint> key(encoding, qHash(body));
+    Entry* cached = m_cache.object(key);
+    if (cached && cached->source == body) {
+        return cached->compressed;
+    }
+
+    DeflateStream deflater(m_level, encoding == GZIP);
+    QByteArray compressed;
+    compressed.reserve(body.size() / 4 + 64);
+    if (!deflater.feed(body, true, compressed)) {
+        return QByteArray();
+    }
+
+    Entry* entry = new Entry{body, compressed};
+    m_cache.insert(key, entry, body.size() + compressed.size());
+    return compressed;
+}
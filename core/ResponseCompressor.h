@@ -0,0 +1,56 @@
+#ifndef RESPONSECOMPRESSOR_H
+#define RESPONSECOMPRESSOR_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QPair>
+#include <QString>
+#include "HttpResponse.h"
+
+// 按 Accept-Encoding 协商的响应压缩（gzip/deflate）
+// 只在 HttpServer 所在线程使用，不做加锁
+class ResponseCompressor
+{
+public:
+    enum Encoding {
+        IDENTITY = 0,
+        GZIP,
+        DEFLATE
+    };
+
+    ResponseCompressor();
+
+    // level 为 zlib 压缩级别 1-9，0 表示关闭压缩
+    void setLevel(int level);
+    int level() const { return m_level; }
+
+    // 小于该字节数的响应体不压缩
+    void setThreshold(int bytes);
+    int threshold() const { return m_threshold; }
+
+    // 按客户端的 Accept-Encoding 压缩响应：普通响应替换 body，流式响应包装生产者
+    void apply(HttpResponse& response, const QString& acceptEncoding);
+
+    // 解析 Accept-Encoding（含 q 值），优先 gzip
+    static Encoding negotiate(const QString& acceptEncoding);
+
+private:
+    struct Entry {
+        QByteArray source;
+        QByteArray compressed;
+    };
+
+    static bool isCompressible(const HttpResponse& response);
+    static const char* encodingName(Encoding encoding);
+
+    // 对相同内容的响应体（如缓存命中的车位列表）复用已压缩的字节
+    QByteArray compressBody(const QByteArray& body, Encoding encoding);
+
+    int m_level = 6;
+    int m_threshold = 1024;
+    QCache<QPair<int, uint>, Entry> m_cache;   // 以字节数计成本的 LRU
+
+    static const int CACHE_MAX_BYTES = 16 * 1024 * 1024;
+};
+
+#endif // RESPONSECOMPRESSOR_H
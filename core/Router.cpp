@@ -1,5 +1,6 @@
 #include "Router.h"
 #include "Middleware.h"
+#include "SingleFlight.h"
 #include <QDebug>
 
 Route::Route(const QString& method, const QString& path, 
@@ -12,6 +13,7 @@ Route::Route(const QString& method, const QString& path,
 
 Router::Router(QObject *parent) : QObject(parent)
 {
+    m_singleFlight = new SingleFlight(this);
 }
 
 void Router::get(const QString& path, const QList<Middleware*>& middlewares,
@@ -45,6 +47,18 @@ void Router::addRoute(const QString& method, const QString& path,
     routes.append(Route(method, path, middlewares, handler));
 }
 
+bool Router::coalesce(const QString& path)
+{
+    for (auto& route : routes) {
+        if (route.method == "GET" && route.path == path) {
+            route.coalesced = true;
+            return true;
+        }
+    }
+    qWarning() << "Cannot coalesce unregistered route:" << path;
+    return false;
+}
+
 bool Router::handleRequest(HttpRequest& request, HttpResponse& response)
 {
     qDebug() << "Router handling request:" << request.method << request.path;
@@ -64,7 +78,15 @@ bool Router::handleRequest(HttpRequest& request, HttpResponse& response)
             
             // 执行路由处理器
             if (route.handler) {
-                route.handler(request, response);
+                if (route.coalesced) {
+                    // 路由表在启动后不再修改，元素地址稳定
+                    const Route* matched = &route;
+                    m_singleFlight->run(route.path, request, response, [matched](HttpRequest& req, HttpResponse& res) {
+                        runHandler(*matched, req, res);
+                    });
+                } else {
+                    runHandler(route, request, response);
+                }
                 return true;
             }
         }
@@ -76,6 +98,14 @@ bool Router::handleRequest(HttpRequest& request, HttpResponse& response)
     return false;
 }
 
+void Router::runHandler(const Route& route, HttpRequest& request, HttpResponse& response)
+{
+    route.handler(request, response);
+    for (int i = route.middlewares.size() - 1; i >= 0; --i) {
+        route.middlewares[i]->after(request, response);
+    }
+}
+
 QRegularExpression Router::pathToRegex(const QString& path)
 {
     QString pattern = path;
@@ -11,6 +11,7 @@
 #include "HttpResponse.h"
 
 class Middleware;
+class SingleFlight;
 
 struct Route {
     QString method;
@@ -18,6 +19,7 @@ struct Route {
     QRegularExpression regex;
     QList<Middleware*> middlewares;
     std::function<void(HttpRequest&, HttpResponse&)> handler;
+    bool coalesced = false;   // 相同请求合并执行
     
     Route(const QString& method, const QString& path, 
           const QList<Middleware*>& middlewares,
@@ -41,6 +43,11 @@ public:
     void del(const QString& path, const QList<Middleware*>& middlewares,
              std::function<void(HttpRequest&, HttpResponse&)> handler);
     
+    // 对已注册的 GET 路由启用请求合并：并发的相同请求只执行一次处理器
+    // 处理器会在线程池中运行，必须只读且线程安全
+    bool coalesce(const QString& path);
+    SingleFlight* singleFlight() const { return m_singleFlight; }
+    
     // 路由处理方法
     bool handleRequest(HttpRequest& request, HttpResponse& response);
 
@@ -48,12 +55,16 @@ public:
     
 private:
     QList<Route> routes;
+    SingleFlight* m_singleFlight;
     
     void addRoute(const QString& method, const QString& path, 
                   const QList<Middleware*>& middlewares,
                   std::function<void(HttpRequest&, HttpResponse&)> handler);
     
     bool matchRoute(const Route& route, const QString& method, const QString& path, HttpRequest& request);
+    
+    // 执行处理器及中间件的后置处理
+    static void runHandler(const Route& route, HttpRequest& request, HttpResponse& response);
 };
 
 #endif // ROUTER_H
\ No newline at end of file
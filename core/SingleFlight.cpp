@@ -0,0 +1,109 @@
+#include "SingleFlight.h"
+#include "../utils/Logger.h"
+#include <QtConcurrent>
+#include <QFutureWatcher>
+
+SingleFlight::SingleFlight(QObject* parent) : QObject(parent)
+{
+}
+
+void SingleFlight::run(const QString& route, const HttpRequest& request, HttpResponse& response, const Handler& handler)
+{
+    QString key = keyFor(request);
+    auto handle = std::make_shared<DeferredResponse>();
+    response.defer(handle);
+
+    Counters& counters = m_counters[route];
+    counters.requests++;
+
+    auto it = m_flights.find(key);
+    if (it != m_flights.end()) {
+        // 已有相同请求在执行，等待其结果
+        it->waiters.append(handle);
+        counters.collapsed++;
+        return;
+    }
+
+    Flight flight;
+    flight.route = route;
+    flight.waiters.append(handle);
+    m_flights.insert(key, flight);
+    counters.executions++;
+
+    // 处理函数在线程池中运行，事件循环继续接收请求
+    auto* watcher = new QFutureWatcher<HttpResponse>(this);
+    connect(watcher, &QFutureWatcher<HttpResponse>::finished, this, [this, watcher, key]() {
+        finish(key, watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([handler, request]() {
+        HttpRequest workerRequest = request;
+        HttpResponse workerResponse;
+        try {
+            handler(workerRequest, workerResponse);
+        } catch (const std::exception& e) {
+            Logger::error(QString("Error in coalesced handler %1: %2").arg(workerRequest.path).arg(e.what()));
+            workerResponse = HttpResponse();
+            workerResponse.serverError("Internal server error");
+        }
+        return workerResponse;
+    }));
+}
+
+void SingleFlight::finish(const QString& key, const HttpResponse& response)
+{
+    Flight flight = m_flights.take(key);
+    m_maxWaiters = qMax(m_maxWaiters, flight.waiters.size());
+
+    HttpResponse shared = response;
+    if (shared.isStreaming() || shared.isEventStream() || shared.isDeferred()) {
+        // 流式和挂起的响应无法分发给多个连接
+        Logger::error(QString("Route %1 cannot be coalesced: response is not a plain body").arg(flight.route));
+        shared = HttpResponse();
+        shared.serverError("Internal server error");
+    }
+
+    // 响应体隐式共享，每个等待者只复制头部；压缩和 CBOR 由服务器按各自请求协商
+    for (const auto& handle : flight.waiters) {
+        HttpResponse copy = shared;
+        handle->complete(copy);
+    }
+}
+
+QString SingleFlight::keyFor(const HttpRequest& request)
+{
+    QString key = request.method + ' ' + request.normalizedTarget();
+
+    QString ifNoneMatch = request.getHeader("if-none-match");
+    if (!ifNoneMatch.isEmpty()) {
+        key += '#' + ifNoneMatch;
+    }
+    return key;
+}
+
+QJsonObject SingleFlight::statistics() const
+{
+    Counters total;
+    QJsonObject routes;
+    for (auto it = m_counters.constBegin(); it != m_counters.constEnd(); ++it) {
+        QJsonObject route;
+        route["requests"] = it->requests;
+        route["executions"] = it->executions;
+        route["collapsed"] = it->collapsed;
+        routes[it.key()] = route;
+
+        total.requests += it->requests;
+        total.executions += it->executions;
+        total.collapsed += it->collapsed;
+    }
+
+    QJsonObject stats;
+    stats["requests"] = total.requests;
+    stats["executions"] = total.executions;
+    stats["collapsed"] = total.collapsed;
+    stats["collapseRatio"] = total.requests > 0 ? (double)total.collapsed / total.requests : 0.0;
+    stats["inFlight"] = m_flights.size();
+    stats["maxWaiters"] = m_maxWaiters;
+    stats["routes"] = routes;
+    return stats;
+}
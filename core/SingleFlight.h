@@ -0,0 +1,53 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QJsonObject>
+#include <functional>
+#include <memory>
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+
+// 相同 GET 请求的合并执行（single-flight）
+// 同一键同一时刻只在线程池中运行一次处理函数，期间到达的相同请求挂起等待，结果响应体共享给所有等待者
+// 处理函数必须只读且线程安全；run 只在 HttpServer 所在线程调用
+class SingleFlight : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(HttpRequest&, HttpResponse&)> Handler;
+
+    explicit SingleFlight(QObject* parent = nullptr);
+
+    // 执行或加入同键的执行；response 被设为挂起，完成时由服务器发送
+    void run(const QString& route, const HttpRequest& request, HttpResponse& response, const Handler& handler);
+
+    // 请求键：方法 + 路径 + 按参数名排序的查询串 + If-None-Match
+    static QString keyFor(const HttpRequest& request);
+
+    // 合并统计：总请求数、实际执行数、被合并的请求数（总计及按路由）
+    QJsonObject statistics() const;
+
+private:
+    struct Flight {
+        QString route;
+        QList<std::shared_ptr<DeferredResponse>> waiters;
+    };
+
+    struct Counters {
+        qint64 requests = 0;
+        qint64 executions = 0;
+        qint64 collapsed = 0;
+    };
+
+    void finish(const QString& key, const HttpResponse& response);
+
+    QHash<QString, Flight> m_flights;      // 正在执行的请求
+    QHash<QString, Counters> m_counters;   // 按路由统计
+    int m_maxWaiters = 0;                  // 单次执行分发到的最多请求数
+};
+
+#endif // SINGLEFLIGHT_H
@@ -0,0 +1,199 @@
+#include "WebSocketSession.h"
+#include "../utils/Logger.h"
+#include <QTcpSocket>
+#include <QCryptographicHash>
+#include <QtEndian>
+
+WebSocketSession::WebSocketSession(QTcpSocket* socket, const MessageHandler& handler)
+    : QObject(nullptr), m_socket(socket), m_handler(handler)
+{
+}
+
+void WebSocketSession::feed(const QByteArray& data)
+{
+    m_buffer.append(data);
+    while (!m_closing && processFrame()) {
+    }
+}
+
+void WebSocketSession::sendText(const QByteArray& text)
+{
+    if (m_closing) {
+        return;
+    }
+    m_socket->write(encodeFrame(TEXT, text));
+}
+
+void WebSocketSession::close(quint16 code, const QByteArray& reason)
+{
+    if (m_closing) {
+        return;
+    }
+    m_closing = true;
+
+    QByteArray payload(2, Qt::Uninitialized);
+    qToBigEndian<quint16>(code, reinterpret_cast<uchar*>(payload.data()));
+    payload.append(reason.left(123));
+    m_socket->write(encodeFrame(CLOSE, payload));
+    m_socket->disconnectFromHost();   // 发送缓冲区写完后才真正断开
+}
+
+QByteArray WebSocketSession::acceptKey(const QByteArray& clientKey)
+{
+    static const QByteArray GUID("258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+    return QCryptographicHash::hash(clientKey.trimmed() + GUID, QCryptographicHash::Sha1).toBase64();
+}
+
+QByteArray WebSocketSession::encodeFrame(Opcode opcode, const QByteArray& payload)
+{
+    QByteArray frame;
+    quint64 length = static_cast<quint64>(payload.size());
+    frame.reserve(payload.size() + 10);
+    frame.append(static_cast<char>(0x80 | opcode));
+
+    if (length < 126) {
+        frame.append(static_cast<char>(length));
+    } else if (length <= 0xFFFF) {
+        frame.append(static_cast<char>(126));
+        uchar ext[2];
+        qToBigEndian<quint16>(static_cast<quint16>(length), ext);
+        frame.append(reinterpret_cast<const char*>(ext), 2);
+    } else {
+        frame.append(static_cast<char>(127));
+        uchar ext[8];
+        qToBigEndian<quint64>(length, ext);
+        frame.append(reinterpret_cast<const char*>(ext), 8);
+    }
+
+    frame.append(payload);
+    return frame;
+}
+
+bool WebSocketSession::processFrame()
+{
+    if (m_buffer.size() < 2) {
+        return false;
+    }
+
+    const uchar* head = reinterpret_cast<const uchar*>(m_buffer.constData());
+    bool fin = head[0] & 0x80;
+    int opcode = head[0] & 0x0F;
+    bool masked = head[1] & 0x80;
+    quint64 length = head[1] & 0x7F;
+    int offset = 2;
+
+    // 未协商扩展时 RSV 位必须为 0；客户端帧必须加掩码
+    if ((head[0] & 0x70) || !masked) {
+        close(CLOSE_PROTOCOL_ERROR);
+        return false;
+    }
+
+    if (length == 126) {
+        if (m_buffer.size() < offset + 2) {
+            return false;
+        }
+        length = qFromBigEndian<quint16>(head + offset);
+        offset += 2;
+    } else if (length == 127) {
+        if (m_buffer.size() < offset + 8) {
+            return false;
+        }
+        length = qFromBigEndian<quint64>(head + offset);
+        offset += 8;
+        // 64 位长度的最高位必须为 0（RFC 6455 5.2）
+        if (length & (Q_UINT64_C(1) << 63)) {
+            close(CLOSE_PROTOCOL_ERROR);
+            return false;
+        }
+    }
+
+    bool control = opcode & 0x8;
+    if (control && (!fin || length > 125)) {
+        close(CLOSE_PROTOCOL_ERROR);
+        return false;
+    }
+    // 在等待完整帧之前检查长度，避免为超大帧缓冲数据
+    // 用减法比较：m_message 不超过上限，相减不会下溢，而 length 相加可能回绕
+    if (length > static_cast<quint64>(MAX_MESSAGE_SIZE - m_message.size())) {
+        close(CLOSE_MESSAGE_TOO_BIG);
+        return false;
+    }
+
+    const int maskOffset = offset;
+    offset += 4;
+    if (static_cast<quint64>(m_buffer.size()) < offset + length) {
+        return false;
+    }
+
+    QByteArray payload = m_buffer.mid(offset, static_cast<int>(length));
+    const uchar* mask = head + maskOffset;
+    char* bytes = payload.data();
+    for (int i = 0; i < payload.size(); ++i) {
+        bytes[i] ^= mask[i & 3];
+    }
+    m_buffer.remove(0, offset + static_cast<int>(length));
+
+    if (control) {
+        handleControlFrame(opcode, payload);
+        return true;
+    }
+
+    if (opcode == CONTINUATION) {
+        if (m_messageOpcode < 0) {
+            close(CLOSE_PROTOCOL_ERROR);
+            return false;
+        }
+        m_message.append(payload);
+    } else if (opcode == TEXT || opcode == BINARY) {
+        if (m_messageOpcode >= 0) {
+            close(CLOSE_PROTOCOL_ERROR);   // 上一条分片消息尚未结束
+            return false;
+        }
+        m_messageOpcode = opcode;
+        m_message = payload;
+    } else {
+        close(CLOSE_PROTOCOL_ERROR);
+        return false;
+    }
+
+    if (!fin) {
+        return true;
+    }
+
+    int messageOpcode = m_messageOpcode;
+    QByteArray message;
+    message.swap(m_message);
+    m_messageOpcode = -1;
+
+    if (messageOpcode != TEXT) {
+        // 只接受 JSON 文本消息
+        close(CLOSE_UNSUPPORTED_DATA, "Text frames only");
+        return false;
+    }
+
+    m_handler(this, message);
+    return true;
+}
+
+void WebSocketSession::handleControlFrame(int opcode, const QByteArray& payload)
+{
+    switch (opcode) {
+    case PING:
+        m_socket->write(encodeFrame(PONG, payload));
+        break;
+    case PONG:
+        break;
+    case CLOSE: {
+        // 回送对方的状态码后断开
+        quint16 code = CLOSE_NORMAL;
+        if (payload.size() >= 2) {
+            code = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(payload.constData()));
+        }
+        close(code);
+        break;
+    }
+    default:
+        close(CLOSE_PROTOCOL_ERROR);
+        break;
+    }
+}
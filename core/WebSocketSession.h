@@ -0,0 +1,70 @@
+#ifndef WEBSOCKETSESSION_H
+#define WEBSOCKETSESSION_H
+
+#include <QObject>
+#include <QByteArray>
+#include <functional>
+
+class QTcpSocket;
+
+// 已完成升级握手的 RFC 6455 连接：解析客户端帧、回应控制帧，完整的文本消息交给处理函数
+// 只在 HttpServer 所在线程使用
+class WebSocketSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Opcode {
+        CONTINUATION = 0x0,
+        TEXT = 0x1,
+        BINARY = 0x2,
+        CLOSE = 0x8,
+        PING = 0x9,
+        PONG = 0xA
+    };
+
+    // 关闭状态码
+    enum CloseCode {
+        CLOSE_NORMAL = 1000,
+        CLOSE_PROTOCOL_ERROR = 1002,
+        CLOSE_UNSUPPORTED_DATA = 1003,
+        CLOSE_MESSAGE_TOO_BIG = 1009
+    };
+
+    typedef std::function<void(WebSocketSession* session, const QByteArray& message)> MessageHandler;
+
+    WebSocketSession(QTcpSocket* socket, const MessageHandler& handler);
+
+    QTcpSocket* socket() const { return m_socket; }
+    bool isClosing() const { return m_closing; }
+
+    // 追加收到的数据并处理其中所有完整的帧
+    void feed(const QByteArray& data);
+
+    void sendText(const QByteArray& text);
+
+    // 发送关闭帧，写完后断开连接
+    void close(quint16 code, const QByteArray& reason = QByteArray());
+
+    // 握手响应中的 Sec-WebSocket-Accept
+    static QByteArray acceptKey(const QByteArray& clientKey);
+
+    // 编码一个服务端帧（不加掩码，FIN 置位）
+    static QByteArray encodeFrame(Opcode opcode, const QByteArray& payload);
+
+private:
+    // 解析缓冲区头部的一个帧；帧不完整时返回 false
+    bool processFrame();
+    void handleControlFrame(int opcode, const QByteArray& payload);
+
+    QTcpSocket* m_socket;
+    MessageHandler m_handler;
+    QByteArray m_buffer;
+    QByteArray m_message;        // 分片消息的已接收部分
+    int m_messageOpcode = -1;    // 正在接收的分片消息类型，-1 表示没有
+    bool m_closing = false;
+
+    static const qint64 MAX_MESSAGE_SIZE = 1024 * 1024;
+};
+
+#endif // WEBSOCKETSESSION_H
@@ -0,0 +1,123 @@
+#include "ActiveSessionIndex.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+
+ActiveSessionIndex& ActiveSessionIndex::instance()
+{
+    static ActiveSessionIndex instance;
+    return instance;
+}
+
+void ActiveSessionIndex::rebuild(const QList<ParkingRecord>& activeRecords)
+{
+    QWriteLocker locker(&m_lock);
+
+    m_byId.clear();
+    m_byPlate.clear();
+    m_byRawPlate.clear();
+    m_bySpace.clear();
+    for (const ParkingRecord& record : activeRecords) {
+        applyLocked(record);
+    }
+    m_loaded = true;
+}
+
+bool ActiveSessionIndex::isLoaded() const
+{
+    QReadLocker locker(&m_lock);
+    return m_loaded;
+}
+
+QList<ParkingRecord> ActiveSessionIndex::findByPlate(const QString& plate) const
+{
+    PlateId id = PlateId::fromString(plate);
+
+    QReadLocker locker(&m_lock);
+    return collect(id.isValid() ? m_byPlate.values(id) : m_byRawPlate.values(plate));
+}
+
+QList<ParkingRecord> ActiveSessionIndex::findBySpaceId(int spaceId) const
+{
+    QReadLocker locker(&m_lock);
+    return collect(m_bySpace.values(spaceId));
+}
+
+QList<ParkingRecord> ActiveSessionIndex::findAll() const
+{
+    QReadLocker locker(&m_lock);
+    return collect(m_byId.keys());
+}
+
+bool ActiveSessionIndex::isPlateActive(const QString& plate) const
+{
+    PlateId id = PlateId::fromString(plate);
+
+    QReadLocker locker(&m_lock);
+    return id.isValid() ? m_byPlate.contains(id) : m_byRawPlate.contains(plate);
+}
+
+bool ActiveSessionIndex::isSpaceActive(int spaceId) const
+{
+    QReadLocker locker(&m_lock);
+    return m_bySpace.contains(spaceId);
+}
+
+int ActiveSessionIndex::count() const
+{
+    QReadLocker locker(&m_lock);
+    return m_byId.size();
+}
+
+void ActiveSessionIndex::applyLocked(const ParkingRecord& record)
+{
+    if (record.getId() <= 0) {
+        return;
+    }
+
+    removeLocked(record.getId());
+
+    // 已结束的记录不再属于活跃会话
+    if (!record.isActive()) {
+        return;
+    }
+
+    m_byId.insert(record.getId(), record);
+    PlateId plateId = PlateId::fromString(record.getPlate());
+    if (plateId.isValid()) {
+        m_byPlate.insert(plateId, record.getId());
+    } else {
+        m_byRawPlate.insert(record.getPlate(), record.getId());
+    }
+    m_bySpace.insert(record.getSpaceId(), record.getId());
+}
+
+void ActiveSessionIndex::removeLocked(int recordId)
+{
+    auto it = m_byId.find(recordId);
+    if (it == m_byId.end()) {
+        return;
+    }
+
+    PlateId plateId = PlateId::fromString(it->getPlate());
+    if (plateId.isValid()) {
+        m_byPlate.remove(plateId, recordId);
+    } else {
+        m_byRawPlate.remove(it->getPlate(), recordId);
+    }
+    m_bySpace.remove(it->getSpaceId(), recordId);
+    m_byId.erase(it);
+}
+
+QList<ParkingRecord> ActiveSessionIndex::collect(const QList<int>& recordIds) const
+{
+    QList<int> ids = recordIds;
+    std::sort(ids.begin(), ids.end());
+
+    QList<ParkingRecord> records;
+    records.reserve(ids.size());
+    for (int id : ids) {
+        records.append(m_byId.value(id));
+    }
+    return records;
+}
@@ -0,0 +1,52 @@
+#ifndef ACTIVESESSIONINDEX_H
+#define ACTIVESESSIONINDEX_H
+
+#include "../models/ParkingRecord.h"
+#include "../utils/PlateId.h"
+#include <QHash>
+#include <QMultiHash>
+#include <QList>
+#include <QReadWriteLock>
+
+// 活跃停车会话（exit_time IS NULL）的内存索引，按车牌和车位双向查找
+// 写入由 ParkingRecordRepository 在数据库事务提交后、持有写锁期间完成
+class ActiveSessionIndex
+{
+public:
+    static ActiveSessionIndex& instance();
+
+    // 用数据库中的活跃记录重建索引
+    void rebuild(const QList<ParkingRecord>& activeRecords);
+    bool isLoaded() const;
+
+    // 查询（读锁）
+    QList<ParkingRecord> findByPlate(const QString& plate) const;
+    QList<ParkingRecord> findBySpaceId(int spaceId) const;
+    QList<ParkingRecord> findAll() const;
+    bool isPlateActive(const QString& plate) const;
+    bool isSpaceActive(int spaceId) const;
+    int count() const;
+
+    // 写锁，调用方只在索引更新期间持有，不跨数据库事务
+    QReadWriteLock* writeLock() { return &m_lock; }
+
+    // 以下方法要求调用方已持有写锁
+    void applyLocked(const ParkingRecord& record);
+    void removeLocked(int recordId);
+
+private:
+    ActiveSessionIndex() = default;
+    ActiveSessionIndex(const ActiveSessionIndex&) = delete;
+    ActiveSessionIndex& operator=(const ActiveSessionIndex&) = delete;
+
+    QList<ParkingRecord> collect(const QList<int>& recordIds) const;
+
+    mutable QReadWriteLock m_lock;
+    QHash<int, ParkingRecord> m_byId;
+    QMultiHash<PlateId, int> m_byPlate;
+    QMultiHash<QString, int> m_byRawPlate;  // 无法编码为 PlateId 的历史车牌
+    QMultiHash<int, int> m_bySpace;
+    bool m_loaded = false;
+};
+
+#endif // ACTIVESESSIONINDEX_H
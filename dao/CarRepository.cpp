@@ -248,7 +248,9 @@ QList<QVariantMap> CarRepository::executeQueryWithResults(const QString& querySt
 QSqlDatabase CarRepository::getDatabase()
 {
     QString dbPath = QDir::currentPath() + "/data/parking_server.db";
-    QString connectionName = QString("car_repo_%1").arg(QDateTime::currentMSecsSinceEpoch());
+    QString connectionName = QString("car_repo_%1_%2")
+        .arg((quintptr)QThread::currentThreadId())
+        .arg(QDateTime::currentMSecsSinceEpoch());
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
     db.setDatabaseName(dbPath);
     if (!db.open()) {
@@ -0,0 +1,227 @@
+#include "DatabaseSchema.h"
+#include "RollupRepository.h"
+#include "../utils/Logger.h"
+#include <QSqlError>
+#include <QSqlQuery>
+
+bool DatabaseSchema::create(QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    
+    // 创建车辆表 - 与Car模型保持一致
+    QString createCarTable = R"(
+        CREATE TABLE IF NOT EXISTS cars (
+            plate TEXT PRIMARY KEY,
+            type TEXT DEFAULT '小型车',
+            color TEXT,
+            create_time DATETIME DEFAULT CURRENT_TIMESTAMP,
+            update_time DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )";
+    
+    if (!query.exec(createCarTable)) {
+        LOG_ERROR("Failed to create cars table: " + query.lastError().text());
+        return false;
+    }
+    
+    // 创建停车位表 - 与ParkingSpace模型保持一致
+    QString createSpaceTable = R"(
+        CREATE TABLE IF NOT EXISTS parking_spaces (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            location TEXT NOT NULL,
+            status TEXT DEFAULT 'available',
+            current_plate TEXT,
+            occupied_time DATETIME,
+            type TEXT DEFAULT '普通',
+            hourly_rate REAL DEFAULT 5.0,
+            version INTEGER DEFAULT 0
+        )
+    )";
+    
+    if (!query.exec(createSpaceTable)) {
+        LOG_ERROR("Failed to create spaces table: " + query.lastError().text());
+        return false;
+    }
+    
+    // 创建停车记录表 - 与ParkingRecord模型保持一致
+    QString createParkingRecordTable = R"(
+        CREATE TABLE IF NOT EXISTS parking_records (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            plate TEXT NOT NULL,
+            space_id INTEGER NOT NULL,
+            enter_time DATETIME NOT NULL,
+            exit_time DATETIME,
+            fee REAL DEFAULT 0.0,
+            is_paid INTEGER DEFAULT 0,
+            pay_time DATETIME,
+            pay_method TEXT,
+            version INTEGER DEFAULT 0,
+            space_type TEXT,
+            zone TEXT,
+            FOREIGN KEY (plate) REFERENCES cars(plate),
+            FOREIGN KEY (space_id) REFERENCES parking_spaces(id)
+        )
+    )";
+    
+    if (!query.exec(createParkingRecordTable)) {
+        LOG_ERROR("Failed to create parking_records table: " + query.lastError().text());
+        return false;
+    }
+    
+    // 按进场时间的范围扫描（导出、报表）
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_parking_records_enter_time ON parking_records(enter_time, id)")) {
+        LOG_ERROR("Failed to create parking_records enter_time index: " + query.lastError().text());
+        return false;
+    }
+    
+    // 旧数据库升级：补充乐观并发所需的版本列
+    if (!ensureColumn(db, "parking_spaces", "version", "INTEGER DEFAULT 0") ||
+        !ensureColumn(db, "parking_records", "version", "INTEGER DEFAULT 0")) {
+        return false;
+    }
+    
+    // 旧数据库升级：记录保存进场时的汇总维度，旧记录按车位当前的类型和区域一次性补齐（与汇总表回填时的口径一致）
+    bool dimensionAdded = false;
+    if (!ensureColumn(db, "parking_records", "space_type", "TEXT", &dimensionAdded) ||
+        !ensureColumn(db, "parking_records", "zone", "TEXT")) {
+        return false;
+    }
+    if (dimensionAdded && !query.exec(R"(
+        UPDATE parking_records SET
+            space_type = (SELECT type FROM parking_spaces WHERE parking_spaces.id = parking_records.space_id),
+            zone = (SELECT CASE WHEN instr(location, '-') > 1 THEN substr(location, 1, instr(location, '-') - 1)
+                                ELSE location END
+                    FROM parking_spaces WHERE parking_spaces.id = parking_records.space_id)
+        WHERE space_type IS NULL
+    )")) {
+        LOG_ERROR("Failed to backfill parking record dimensions: " + query.lastError().text());
+        return false;
+    }
+    
+    // 创建支付记录表
+    QString createPaymentTable = R"(
+        CREATE TABLE IF NOT EXISTS payments (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            parking_record_id INTEGER NOT NULL,
+            amount REAL NOT NULL,
+            payment_method TEXT NOT NULL,
+            payment_time DATETIME DEFAULT CURRENT_TIMESTAMP,
+            status TEXT DEFAULT '已完成',
+            transaction_id TEXT,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            FOREIGN KEY (parking_record_id) REFERENCES parking_records(id)
+        )
+    )";
+    
+    if (!query.exec(createPaymentTable)) {
+        LOG_ERROR("Failed to create payments table: " + query.lastError().text());
+        return false;
+    }
+    
+    // 创建计费规则表
+    QString createBillingTable = R"(
+        CREATE TABLE IF NOT EXISTS billing_rules (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            rule_name TEXT NOT NULL,
+            space_type TEXT DEFAULT '普通',
+            hourly_rate REAL DEFAULT 5.0,
+            daily_rate REAL DEFAULT 50.0,
+            monthly_rate REAL DEFAULT 800.0,
+            night_rate REAL DEFAULT 3.0,
+            weekend_rate REAL DEFAULT 6.0,
+            holiday_rate REAL DEFAULT 8.0,
+            min_fee REAL DEFAULT 5.0,
+            max_fee REAL DEFAULT 200.0,
+            is_active INTEGER DEFAULT 1,
+            effective_date DATETIME DEFAULT CURRENT_TIMESTAMP,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
+        )
+    )";
+    
+    if (!query.exec(createBillingTable)) {
+        LOG_ERROR("Failed to create billing_rules table: " + query.lastError().text());
+        return false;
+    }
+    
+    // 创建排队表
+    QString createQueueTable = R"(
+        CREATE TABLE IF NOT EXISTS parking_queue (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            plate TEXT NOT NULL,
+            queue_time DATETIME DEFAULT CURRENT_TIMESTAMP,
+            UNIQUE(plate)
+        )
+    )";
+    
+    if (!query.exec(createQueueTable)) {
+        LOG_ERROR("Failed to create parking_queue table: " + query.lastError().text());
+        return false;
+    }
+    
+    // 停车记录按小时/按天的汇总表，报表按范围汇总时读取，随记录写入在同一事务内更新
+    for (const char* table : {"rollup_hourly", "rollup_daily"}) {
+        QString createRollupTable = QString(R"(
+            CREATE TABLE IF NOT EXISTS %1 (
+                bucket TEXT NOT NULL,
+                space_type TEXT NOT NULL DEFAULT '',
+                zone TEXT NOT NULL DEFAULT '',
+                pay_method TEXT NOT NULL DEFAULT '',
+                entries INTEGER DEFAULT 0,
+                exits INTEGER DEFAULT 0,
+                duration_seconds INTEGER DEFAULT 0,
+                paid_count INTEGER DEFAULT 0,
+                billed_revenue REAL DEFAULT 0.0,
+                paid_revenue REAL DEFAULT 0.0,
+                PRIMARY KEY (bucket, space_type, zone, pay_method)
+            )
+        )").arg(table);
+        
+        if (!query.exec(createRollupTable)) {
+            LOG_ERROR(QString("Failed to create %1 table: %2").arg(table, query.lastError().text()));
+            return false;
+        }
+    }
+    
+    if (!query.exec("CREATE TABLE IF NOT EXISTS rollup_state (key TEXT PRIMARY KEY, value TEXT)")) {
+        LOG_ERROR("Failed to create rollup_state table: " + query.lastError().text());
+        return false;
+    }
+    
+    // 已有历史记录的库需要用 --rebuild-rollups 回填，之前报表直接扫描停车记录
+    if (!RollupRepository::markReadyIfEmpty(db)) {
+        LOG_WARNING("Rollup tables are not built yet, reports will scan parking_records; run with --rebuild-rollups to backfill");
+    }
+    
+    return true;
+}
+
+bool DatabaseSchema::ensureColumn(QSqlDatabase& db, const QString& table,
+                                  const QString& column, const QString& definition, bool* added)
+{
+    if (added) {
+        *added = false;
+    }
+    QSqlQuery query(db);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        LOG_ERROR(QString("Failed to inspect table %1: %2").arg(table, query.lastError().text()));
+        return false;
+    }
+    
+    while (query.next()) {
+        if (query.value("name").toString() == column) {
+            return true;
+        }
+    }
+    
+    if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition))) {
+        LOG_ERROR(QString("Failed to add column %1.%2: %3").arg(table, column, query.lastError().text()));
+        return false;
+    }
+    
+    LOG_INFO(QString("Added column %1.%2").arg(table, column));
+    if (added) {
+        *added = true;
+    }
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef DATABASESCHEMA_H
+#define DATABASESCHEMA_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+// 数据库表结构和旧库升级，服务启动和测试共用同一份定义
+class DatabaseSchema
+{
+public:
+    // 在已打开的连接上创建全部表和索引，并为旧库补齐新增的列
+    static bool create(QSqlDatabase& db);
+
+private:
+    // 表中没有该列时追加；added 非空时写回是否本次新增
+    static bool ensureColumn(QSqlDatabase& db, const QString& table, const QString& column, const QString& definition,
+                             bool* added = nullptr);
+};
+
+#endif // DATABASESCHEMA_H
@@ -0,0 +1,153 @@
+#include "ParkingRecordCursor.h"
+#include "ParkingRecordRepository.h"
+#include "../utils/Logger.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QAtomicInt>
+#include <QThread>
+#include <QDir>
+#include <QStringList>
+
+namespace {
+QAtomicInt cursorSequence;
+}
+
+const char* const ParkingRecordCursor::COLUMNS =
+    "id, plate, space_id, enter_time, exit_time, fee, is_paid, pay_time, pay_method, version, space_type, zone";
+
+ParkingRecordCursor::ParkingRecordCursor(const QString& filter, const QVariantList& bindValues, Order order)
+    : m_filter(filter)
+    , m_bindValues(bindValues)
+    , m_order(order)
+{
+    // 游标存活期间独占一个连接，名称用序号区分同一毫秒内打开的多个游标
+    m_connectionName = QString("record_cursor_%1_%2")
+        .arg((quintptr)QThread::currentThreadId())
+        .arg(cursorSequence.fetchAndAddRelaxed(1));
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    db.setDatabaseName(QDir::currentPath() + "/data/parking_server.db");
+    if (!db.open()) {
+        Logger::error("Failed to open database for cursor: " + db.lastError().text());
+        return;
+    }
+
+    m_query.reset(new QSqlQuery(db));
+    m_query->setForwardOnly(true);
+    if (!fetchPage()) {
+        m_query.reset();
+    }
+}
+
+ParkingRecordCursor::~ParkingRecordCursor()
+{
+    close();
+}
+
+bool ParkingRecordCursor::next(ParkingRecord& record)
+{
+    if (!nextRow()) {
+        return false;
+    }
+    record = ParkingRecordRepository::instance().mapToRecord(*m_query);
+    return true;
+}
+
+bool ParkingRecordCursor::nextRow()
+{
+    if (!m_query) {
+        return false;
+    }
+    if (!m_pageActive && !fetchPage()) {
+        close();
+        return false;
+    }
+
+    while (!m_query->next()) {
+        bool lastPage = m_pageRows < PAGE_SIZE;
+        m_query->finish();
+        m_pageActive = false;
+        // 读完立即释放连接，不必等待游标析构
+        if (lastPage || !fetchPage()) {
+            close();
+            return false;
+        }
+    }
+
+    m_pageRows++;
+    m_rowsRead++;
+    m_lastId = m_query->value(COL_ID).toInt();
+    if (m_order != ORDER_BY_ID) {
+        // 按数据库中存储的原值续读，与 ORDER BY 的比较口径一致
+        m_lastEnterTime = m_query->value(COL_ENTER_TIME);
+    }
+    m_hasPosition = true;
+    return true;
+}
+
+void ParkingRecordCursor::suspend()
+{
+    if (m_query && m_pageActive) {
+        m_query->finish();
+        m_pageActive = false;
+    }
+}
+
+bool ParkingRecordCursor::fetchPage()
+{
+    QStringList conditions;
+    if (!m_filter.isEmpty()) {
+        conditions << QString("(%1)").arg(m_filter);
+    }
+    QVariantList bindValues = m_bindValues;
+    if (m_hasPosition) {
+        if (m_order == ORDER_BY_ENTER_TIME) {
+            conditions << "(enter_time > ? OR (enter_time = ? AND id > ?))";
+            bindValues << m_lastEnterTime << m_lastEnterTime << m_lastId;
+        } else if (m_order == ORDER_BY_ENTER_TIME_DESC) {
+            conditions << "(enter_time < ? OR (enter_time = ? AND id < ?))";
+            bindValues << m_lastEnterTime << m_lastEnterTime << m_lastId;
+        } else {
+            conditions << "id > ?";
+            bindValues << m_lastId;
+        }
+    }
+
+    QString sql = QString("SELECT %1 FROM parking_records").arg(COLUMNS);
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    switch (m_order) {
+        case ORDER_BY_ENTER_TIME: sql += " ORDER BY enter_time ASC, id ASC"; break;
+        case ORDER_BY_ENTER_TIME_DESC: sql += " ORDER BY enter_time DESC, id DESC"; break;
+        case ORDER_BY_ID: sql += " ORDER BY id ASC"; break;
+    }
+    sql += QString(" LIMIT %1").arg(PAGE_SIZE);
+
+    m_query->prepare(sql);
+    for (const QVariant& value : bindValues) {
+        m_query->addBindValue(value);
+    }
+    if (!m_query->exec()) {
+        Logger::error(QString("Failed to read parking record cursor page: %1").arg(m_query->lastError().text()));
+        return false;
+    }
+    m_pageActive = true;
+    m_pageRows = 0;
+    return true;
+}
+
+void ParkingRecordCursor::close()
+{
+    // 查询对象必须先于连接移除销毁
+    m_query.reset();
+    m_pageActive = false;
+    if (!m_connectionName.isEmpty()) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(m_connectionName);
+        m_connectionName.clear();
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef PARKINGRECORDCURSOR_H
+#define PARKINGRECORDCURSOR_H
+
+#include "../models/ParkingRecord.h"
+#include <QSqlQuery>
+#include <QString>
+#include <QVariant>
+#include <QVariantList>
+#include <memory>
+
+// 停车记录的只进游标，持有独立的数据库连接，逐行读取而不把结果集整体载入内存
+// 按排序键分页（keyset）读取：每页是一条独立的 LIMIT 查询，读完或 suspend() 后语句即结束，
+// 不会在两次读取之间长期持有 SQLite 的共享锁而阻塞写入
+// 必须在创建它的线程中使用和销毁
+class ParkingRecordCursor
+{
+public:
+    // 游标查询的列顺序，配合 row() 按下标读取
+    enum Column {
+        COL_ID = 0,
+        COL_PLATE,
+        COL_SPACE_ID,
+        COL_ENTER_TIME,
+        COL_EXIT_TIME,
+        COL_FEE,
+        COL_IS_PAID,
+        COL_PAY_TIME,
+        COL_PAY_METHOD,
+        COL_VERSION,
+        COL_SPACE_TYPE,
+        COL_ZONE
+    };
+    static const char* const COLUMNS;   // 与 Column 顺序一致的列清单
+
+    // 排序键，同时是分页续读的位置
+    enum Order {
+        ORDER_BY_ENTER_TIME,        // enter_time, id 升序
+        ORDER_BY_ENTER_TIME_DESC,   // enter_time, id 降序（最新的在前，与 findAll 一致）
+        ORDER_BY_ID                 // id 升序
+    };
+    static const int PAGE_SIZE = 1000;
+
+    ~ParkingRecordCursor();
+
+    bool isValid() const { return m_query != nullptr; }
+
+    // 读取下一行并映射为模型，没有更多行时返回 false
+    bool next(ParkingRecord& record);
+
+    // 只前进不映射，配合 row() 直接读取列值
+    bool nextRow();
+    const QSqlQuery& row() const { return *m_query; }
+
+    int rowsRead() const { return m_rowsRead; }
+
+    // 结束当前页的语句并释放读锁，下次 nextRow() 从最后读到的位置重新查询
+    // 跨事件循环读取（流式导出）时，每次交出控制权前调用；之后不能再访问 row()
+    void suspend();
+
+private:
+    friend class ParkingRecordRepository;
+
+    // filter 为 WHERE 条件（可为空），bindValues 依次绑定其中的占位符
+    ParkingRecordCursor(const QString& filter, const QVariantList& bindValues, Order order);
+    ParkingRecordCursor(const ParkingRecordCursor&) = delete;
+    ParkingRecordCursor& operator=(const ParkingRecordCursor&) = delete;
+
+    bool fetchPage();
+    void close();
+
+    QString m_filter;
+    QVariantList m_bindValues;
+    Order m_order;
+
+    QString m_connectionName;
+    std::unique_ptr<QSqlQuery> m_query;
+    bool m_pageActive = false;      // m_query 上有尚未结束的语句
+    int m_pageRows = 0;             // 当前页已读行数，不足 PAGE_SIZE 即已到末尾
+    bool m_hasPosition = false;     // 已读过至少一行，续读从 m_lastEnterTime/m_lastId 之后开始
+    QVariant m_lastEnterTime;
+    int m_lastId = 0;
+    int m_rowsRead = 0;
+};
+
+#endif // PARKINGRECORDCURSOR_H
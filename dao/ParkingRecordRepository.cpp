@@ -5,7 +5,13 @@
 #include <QThread>
 #include <QThreadStorage>
 #include <QDir>
+#include <QMutexLocker>
+#include <QWriteLocker>
+#include "ActiveSessionIndex.h"
+#include "RollupRepository.h"
+#include "RevenueIndex.h"
 #include "../utils/Logger.h"
+#include "../utils/DataVersion.h"
 
 ParkingRecordRepository& ParkingRecordRepository::instance()
 {
@@ -13,7 +19,55 @@ ParkingRecordRepository& ParkingRecordRepository::instance()
     return instance;
 }
 
-bool ParkingRecordRepository::insert(const ParkingRecord& record)
+bool ParkingRecordRepository::insert(ParkingRecord& record)
+{
+    QSqlDatabase db = getDatabase();
+    if (!db.isOpen()) {
+        Logger::error("Database connection is not open");
+        return false;
+    }
+
+    // 汇总表与记录在同一事务内更新
+    if (!beginWrite(db)) {
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return false;
+    }
+    ParkingRecord inserted = record;
+    RollupRepository::assignDimension(db, inserted);
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO parking_records (plate, space_id, enter_time, exit_time, fee, is_paid, pay_time, pay_method, space_type, zone) "
+                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(inserted.getPlate());
+    query.addBindValue(inserted.getSpaceId());
+    query.addBindValue(inserted.getEnterTime());
+    query.addBindValue(inserted.getExitTime().isValid() ? inserted.getExitTime() : QVariant());
+    query.addBindValue(inserted.getFee());
+    query.addBindValue(inserted.getIsPaid());
+    query.addBindValue(inserted.getPayTime().isValid() ? inserted.getPayTime() : QVariant());
+    query.addBindValue(inserted.getPayMethod());
+    query.addBindValue(inserted.getSpaceType());
+    query.addBindValue(inserted.getZone());
+    if (!query.exec()) {
+        Logger::error(QString("Failed to insert parking record: %1").arg(query.lastError().text()));
+        rollbackWrite(db);
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return false;
+    }
+    inserted.setId(query.lastInsertId().toInt());
+    inserted.setVersion(0);
+    if (!RollupRepository::instance().applyChange(db, nullptr, &inserted)
+        || !commitAndPublish(db, inserted.getId(), nullptr, &inserted)) {
+        rollbackWrite(db);
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return false;
+    }
+    record = inserted;
+    QSqlDatabase::removeDatabase(db.connectionName());
+    return true;
+}
+
+bool ParkingRecordRepository::update(const ParkingRecord& record)
 {
     QSqlDatabase db = getDatabase();
     if (!db.isOpen()) {
@@ -21,8 +75,7 @@ bool ParkingRecordRepository::insert(const ParkingRecord& record)
         return false;
     }
     QSqlQuery query(db);
-    query.prepare("INSERT INTO parking_records (plate, space_id, enter_time, exit_time, fee, is_paid, pay_time, pay_method) "
-                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    query.prepare("UPDATE parking_records SET plate=?, space_id=?, enter_time=?, exit_time=?, fee=?, is_paid=?, pay_time=?, pay_method=?, version=version+1 WHERE id=?");
     query.addBindValue(record.getPlate());
     query.addBindValue(record.getSpaceId());
     query.addBindValue(record.getEnterTime());
@@ -31,9 +84,31 @@ bool ParkingRecordRepository::insert(const ParkingRecord& record)
     query.addBindValue(record.getIsPaid());
     query.addBindValue(record.getPayTime().isValid() ? record.getPayTime() : QVariant());
     query.addBindValue(record.getPayMethod());
+    query.addBindValue(record.getId());
 
+    if (!beginWrite(db)) {
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return false;
+    }
+    ParkingRecord before;
+    bool existed = loadInTransaction(db, record.getId(), before);
     if (!query.exec()) {
-        Logger::error(QString("Failed to insert parking record: %1").arg(query.lastError().text()));
+        Logger::error(QString("Failed to update parking record: %1").arg(query.lastError().text()));
+        rollbackWrite(db);
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return false;
+    }
+    // SQL 中是 version = version + 1，调用方持有的版本可能已过期，以库中实际写入的行为准（含版本和维度）
+    ParkingRecord updated = record;
+    ParkingRecord stored;
+    if (existed && loadInTransaction(db, record.getId(), stored)) {
+        updated.setVersion(stored.getVersion());
+        updated.setSpaceType(stored.getSpaceType());
+        updated.setZone(stored.getZone());
+    }
+    if ((existed && !RollupRepository::instance().applyChange(db, &before, &updated))
+        || !commitAndPublish(db, record.getId(), existed ? &before : nullptr, existed ? &updated : nullptr)) {
+        rollbackWrite(db);
         QSqlDatabase::removeDatabase(db.connectionName());
         return false;
     }
@@ -41,15 +116,16 @@ bool ParkingRecordRepository::insert(const ParkingRecord& record)
     return true;
 }
 
-bool ParkingRecordRepository::update(const ParkingRecord& record)
+WriteResult ParkingRecordRepository::compareAndUpdate(ParkingRecord& record)
 {
     QSqlDatabase db = getDatabase();
     if (!db.isOpen()) {
         Logger::error("Database connection is not open");
-        return false;
+        return WRITE_ERROR;
     }
     QSqlQuery query(db);
-    query.prepare("UPDATE parking_records SET plate=?, space_id=?, enter_time=?, exit_time=?, fee=?, is_paid=?, pay_time=?, pay_method=? WHERE id=?");
+    query.prepare("UPDATE parking_records SET plate=?, space_id=?, enter_time=?, exit_time=?, fee=?, is_paid=?, pay_time=?, pay_method=?, version=? "
+                  "WHERE id=? AND version=?");
     query.addBindValue(record.getPlate());
     query.addBindValue(record.getSpaceId());
     query.addBindValue(record.getEnterTime());
@@ -58,15 +134,42 @@ bool ParkingRecordRepository::update(const ParkingRecord& record)
     query.addBindValue(record.getIsPaid());
     query.addBindValue(record.getPayTime().isValid() ? record.getPayTime() : QVariant());
     query.addBindValue(record.getPayMethod());
+    query.addBindValue(record.getVersion() + 1);
     query.addBindValue(record.getId());
+    query.addBindValue(record.getVersion());
 
+    if (!beginWrite(db)) {
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return WRITE_ERROR;
+    }
+    ParkingRecord before;
+    loadInTransaction(db, record.getId(), before);
     if (!query.exec()) {
         Logger::error(QString("Failed to update parking record: %1").arg(query.lastError().text()));
+        rollbackWrite(db);
         QSqlDatabase::removeDatabase(db.connectionName());
-        return false;
+        return WRITE_ERROR;
+    }
+    if (query.numRowsAffected() == 0) {
+        rollbackWrite(db);
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return WRITE_CONFLICT;
+    }
+    // 维度不随更新改写，以库中原有的为准
+    ParkingRecord updated = record;
+    updated.setVersion(record.getVersion() + 1);
+    updated.setSpaceType(before.getSpaceType());
+    updated.setZone(before.getZone());
+    // 出场和支付都经由这里，汇总与记录同时提交
+    if (!RollupRepository::instance().applyChange(db, &before, &updated)
+        || !commitAndPublish(db, record.getId(), &before, &updated)) {
+        rollbackWrite(db);
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return WRITE_ERROR;
     }
+    record = updated;
     QSqlDatabase::removeDatabase(db.connectionName());
-    return true;
+    return WRITE_OK;
 }
 
 bool ParkingRecordRepository::remove(int id)
@@ -80,8 +183,21 @@ bool ParkingRecordRepository::remove(int id)
     query.prepare("DELETE FROM parking_records WHERE id=?");
     query.addBindValue(id);
 
+    if (!beginWrite(db)) {
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return false;
+    }
+    ParkingRecord before;
+    bool existed = loadInTransaction(db, id, before);
     if (!query.exec()) {
         Logger::error(QString("Failed to delete parking record: %1").arg(query.lastError().text()));
+        rollbackWrite(db);
+        QSqlDatabase::removeDatabase(db.connectionName());
+        return false;
+    }
+    if ((existed && !RollupRepository::instance().applyChange(db, &before, nullptr))
+        || !commitAndPublish(db, id, existed ? &before : nullptr, nullptr)) {
+        rollbackWrite(db);
         QSqlDatabase::removeDatabase(db.connectionName());
         return false;
     }
@@ -112,7 +228,8 @@ ParkingRecord ParkingRecordRepository::findById(int id)
 QList<ParkingRecord> ParkingRecordRepository::findAll(int limit)
 {
     QList<ParkingRecord> records;
-    QString sql = "SELECT * FROM parking_records ORDER BY enter_time DESC";
+    // 进场时间相同的记录按 id 倒序，顺序确定
+    QString sql = "SELECT * FROM parking_records ORDER BY enter_time DESC, id DESC";
     if (limit > 0) {
         sql += " LIMIT ?";
     }
@@ -162,28 +279,60 @@ QList<ParkingRecord> ParkingRecordRepository::findByPlate(const QString& plate)
     return records;
 }
 
+bool ParkingRecordRepository::loadActiveSessions()
+{
+    // 查询失败时不标记索引已加载，活跃会话查询继续走数据库
+    QList<ParkingRecord> records;
+    if (!queryActive(records)) {
+        Logger::error("Failed to load active sessions, falling back to database lookups");
+        return false;
+    }
+    ActiveSessionIndex::instance().rebuild(records);
+    Logger::info(QString("Active session index loaded: %1 sessions").arg(records.size()));
+    return true;
+}
+
 QList<ParkingRecord> ParkingRecordRepository::findActive()
 {
+    if (ActiveSessionIndex::instance().isLoaded()) {
+        return ActiveSessionIndex::instance().findAll();
+    }
     QList<ParkingRecord> records;
+    queryActive(records);
+    return records;
+}
+
+bool ParkingRecordRepository::queryActive(QList<ParkingRecord>& records)
+{
     QSqlDatabase db = getDatabase();
     if (!db.isOpen()) {
         Logger::error("Database connection is not open");
-        return records;
+        return false;
     }
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM parking_records WHERE exit_time IS NULL");
+    bool ok = false;
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT * FROM parking_records WHERE exit_time IS NULL ORDER BY id");
 
-    if (query.exec()) {
-        while (query.next()) {
-            records.append(mapToRecord(query));
+        ok = query.exec();
+        if (ok) {
+            while (query.next()) {
+                records.append(mapToRecord(query));
+            }
+        } else {
+            Logger::error(QString("Failed to query active parking records: %1").arg(query.lastError().text()));
         }
     }
     QSqlDatabase::removeDatabase(db.connectionName());
-    return records;
+    return ok;
 }
 
 QList<ParkingRecord> ParkingRecordRepository::findActiveByPlate(const QString& plate)
 {
+    if (ActiveSessionIndex::instance().isLoaded()) {
+        return ActiveSessionIndex::instance().findByPlate(plate);
+    }
+
     QList<ParkingRecord> records;
     QSqlDatabase db = getDatabase();
     if (!db.isOpen()) {
@@ -207,6 +356,10 @@ QList<ParkingRecord> ParkingRecordRepository::findActiveByPlate(const QString& p
 
 QList<ParkingRecord> ParkingRecordRepository::findActiveBySpaceId(int spaceId)
 {
+    if (ActiveSessionIndex::instance().isLoaded()) {
+        return ActiveSessionIndex::instance().findBySpaceId(spaceId);
+    }
+
     QList<ParkingRecord> records;
     QSqlDatabase db = getDatabase();
     if (!db.isOpen()) {
@@ -270,6 +423,93 @@ int ParkingRecordRepository::count()
     return 0;
 }
 
+std::unique_ptr<ParkingRecordCursor> ParkingRecordRepository::openCursor(const QDateTime& startTime, const QDateTime& endTime)
+{
+    QVariantList bindValues;
+    bindValues << startTime << endTime;
+    // 由 idx_parking_records_enter_time 支持的范围扫描，续读条件同样走该索引
+    return std::unique_ptr<ParkingRecordCursor>(new ParkingRecordCursor(
+        "enter_time >= ? AND enter_time <= ?", bindValues, ParkingRecordCursor::ORDER_BY_ENTER_TIME));
+}
+
+std::unique_ptr<ParkingRecordCursor> ParkingRecordRepository::openNewestFirstCursor(bool unpaidOnly)
+{
+    // is_paid 为 NULL 的旧记录与 mapToRecord 一样按未支付处理
+    return std::unique_ptr<ParkingRecordCursor>(new ParkingRecordCursor(
+        unpaidOnly ? QString("COALESCE(is_paid, 0) = 0") : QString(), QVariantList(),
+        ParkingRecordCursor::ORDER_BY_ENTER_TIME_DESC));
+}
+
+std::unique_ptr<ParkingRecordCursor> ParkingRecordRepository::openCursor()
+{
+    return std::unique_ptr<ParkingRecordCursor>(new ParkingRecordCursor(
+        QString(), QVariantList(), ParkingRecordCursor::ORDER_BY_ID));
+}
+
+bool ParkingRecordRepository::beginWrite(QSqlDatabase& db)
+{
+    // IMMEDIATE 在读取旧记录前取得写锁，其他连接的写入在忙等超时内排队
+    QSqlQuery query(db);
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        Logger::error(QString("Failed to begin parking record transaction: %1").arg(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+bool ParkingRecordRepository::commitWrite(QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("COMMIT")) {
+        Logger::error(QString("Failed to commit parking record transaction: %1").arg(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+void ParkingRecordRepository::rollbackWrite(QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    query.exec("ROLLBACK");
+}
+
+bool ParkingRecordRepository::commitAndPublish(QSqlDatabase& db, int recordId,
+                                               const ParkingRecord* before, const ParkingRecord* after)
+{
+    // 提交与索引更新在同一把互斥锁内，内存索引按提交顺序更新；
+    // 索引写锁只在内存更新期间持有，读者不会被数据库事务阻塞
+    QMutexLocker commitLocker(&m_commitMutex);
+    if (!commitWrite(db)) {
+        return false;
+    }
+
+    {
+        QWriteLocker indexLocker(ActiveSessionIndex::instance().writeLock());
+        if (after) {
+            ActiveSessionIndex::instance().applyLocked(*after);
+        } else if (before) {
+            ActiveSessionIndex::instance().removeLocked(recordId);
+        }
+        if (before || after) {
+            RevenueIndex::instance().applyChange(before, after);
+        }
+    }
+    DataVersion::instance().bump();
+    return true;
+}
+
+bool ParkingRecordRepository::loadInTransaction(QSqlDatabase& db, int id, ParkingRecord& record)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT * FROM parking_records WHERE id=?");
+    query.addBindValue(id);
+    if (query.exec() && query.next()) {
+        record = mapToRecord(query);
+        return true;
+    }
+    return false;
+}
+
 ParkingRecord ParkingRecordRepository::mapToRecord(const QSqlQuery& query)
 {
     ParkingRecord record;
@@ -286,13 +526,18 @@ ParkingRecord ParkingRecordRepository::mapToRecord(const QSqlQuery& query)
         record.setPayTime(query.value("pay_time").toDateTime());
     }
     record.setPayMethod(query.value("pay_method").toString());
+    record.setVersion(query.value("version").toInt());
+    record.setSpaceType(query.value("space_type").toString());
+    record.setZone(query.value("zone").toString());
     return record;
 }
 
 QSqlDatabase ParkingRecordRepository::getDatabase()
 {
     QString dbPath = QDir::currentPath() + "/data/parking_server.db";
-    QString connectionName = QString("record_repo_%1").arg(QDateTime::currentMSecsSinceEpoch());
+    QString connectionName = QString("record_repo_%1_%2")
+        .arg((quintptr)QThread::currentThreadId())
+        .arg(QDateTime::currentMSecsSinceEpoch());
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
     db.setDatabaseName(dbPath);
     if (!db.open()) {
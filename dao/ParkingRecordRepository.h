@@ -2,7 +2,11 @@
 #define PARKINGRECORDREPOSITORY_H
 
 #include "../models/ParkingRecord.h"
+#include "WriteResult.h"
+#include "ParkingRecordCursor.h"
+#include <memory>
 #include <QList>
+#include <QMutex>
 #include <QSqlQuery>
 #include <QThreadStorage>
 #include <QSqlDatabase>
@@ -12,9 +16,11 @@ class ParkingRecordRepository
 public:
     static ParkingRecordRepository& instance();
 
-    bool insert(const ParkingRecord& record);
+    bool insert(ParkingRecord& record);    // 成功后写回新ID和版本
     bool update(const ParkingRecord& record);
     bool remove(int id);
+    // 仅当数据库中的版本与 record 的版本一致时写入；成功后 record 的版本递增
+    WriteResult compareAndUpdate(ParkingRecord& record);
     ParkingRecord findById(int id);
     QList<ParkingRecord> findAll(int limit = -1);
     QList<ParkingRecord> findByPlate(const QString& plate);
@@ -23,6 +29,18 @@ public:
     QList<ParkingRecord> findActiveBySpaceId(int spaceId);
     QList<ParkingRecord> findUnpaidByPlateAndSpace(const QString& plate, int spaceId);
     
+    // 按进场时间范围打开只进游标（按 enter_time, id 升序），用于流式导出
+    std::unique_ptr<ParkingRecordCursor> openCursor(const QDateTime& startTime, const QDateTime& endTime);
+    // 全部记录按 id 升序，用于重建汇总表
+    std::unique_ptr<ParkingRecordCursor> openCursor();
+    // 按 enter_time, id 降序（与 findAll 的顺序一致），用于直接写出列表响应；unpaidOnly 时只含未支付记录
+    std::unique_ptr<ParkingRecordCursor> openNewestFirstCursor(bool unpaidOnly = false);
+    
+    // 启动时从 exit_time IS NULL 的记录重建活跃会话索引；查询失败返回 false，索引保持未加载
+    bool loadActiveSessions();
+    // 持有期间没有记录提交，供需要与增量更新衔接的全量加载使用（如收入索引）
+    QMutex* commitLock() { return &m_commitMutex; }
+    
     // 统计查询方法
     int count();
     int countByDateRange(const QDateTime& startTime, const QDateTime& endTime);
@@ -31,12 +49,26 @@ public:
     double sumRevenueByPaymentStatus(bool isPaid, const QDateTime& startTime, const QDateTime& endTime);
 
 private:
+    friend class ParkingRecordCursor;
+
     ParkingRecordRepository() = default;
     ParkingRecordRepository(const ParkingRecordRepository&) = delete;
     ParkingRecordRepository& operator=(const ParkingRecordRepository&) = delete;
 
+    bool queryActive(QList<ParkingRecord>& records);
+    
+    // 写事务：记录与汇总表（RollupRepository）在同一事务内提交
+    bool beginWrite(QSqlDatabase& db);
+    bool commitWrite(QSqlDatabase& db);
+    void rollbackWrite(QSqlDatabase& db);
+    // 提交并把 before -> after 更新到活跃会话索引和收入索引（删除时 after 为空）
+    // 提交与索引更新在 m_commitMutex 内完成，索引按提交顺序更新；索引写锁只在更新内存时持有，不跨越数据库操作
+    bool commitAndPublish(QSqlDatabase& db, int recordId, const ParkingRecord* before, const ParkingRecord* after);
+    bool loadInTransaction(QSqlDatabase& db, int id, ParkingRecord& record);
     ParkingRecord mapToRecord(const QSqlQuery& query);
     QSqlDatabase getDatabase();
+
+    QMutex m_commitMutex;
 };
 
 #endif // PARKINGRECORDREPOSITORY_H
\ No newline at end of file
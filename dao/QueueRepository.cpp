@@ -1,4 +1,5 @@
 #include "QueueRepository.h"
+#include "../utils/DataVersion.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -26,7 +27,12 @@ bool QueueRepository::insert(const QueueItem& item)
     params["plate"] = item.plate;
     params["queue_time"] = item.queueTime;
 
-    return instance().executeQuery(insertQuery, params);
+    if (!instance().executeQuery(insertQuery, params)) {
+        return false;
+    }
+    m_version.fetchAndAddOrdered(1);
+    DataVersion::instance().bump();
+    return true;
 }
 
 bool QueueRepository::remove(const QString& plate)
@@ -35,7 +41,12 @@ bool QueueRepository::remove(const QString& plate)
     QVariantMap params;
     params["plate"] = plate;
 
-    return instance().executeQuery(deleteQuery, params);
+    if (!instance().executeQuery(deleteQuery, params)) {
+        return false;
+    }
+    m_version.fetchAndAddOrdered(1);
+    DataVersion::instance().bump();
+    return true;
 }
 
 QueueItem QueueRepository::findFirst()
@@ -7,6 +7,7 @@
 #include <QSqlDatabase>
 #include <QDateTime>
 #include <QVariantMap>
+#include <QAtomicInteger>
 
 struct QueueItem {
     int id;
@@ -31,6 +32,9 @@ public:
     QueueItem findByPlate(const QString& plate);
     int getPosition(const QString& plate);
 
+    // 队列写入计数，每次插入/删除后递增；用于判断缓存的排队位置是否过期
+    quint64 version() const { return m_version.loadAcquire(); }
+
 private:
     QueueRepository() = default;
     QueueRepository(const QueueRepository&) = delete;
@@ -41,6 +45,8 @@ private:
     QSqlDatabase getDatabase();
     bool executeQuery(const QString& queryStr, const QVariantMap& params);
     QList<QVariantMap> executeQueryWithResults(const QString& queryStr, const QVariantMap& params = QVariantMap());
+
+    QAtomicInteger<quint64> m_version;
 };
 
 #endif // QUEUEREPOSITORY_H
\ No newline at end of file
@@ -0,0 +1,373 @@
+#include "RevenueIndex.h"
+#include "ParkingRecordRepository.h"
+#include "RollupRepository.h"
+#include "../utils/Logger.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+#include <QWriteLocker>
+#include <algorithm>
+
+namespace {
+
+// 扩容时至少预留的桶数（约一个月）
+const int MIN_GROWTH = 24 * 32;
+
+qint64 lowBit(qint64 i)
+{
+    return i & -i;
+}
+
+qint64 toCents(double amount)
+{
+    return qRound64(amount * 100.0);
+}
+
+}
+
+void RevenueIndex::Sums::add(const Sums& other, int sign)
+{
+    entries += sign * other.entries;
+    paidCount += sign * other.paidCount;
+    billedCents += sign * other.billedCents;
+    paidCents += sign * other.paidCents;
+}
+
+RevenueIndex& RevenueIndex::instance()
+{
+    static RevenueIndex instance;
+    return instance;
+}
+
+qint64 RevenueIndex::hourOf(const QDateTime& time)
+{
+    return time.date().toJulianDay() * 24 + time.time().hour();
+}
+
+QDateTime RevenueIndex::startOfHour(qint64 hour)
+{
+    return QDateTime(QDate::fromJulianDay(hour / 24), QTime(static_cast<int>(hour % 24), 0));
+}
+
+RevenueIndex::Sums RevenueIndex::contribution(const ParkingRecord& record)
+{
+    Sums sums;
+    sums.entries = 1;
+    sums.billedCents = toCents(record.getFee());
+    if (record.getIsPaid()) {
+        sums.paidCount = 1;
+        sums.paidCents = sums.billedCents;
+    }
+    return sums;
+}
+
+bool RevenueIndex::load()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!RollupRepository::instance().isReady()) {
+        Logger::warning("Rollup tables are not backfilled, revenue index disabled");
+        return false;
+    }
+
+    // 加载期间阻止本进程内的记录提交，保证读到的汇总与之后的增量衔接
+    QMutexLocker commitLocker(ParkingRecordRepository::instance().commitLock());
+
+    QString connectionName = QString("revenue_index_%1").arg((quintptr)QThread::currentThreadId());
+    QMap<qint64, Sums> hours;
+    QDateTime latestEnter;
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(QDir::currentPath() + "/data/parking_server.db");
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            ok = query.exec("SELECT bucket, SUM(entries), SUM(paid_count), SUM(billed_revenue), SUM(paid_revenue) "
+                            "FROM rollup_hourly GROUP BY bucket");
+            while (ok && query.next()) {
+                // 小时桶形如 yyyy-MM-ddTHH:00:00
+                QString bucket = query.value(0).toString();
+                QDate date = QDate::fromString(bucket.left(10), "yyyy-MM-dd");
+                if (!date.isValid()) {
+                    continue;
+                }
+                Sums& sums = hours[date.toJulianDay() * 24 + bucket.mid(11, 2).toInt()];
+                sums.entries += query.value(1).toLongLong();
+                sums.paidCount += query.value(2).toLongLong();
+                sums.billedCents += toCents(query.value(3).toDouble());
+                sums.paidCents += toCents(query.value(4).toDouble());
+            }
+            if (ok && query.exec("SELECT MAX(enter_time) FROM parking_records") && query.next()) {
+                latestEnter = query.value(0).toDateTime();
+            }
+            if (!ok) {
+                Logger::error("Failed to read rollup_hourly: " + query.lastError().text());
+            }
+        } else {
+            Logger::error("Failed to open database for revenue index: " + db.lastError().text());
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    if (!ok) {
+        return false;
+    }
+
+    {
+        QWriteLocker locker(&m_lock);
+        m_buckets.clear();
+        m_tree.clear();
+        m_originHour = 0;
+        if (!hours.isEmpty()) {
+            m_originHour = hours.firstKey();
+            m_buckets.resize(static_cast<int>(hours.lastKey() - m_originHour + 1 + MIN_GROWTH));
+            for (auto it = hours.constBegin(); it != hours.constEnd(); ++it) {
+                m_buckets[static_cast<int>(it.key() - m_originHour)] = it.value();
+            }
+        }
+        rebuildTreeLocked();
+        m_latestEnter = latestEnter;
+        m_loaded = true;
+    }
+
+#ifndef QT_NO_DEBUG
+    // 调试构建中与原始记录的合计逐项比对（全表扫描），不一致时不启用，查询退回汇总表
+    // 发布构建不做启动时的全表扫描，索引与汇总表的一致性由 tests/revenueindex 覆盖
+    if (!verifyAgainstDatabase()) {
+        QWriteLocker locker(&m_lock);
+        m_loaded = false;
+        return false;
+    }
+#endif
+
+    Logger::info(QString("Revenue index loaded: %1 hourly buckets in %2 ms")
+                .arg(hours.size()).arg(timer.elapsed()));
+    return true;
+}
+
+bool RevenueIndex::isLoaded() const
+{
+    QReadLocker locker(&m_lock);
+    return m_loaded;
+}
+
+void RevenueIndex::applyChange(const ParkingRecord* before, const ParkingRecord* after)
+{
+    QWriteLocker locker(&m_lock);
+    if (!m_loaded) {
+        return;
+    }
+    if (before && before->getEnterTime().isValid()) {
+        Sums delta;
+        delta.add(contribution(*before), -1);
+        addLocked(hourOf(before->getEnterTime()), delta);
+    }
+    if (after && after->getEnterTime().isValid()) {
+        addLocked(hourOf(after->getEnterTime()), contribution(*after));
+        // 删除记录时不回退，最晚进场时间只作为上界使用
+        if (!m_latestEnter.isValid() || after->getEnterTime() > m_latestEnter) {
+            m_latestEnter = after->getEnterTime();
+        }
+    }
+}
+
+bool RevenueIndex::sumRange(const QDateTime& startTime, const QDateTime& endTime, Sums& sums)
+{
+    if (!startTime.isValid() || !endTime.isValid() || startTime > endTime) {
+        return isLoaded();
+    }
+
+    // 完整的小时从 firstHour 开始；起点不在整点时，起点所在小时的剩余部分读原始记录
+    qint64 firstHour = hourOf(startTime);
+    bool partialHead = startOfHour(firstHour) < startTime;
+    if (partialHead) {
+        firstHour++;
+    }
+    qint64 endHour = hourOf(endTime);
+    bool wholeTail = false;
+
+    {
+        QReadLocker locker(&m_lock);
+        if (!m_loaded) {
+            return false;
+        }
+        // 终点之后没有已计入的进场记录时，终点所在小时可整体计入
+        wholeTail = !m_latestEnter.isValid() || endTime >= m_latestEnter;
+        qint64 toHour = wholeTail ? endHour + 1 : endHour;
+        if (firstHour < toHour) {
+            sums.add(sumHoursLocked(firstHour, toHour));
+        }
+    }
+    m_queries.fetchAndAddRelaxed(1);
+
+    bool scanned = false;
+    if (partialHead) {
+        QDateTime headEnd = startOfHour(firstHour).addMSecs(-1);
+        sumRecords(startTime, headEnd < endTime ? headEnd : endTime, sums);
+        scanned = true;
+    }
+    if (!wholeTail && endHour >= firstHour) {
+        sumRecords(startOfHour(endHour), endTime, sums);
+        scanned = true;
+    }
+    if (scanned) {
+        m_edgeScans.fetchAndAddRelaxed(1);
+    }
+    return true;
+}
+
+QJsonObject RevenueIndex::statistics() const
+{
+    QReadLocker locker(&m_lock);
+    QJsonObject stats;
+    stats["loaded"] = m_loaded;
+    stats["buckets"] = m_buckets.size();
+    if (!m_buckets.isEmpty()) {
+        stats["from"] = startOfHour(m_originHour).toString(Qt::ISODate);
+        stats["to"] = startOfHour(m_originHour + m_buckets.size()).toString(Qt::ISODate);
+    }
+    stats["latestEnterTime"] = m_latestEnter.toString(Qt::ISODate);
+    stats["memoryBytes"] = static_cast<qint64>((m_buckets.capacity() + m_tree.capacity()) * sizeof(Sums));
+    stats["queries"] = m_queries.loadAcquire();
+    stats["edgeScans"] = m_edgeScans.loadAcquire();
+    return stats;
+}
+
+void RevenueIndex::addLocked(qint64 hour, const Sums& delta)
+{
+    ensureCoversLocked(hour);
+    qint64 size = m_buckets.size();
+    qint64 index = hour - m_originHour;
+    m_buckets[static_cast<int>(index)].add(delta);
+    for (qint64 i = index + 1; i <= size; i += lowBit(i)) {
+        m_tree[static_cast<int>(i)].add(delta);
+    }
+}
+
+void RevenueIndex::ensureCoversLocked(qint64 hour)
+{
+    qint64 size = m_buckets.size();
+    if (size == 0) {
+        m_originHour = hour;
+        m_buckets.resize(MIN_GROWTH);
+    } else if (hour < m_originHour) {
+        // 早于起点的记录（补录历史数据）：整体后移并预留空间
+        qint64 shift = m_originHour - hour + MIN_GROWTH;
+        QVector<Sums> buckets(static_cast<int>(size + shift));
+        std::copy(m_buckets.constBegin(), m_buckets.constEnd(), buckets.begin() + shift);
+        m_buckets.swap(buckets);
+        m_originHour -= shift;
+    } else if (hour - m_originHour >= size) {
+        m_buckets.resize(static_cast<int>(qMax(size * 2, hour - m_originHour + MIN_GROWTH)));
+    } else {
+        return;
+    }
+    rebuildTreeLocked();
+}
+
+void RevenueIndex::rebuildTreeLocked()
+{
+    // 线性时间建树：每个节点先取自身桶值，再累加到父节点
+    int size = m_buckets.size();
+    m_tree.fill(Sums(), size + 1);
+    for (int i = 1; i <= size; ++i) {
+        m_tree[i].add(m_buckets[i - 1]);
+        qint64 parent = i + lowBit(i);
+        if (parent <= size) {
+            m_tree[static_cast<int>(parent)].add(m_tree[i]);
+        }
+    }
+}
+
+RevenueIndex::Sums RevenueIndex::prefixLocked(qint64 count) const
+{
+    Sums sums;
+    for (qint64 i = count; i > 0; i -= lowBit(i)) {
+        sums.add(m_tree[static_cast<int>(i)]);
+    }
+    return sums;
+}
+
+RevenueIndex::Sums RevenueIndex::sumHoursLocked(qint64 fromHour, qint64 toHour) const
+{
+    qint64 size = m_buckets.size();
+    qint64 from = qBound<qint64>(0, fromHour - m_originHour, size);
+    qint64 to = qBound<qint64>(0, toHour - m_originHour, size);
+    Sums sums;
+    if (from < to) {
+        sums = prefixLocked(to);
+        sums.add(prefixLocked(from), -1);
+    }
+    return sums;
+}
+
+void RevenueIndex::sumRecords(const QDateTime& startTime, const QDateTime& endTime, Sums& sums)
+{
+    std::unique_ptr<ParkingRecordCursor> cursor = ParkingRecordRepository::instance().openCursor(startTime, endTime);
+    if (!cursor->isValid()) {
+        return;
+    }
+    ParkingRecord record;
+    while (cursor->next(record)) {
+        sums.add(contribution(record));
+    }
+}
+
+#ifndef QT_NO_DEBUG
+bool RevenueIndex::verifyAgainstDatabase()
+{
+    QString connectionName = QString("revenue_index_verify_%1").arg((quintptr)QThread::currentThreadId());
+    Sums expected;
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(QDir::currentPath() + "/data/parking_server.db");
+        QSqlQuery query(db);
+        // 金额与索引一样逐条按分取整后求和，比较不受浮点累加顺序影响
+        ok = db.open()
+            && query.exec("SELECT COUNT(*), "
+                          "COALESCE(SUM(CASE WHEN is_paid THEN 1 ELSE 0 END), 0), "
+                          "COALESCE(SUM(CAST(ROUND(fee * 100) AS INTEGER)), 0), "
+                          "COALESCE(SUM(CASE WHEN is_paid THEN CAST(ROUND(fee * 100) AS INTEGER) ELSE 0 END), 0) "
+                          "FROM parking_records")
+            && query.next();
+        if (ok) {
+            expected.entries = query.value(0).toLongLong();
+            expected.paidCount = query.value(1).toLongLong();
+            expected.billedCents = query.value(2).toLongLong();
+            expected.paidCents = query.value(3).toLongLong();
+        } else {
+            Logger::error("Failed to verify revenue index: " + query.lastError().text());
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    if (!ok) {
+        return false;
+    }
+
+    Sums actual;
+    {
+        QReadLocker locker(&m_lock);
+        actual = prefixLocked(m_buckets.size());
+    }
+    if (actual.entries != expected.entries || actual.paidCount != expected.paidCount ||
+        actual.billedCents != expected.billedCents || actual.paidCents != expected.paidCents) {
+        Logger::warning(QString("Revenue index disagrees with parking_records "
+                                "(entries %1/%2, paid %3/%4, billed cents %5/%6, paid cents %7/%8), "
+                                "run --rebuild-rollups to repair")
+                       .arg(actual.entries).arg(expected.entries)
+                       .arg(actual.paidCount).arg(expected.paidCount)
+                       .arg(actual.billedCents).arg(expected.billedCents)
+                       .arg(actual.paidCents).arg(expected.paidCents));
+        return false;
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,80 @@
+#ifndef REVENUEINDEX_H
+#define REVENUEINDEX_H
+
+#include "../models/ParkingRecord.h"
+#include <QAtomicInteger>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QReadWriteLock>
+#include <QVector>
+
+// 按进场小时的前缀和索引（树状数组），任意时间范围的收入、进场数和已支付数在 O(log n) 内求得
+// 启动时由 rollup_hourly 构建，之后由 ParkingRecordRepository 在记录写入提交后更新，口径与汇总表相同
+// 金额以分为单位的整数累加，增减任意次都不会产生浮点漂移
+// 读取可在任意线程并发进行；写入要求调用方持有 ActiveSessionIndex 的写锁（在记录事务提交后按提交顺序进行）
+class RevenueIndex
+{
+public:
+    struct Sums {
+        qint64 entries = 0;
+        qint64 paidCount = 0;
+        qint64 billedCents = 0;    // 全部记录的费用合计（分）
+        qint64 paidCents = 0;      // 已支付记录的费用合计（分）
+
+        void add(const Sums& other, int sign = 1);
+        double billedRevenue() const { return billedCents / 100.0; }
+        double paidRevenue() const { return paidCents / 100.0; }
+    };
+
+    static RevenueIndex& instance();
+
+    // 从汇总表构建；汇总表未回填时不加载，调用方退回到汇总表查询
+    bool load();
+    bool isLoaded() const;
+
+    // 记录从 before 变为 after 后更新索引；新增时 before 为空，删除时 after 为空
+    void applyChange(const ParkingRecord* before, const ParkingRecord* after);
+
+    // 进场时间在 [startTime, endTime] 内的合计
+    // 整小时部分只读内存；起点不在整点时，起点所在小时的剩余部分按 enter_time 索引读取原始记录
+    // 终点不早于最近一次进场时终点所在小时整体计入，否则同样读取该小时内终点之前的记录
+    // 未加载时返回 false
+    bool sumRange(const QDateTime& startTime, const QDateTime& endTime, Sums& sums);
+
+    // 桶数、覆盖范围、查询次数
+    QJsonObject statistics() const;
+
+private:
+    RevenueIndex() = default;
+    RevenueIndex(const RevenueIndex&) = delete;
+    RevenueIndex& operator=(const RevenueIndex&) = delete;
+
+    // 桶按本地时间的小时编号（儒略日 * 24 + 小时），与汇总表的小时桶一一对应，不受时区偏移和夏令时影响
+    static qint64 hourOf(const QDateTime& time);
+    static QDateTime startOfHour(qint64 hour);
+    static Sums contribution(const ParkingRecord& record);
+
+    // 以下要求已持有 m_lock
+    void addLocked(qint64 hour, const Sums& delta);
+    void ensureCoversLocked(qint64 hour);
+    void rebuildTreeLocked();
+    Sums prefixLocked(qint64 count) const;          // 前 count 个桶的合计
+    Sums sumHoursLocked(qint64 fromHour, qint64 toHour) const;   // [fromHour, toHour)
+
+    static void sumRecords(const QDateTime& startTime, const QDateTime& endTime, Sums& sums);
+#ifndef QT_NO_DEBUG
+    bool verifyAgainstDatabase();
+#endif
+
+    mutable QReadWriteLock m_lock;
+    bool m_loaded = false;
+    qint64 m_originHour = 0;          // 第 0 个桶对应的小时编号
+    QVector<Sums> m_buckets;          // 每个桶的原始值，扩容时据此重建树
+    QVector<Sums> m_tree;             // 树状数组，下标从 1 开始
+    QDateTime m_latestEnter;          // 已计入记录的最晚进场时间
+
+    QAtomicInteger<qint64> m_queries;
+    QAtomicInteger<qint64> m_edgeScans;   // 需要读取原始记录的查询
+};
+
+#endif // REVENUEINDEX_H
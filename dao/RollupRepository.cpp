@@ -0,0 +1,478 @@
+#include "RollupRepository.h"
+#include "ParkingRecordRepository.h"
+#include "../utils/Logger.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+
+namespace {
+
+const char* const STATE_KEY = "rebuilt_at";
+
+QAtomicInt connectionSequence;
+
+struct Dimension {
+    QString spaceType;
+    QString zone;
+};
+
+// 一条记录或一个桶的指标
+struct Measures {
+    qint64 entries = 0;
+    qint64 exits = 0;
+    qint64 durationSeconds = 0;
+    qint64 paidCount = 0;
+    double billedRevenue = 0.0;
+    double paidRevenue = 0.0;
+
+    void add(const Measures& other, int sign)
+    {
+        entries += sign * other.entries;
+        exits += sign * other.exits;
+        durationSeconds += sign * other.durationSeconds;
+        paidCount += sign * other.paidCount;
+        billedRevenue += sign * other.billedRevenue;
+        paidRevenue += sign * other.paidRevenue;
+    }
+
+    bool isZero() const
+    {
+        return entries == 0 && exits == 0 && durationSeconds == 0 && paidCount == 0
+            && qFuzzyIsNull(billedRevenue) && qFuzzyIsNull(paidRevenue);
+    }
+};
+
+struct Key {
+    QString bucket;      // 小时桶 yyyy-MM-ddTHH:00:00，天桶取前 10 位
+    QString spaceType;
+    QString zone;
+    QString payMethod;
+
+    bool operator==(const Key& other) const
+    {
+        return bucket == other.bucket && spaceType == other.spaceType
+            && zone == other.zone && payMethod == other.payMethod;
+    }
+};
+
+uint qHash(const Key& key, uint seed = 0)
+{
+    return ::qHash(key.bucket, seed) ^ ::qHash(key.spaceType, seed + 1)
+         ^ ::qHash(key.zone, seed + 2) ^ ::qHash(key.payMethod, seed + 3);
+}
+
+QString hourBucket(const QDateTime& time)
+{
+    return time.toString("yyyy-MM-dd'T'HH:00:00");
+}
+
+QString dayBucket(const QDateTime& time)
+{
+    return time.toString("yyyy-MM-dd");
+}
+
+QDateTime floorHour(const QDateTime& time)
+{
+    return QDateTime(time.date(), QTime(time.time().hour(), 0));
+}
+
+// 位置形如 "A区-1号"，区域取 '-' 之前的部分
+QString zoneOf(const QString& location)
+{
+    int dash = location.indexOf('-');
+    return dash > 0 ? location.left(dash) : location;
+}
+
+Measures contribution(const ParkingRecord& record)
+{
+    Measures measures;
+    measures.entries = 1;
+    measures.billedRevenue = record.getFee();
+    if (record.getExitTime().isValid()) {
+        measures.exits = 1;
+        measures.durationSeconds = record.getEnterTime().secsTo(record.getExitTime());
+    }
+    if (record.getIsPaid()) {
+        measures.paidCount = 1;
+        measures.paidRevenue = record.getFee();
+    }
+    return measures;
+}
+
+QString methodOf(const ParkingRecord& record)
+{
+    return record.getIsPaid() ? record.getPayMethod() : QString();
+}
+
+void addRecord(RollupRepository::Totals& totals, const ParkingRecord& record)
+{
+    Measures measures = contribution(record);
+    totals.entries += measures.entries;
+    totals.exits += measures.exits;
+    totals.durationSeconds += measures.durationSeconds;
+    totals.paidCount += measures.paidCount;
+    totals.billedRevenue += measures.billedRevenue;
+    totals.paidRevenue += measures.paidRevenue;
+    if (record.getIsPaid() && !record.getPayMethod().isEmpty()) {
+        RollupRepository::Totals::Method& method = totals.byMethod[record.getPayMethod()];
+        method.count++;
+        method.amount += record.getFee();
+    }
+}
+
+// 在调用方的事务中读取车位当前的维度；不使用车位快照，快照可能尚未反映刚提交的车位修改
+Dimension lookupDimension(QSqlDatabase& db, int spaceId)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT type, location FROM parking_spaces WHERE id = ?");
+    query.addBindValue(spaceId);
+    if (query.exec() && query.next()) {
+        return {query.value(0).toString(), zoneOf(query.value(1).toString())};
+    }
+    return Dimension();
+}
+
+// 记录上保存的维度；升级前补齐时车位已删除的旧记录没有维度，退回按车位查询
+Dimension dimensionOf(QSqlDatabase& db, const ParkingRecord& record)
+{
+    if (!record.getSpaceType().isNull() || !record.getZone().isNull()) {
+        return {record.getSpaceType(), record.getZone()};
+    }
+    return lookupDimension(db, record.getSpaceId());
+}
+
+bool insertRow(QSqlDatabase& db, const char* table, const QString& bucket, const Key& key, const Measures& measures)
+{
+    QSqlQuery query(db);
+    query.prepare(QString("INSERT INTO %1 (bucket, space_type, zone, pay_method, entries, exits, duration_seconds, "
+                          "paid_count, billed_revenue, paid_revenue) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)").arg(table));
+    query.addBindValue(bucket);
+    query.addBindValue(key.spaceType);
+    query.addBindValue(key.zone);
+    query.addBindValue(key.payMethod);
+    query.addBindValue(measures.entries);
+    query.addBindValue(measures.exits);
+    query.addBindValue(measures.durationSeconds);
+    query.addBindValue(measures.paidCount);
+    query.addBindValue(measures.billedRevenue);
+    query.addBindValue(measures.paidRevenue);
+    if (!query.exec()) {
+        Logger::error(QString("Failed to insert %1 row: %2").arg(table, query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+bool addToRow(QSqlDatabase& db, const char* table, const QString& bucket, const Key& key, const Measures& delta)
+{
+    QSqlQuery query(db);
+    query.prepare(QString("UPDATE %1 SET entries = entries + ?, exits = exits + ?, duration_seconds = duration_seconds + ?, "
+                          "paid_count = paid_count + ?, billed_revenue = billed_revenue + ?, paid_revenue = paid_revenue + ? "
+                          "WHERE bucket = ? AND space_type = ? AND zone = ? AND pay_method = ?").arg(table));
+    query.addBindValue(delta.entries);
+    query.addBindValue(delta.exits);
+    query.addBindValue(delta.durationSeconds);
+    query.addBindValue(delta.paidCount);
+    query.addBindValue(delta.billedRevenue);
+    query.addBindValue(delta.paidRevenue);
+    query.addBindValue(bucket);
+    query.addBindValue(key.spaceType);
+    query.addBindValue(key.zone);
+    query.addBindValue(key.payMethod);
+    if (!query.exec()) {
+        Logger::error(QString("Failed to update %1 row: %2").arg(table, query.lastError().text()));
+        return false;
+    }
+    if (query.numRowsAffected() > 0) {
+        return true;
+    }
+    return insertRow(db, table, bucket, key, delta);
+}
+
+// 汇总读取使用独立连接，名称用序号区分同一线程上的多次打开
+QString openConnection()
+{
+    QString name = QString("rollup_repo_%1_%2")
+        .arg((quintptr)QThread::currentThreadId())
+        .arg(connectionSequence.fetchAndAddRelaxed(1));
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(QDir::currentPath() + "/data/parking_server.db");
+    if (!db.open()) {
+        Logger::error("Failed to open database for rollups: " + db.lastError().text());
+    }
+    return name;
+}
+
+}
+
+RollupRepository& RollupRepository::instance()
+{
+    static RollupRepository instance;
+    return instance;
+}
+
+void RollupRepository::assignDimension(QSqlDatabase& db, ParkingRecord& record)
+{
+    Dimension dimension = lookupDimension(db, record.getSpaceId());
+    record.setSpaceType(dimension.spaceType);
+    record.setZone(dimension.zone);
+}
+
+bool RollupRepository::applyChange(QSqlDatabase& db, const ParkingRecord* before, const ParkingRecord* after)
+{
+    // 更新不改写记录上的维度，前后两次贡献都按库中原有的维度归桶，车位类型或位置修改后不会错位
+    Dimension dimension = before ? dimensionOf(db, *before) : (after ? dimensionOf(db, *after) : Dimension());
+
+    QHash<Key, Measures> deltas;
+    auto accumulate = [&](const ParkingRecord& record, int sign) {
+        if (!record.getEnterTime().isValid()) {
+            return;
+        }
+        Key key{hourBucket(record.getEnterTime()), dimension.spaceType, dimension.zone, methodOf(record)};
+        deltas[key].add(contribution(record), sign);
+    };
+    if (before) {
+        accumulate(*before, -1);
+    }
+    if (after) {
+        accumulate(*after, 1);
+    }
+
+    for (auto it = deltas.constBegin(); it != deltas.constEnd(); ++it) {
+        if (it.value().isZero()) {
+            continue;
+        }
+        if (!addToRow(db, "rollup_hourly", it.key().bucket, it.key(), it.value()) ||
+            !addToRow(db, "rollup_daily", it.key().bucket.left(10), it.key(), it.value())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RollupRepository::Totals RollupRepository::sumRange(const QDateTime& startTime, const QDateTime& endTime)
+{
+    Totals totals;
+    if (!startTime.isValid() || !endTime.isValid() || startTime > endTime) {
+        return totals;
+    }
+    if (!isReady()) {
+        sumRecords(startTime, endTime, totals);
+        return totals;
+    }
+
+    // 完整的小时 [firstHour, lastHour)；endTime 为闭区间，其所在小时按原始记录读取
+    QDateTime firstHour = floorHour(startTime);
+    if (firstHour < startTime) {
+        firstHour = firstHour.addSecs(3600);
+    }
+    QDateTime lastHour = floorHour(endTime);
+    if (firstHour >= lastHour) {
+        sumRecords(startTime, endTime, totals);
+        return totals;
+    }
+
+    if (startTime < firstHour) {
+        sumRecords(startTime, firstHour.addMSecs(-1), totals);
+    }
+    sumRecords(lastHour, endTime, totals);
+
+    // 中间的完整天读天表，两侧不足一天的部分读小时表
+    QDateTime firstDay(firstHour.date(), QTime(0, 0));
+    if (firstDay < firstHour) {
+        firstDay = firstDay.addDays(1);
+    }
+    QDateTime lastDay(lastHour.date(), QTime(0, 0));
+
+    QString connectionName = openConnection();
+    {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        if (db.isOpen()) {
+            if (firstDay < lastDay) {
+                sumRows(db, "rollup_hourly", hourBucket(firstHour), hourBucket(firstDay), totals);
+                sumRows(db, "rollup_daily", dayBucket(firstDay), dayBucket(lastDay), totals);
+                sumRows(db, "rollup_hourly", hourBucket(lastDay), hourBucket(lastHour), totals);
+            } else {
+                sumRows(db, "rollup_hourly", hourBucket(firstHour), hourBucket(lastHour), totals);
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return totals;
+}
+
+void RollupRepository::sumRows(QSqlDatabase& db, const char* table, const QString& fromBucket, const QString& toBucket,
+                               Totals& totals)
+{
+    if (fromBucket >= toBucket) {
+        return;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT pay_method, SUM(entries), SUM(exits), SUM(duration_seconds), SUM(paid_count), "
+                          "SUM(billed_revenue), SUM(paid_revenue) FROM %1 "
+                          "WHERE bucket >= ? AND bucket < ? GROUP BY pay_method").arg(table));
+    query.addBindValue(fromBucket);
+    query.addBindValue(toBucket);
+    if (!query.exec()) {
+        Logger::error(QString("Failed to read %1: %2").arg(table, query.lastError().text()));
+        return;
+    }
+
+    while (query.next()) {
+        QString method = query.value(0).toString();
+        qint64 paidCount = query.value(4).toLongLong();
+        double paidRevenue = query.value(6).toDouble();
+
+        totals.entries += query.value(1).toLongLong();
+        totals.exits += query.value(2).toLongLong();
+        totals.durationSeconds += query.value(3).toLongLong();
+        totals.paidCount += paidCount;
+        totals.billedRevenue += query.value(5).toDouble();
+        totals.paidRevenue += paidRevenue;
+        if (!method.isEmpty() && paidCount > 0) {
+            Totals::Method& entry = totals.byMethod[method];
+            entry.count += paidCount;
+            entry.amount += paidRevenue;
+        }
+    }
+}
+
+void RollupRepository::sumRecords(const QDateTime& startTime, const QDateTime& endTime, Totals& totals)
+{
+    std::unique_ptr<ParkingRecordCursor> cursor = ParkingRecordRepository::instance().openCursor(startTime, endTime);
+    if (!cursor->isValid()) {
+        return;
+    }
+    ParkingRecord record;
+    while (cursor->next(record)) {
+        addRecord(totals, record);
+    }
+}
+
+bool RollupRepository::rebuild()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // 记录写入由 BEGIN IMMEDIATE 排斥（在忙等超时内排队），不持有活跃会话索引的锁，不阻塞索引查询
+    QString connectionName = openConnection();
+    bool ok = false;
+    qint64 records = 0;
+    int hourlyRows = 0;
+    int dailyRows = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        QSqlQuery query(db);
+        if (db.isOpen() && query.exec("BEGIN IMMEDIATE")) {
+            ok = query.exec("DELETE FROM rollup_hourly") && query.exec("DELETE FROM rollup_daily");
+
+            // 车位维度一次读入，用于没有保存维度的旧记录
+            QHash<int, Dimension> dimensions;
+            if (ok && query.exec("SELECT id, type, location FROM parking_spaces")) {
+                while (query.next()) {
+                    dimensions.insert(query.value(0).toInt(), {query.value(1).toString(), zoneOf(query.value(2).toString())});
+                }
+            }
+
+            QHash<Key, Measures> hourly;
+            QHash<Key, Measures> daily;
+            if (ok) {
+                std::unique_ptr<ParkingRecordCursor> cursor = ParkingRecordRepository::instance().openCursor();
+                ok = cursor->isValid();
+                ParkingRecord record;
+                while (ok && cursor->next(record)) {
+                    if (!record.getEnterTime().isValid()) {
+                        continue;
+                    }
+                    Dimension dimension = (!record.getSpaceType().isNull() || !record.getZone().isNull())
+                        ? Dimension{record.getSpaceType(), record.getZone()}
+                        : dimensions.value(record.getSpaceId());
+                    Key key{hourBucket(record.getEnterTime()), dimension.spaceType, dimension.zone, methodOf(record)};
+                    Measures measures = contribution(record);
+                    hourly[key].add(measures, 1);
+                    key.bucket = key.bucket.left(10);
+                    daily[key].add(measures, 1);
+                    records++;
+                }
+            }
+
+            for (auto it = hourly.constBegin(); ok && it != hourly.constEnd(); ++it) {
+                ok = insertRow(db, "rollup_hourly", it.key().bucket, it.key(), it.value());
+            }
+            for (auto it = daily.constBegin(); ok && it != daily.constEnd(); ++it) {
+                ok = insertRow(db, "rollup_daily", it.key().bucket, it.key(), it.value());
+            }
+            hourlyRows = hourly.size();
+            dailyRows = daily.size();
+
+            if (ok) {
+                query.prepare("INSERT OR REPLACE INTO rollup_state (key, value) VALUES (?, ?)");
+                query.addBindValue(STATE_KEY);
+                query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
+                ok = query.exec();
+            }
+            if (ok) {
+                ok = query.exec("COMMIT");
+            }
+            if (!ok) {
+                Logger::error(QString("Failed to rebuild rollups: %1").arg(query.lastError().text()));
+                query.exec("ROLLBACK");
+            }
+        } else {
+            Logger::error(QString("Failed to begin rollup rebuild: %1").arg(query.lastError().text()));
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (ok) {
+        m_ready.storeRelease(1);
+        Logger::info(QString("Rollups rebuilt from %1 records: %2 hourly rows, %3 daily rows in %4 ms")
+                    .arg(records).arg(hourlyRows).arg(dailyRows).arg(timer.elapsed()));
+    }
+    return ok;
+}
+
+bool RollupRepository::isReady()
+{
+    int ready = m_ready.loadAcquire();
+    if (ready >= 0) {
+        return ready == 1;
+    }
+
+    QString connectionName = openConnection();
+    {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        QSqlQuery query(db);
+        query.prepare("SELECT value FROM rollup_state WHERE key = ?");
+        query.addBindValue(STATE_KEY);
+        ready = db.isOpen() && query.exec() && query.next() ? 1 : 0;
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    m_ready.storeRelease(ready);
+    return ready == 1;
+}
+
+bool RollupRepository::markReadyIfEmpty(QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT value FROM rollup_state WHERE key = ?");
+    query.addBindValue(STATE_KEY);
+    if (query.exec() && query.next()) {
+        return true;
+    }
+
+    // 没有历史记录时无需回填，之后的写入都会增量计入
+    if (!query.exec("SELECT COUNT(*) FROM parking_records") || !query.next() || query.value(0).toLongLong() > 0) {
+        return false;
+    }
+    query.prepare("INSERT OR REPLACE INTO rollup_state (key, value) VALUES (?, ?)");
+    query.addBindValue(STATE_KEY);
+    query.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
+    return query.exec();
+}
@@ -0,0 +1,70 @@
+#ifndef ROLLUPREPOSITORY_H
+#define ROLLUPREPOSITORY_H
+
+#include "../models/ParkingRecord.h"
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QMap>
+#include <QSqlDatabase>
+#include <QString>
+
+// 停车记录按小时/按天的汇总（rollup_hourly / rollup_daily）
+// 维度：时间桶、车位类型、区域（车位位置中 '-' 之前的部分）、支付方式（未支付为空串）
+// 车位类型和区域取进场时的值并保存在记录上，车位之后的修改不影响已有记录
+// 记录按进场时间归桶，与各报表按 enter_time 过滤的口径一致；一条记录的全部指标落在同一个桶中
+// 由 ParkingRecordRepository 在写记录的同一事务内增量维护，rebuild 用于首次回填和修复
+class RollupRepository
+{
+public:
+    // 一个时间范围内的汇总
+    struct Totals {
+        qint64 entries = 0;            // 进场记录数
+        qint64 exits = 0;              // 其中已出场的记录数
+        qint64 durationSeconds = 0;    // 已出场记录的停车总时长
+        qint64 paidCount = 0;          // 已支付记录数
+        double billedRevenue = 0.0;    // 全部记录的费用合计
+        double paidRevenue = 0.0;      // 已支付记录的费用合计
+
+        struct Method {
+            qint64 count = 0;
+            double amount = 0.0;
+        };
+        QMap<QString, Method> byMethod;   // 已支付记录按支付方式
+
+        qint64 unpaidCount() const { return entries - paidCount; }
+        double unpaidRevenue() const { return billedRevenue - paidRevenue; }
+    };
+
+    static RollupRepository& instance();
+
+    // 在调用方的事务中按车位当前的类型和位置设置新记录的维度，之后随记录保存
+    static void assignDimension(QSqlDatabase& db, ParkingRecord& record);
+
+    // 在调用方的事务中把一条记录从 before 变为 after 的差额计入汇总；新增时 before 为空，删除时 after 为空
+    // 按记录上保存的维度归桶（before 存在时以 before 为准）
+    bool applyChange(QSqlDatabase& db, const ParkingRecord* before, const ParkingRecord* after);
+
+    // 进场时间在 [startTime, endTime] 内的记录汇总
+    // 整天和整小时读取汇总行，范围两端不足一小时的部分按 enter_time 索引读取原始记录
+    // 汇总尚未回填时整个范围读取原始记录
+    Totals sumRange(const QDateTime& startTime, const QDateTime& endTime);
+
+    // 清空并按全部停车记录重建汇总表（单个事务）
+    bool rebuild();
+
+    // 汇总是否已回填；空库在建表时直接标记为已回填
+    bool isReady();
+    static bool markReadyIfEmpty(QSqlDatabase& db);
+
+private:
+    RollupRepository() = default;
+    RollupRepository(const RollupRepository&) = delete;
+    RollupRepository& operator=(const RollupRepository&) = delete;
+
+    void sumRows(QSqlDatabase& db, const char* table, const QString& fromBucket, const QString& toBucket, Totals& totals);
+    void sumRecords(const QDateTime& startTime, const QDateTime& endTime, Totals& totals);
+
+    QAtomicInt m_ready{-1};   // -1 未知，0 未回填，1 已回填
+};
+
+#endif // ROLLUPREPOSITORY_H
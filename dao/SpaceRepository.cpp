@@ -8,6 +8,9 @@
 #include <QThread>
 #include <QThreadStorage>
 #include <QDir>
+#include "SpaceSnapshot.h"
+#include "../utils/Logger.h"
+#include "../utils/DataVersion.h"
 
 SpaceRepository& SpaceRepository::instance()
 {
@@ -26,6 +29,7 @@ bool SpaceRepository::initializeTable()
             occupied_time TEXT,
             type TEXT DEFAULT 'normal',
             hourly_rate REAL DEFAULT 5.0,
+            version INTEGER DEFAULT 0,
             create_time TEXT DEFAULT CURRENT_TIMESTAMP,
             update_time TEXT DEFAULT CURRENT_TIMESTAMP
         )
@@ -34,7 +38,7 @@ bool SpaceRepository::initializeTable()
     return instance().executeQuery(createTableQuery);
 }
 
-bool SpaceRepository::insert(const ParkingSpace& space)
+bool SpaceRepository::insert(ParkingSpace& space)
 {
     QString insertQuery = R"(
         INSERT INTO parking_spaces (location, status, current_plate, occupied_time, type, hourly_rate)
@@ -49,7 +53,14 @@ bool SpaceRepository::insert(const ParkingSpace& space)
     params["type"] = space.getType();
     params["hourly_rate"] = space.getHourlyRate();
     
-    return instance().executeQuery(insertQuery, params);
+    QVariant insertId;
+    if (instance().executeUpdate(insertQuery, params, &insertId) < 0) {
+        return false;
+    }
+    space.setId(insertId.toInt());
+    space.setVersion(0);
+    refreshSnapshot(space.getId());
+    return true;
 }
 
 bool SpaceRepository::update(const ParkingSpace& space)
@@ -57,7 +68,8 @@ bool SpaceRepository::update(const ParkingSpace& space)
     QString updateQuery = R"(
         UPDATE parking_spaces 
         SET location = :location, status = :status, current_plate = :current_plate, 
-            occupied_time = :occupied_time, type = :type, hourly_rate = :hourly_rate
+            occupied_time = :occupied_time, type = :type, hourly_rate = :hourly_rate,
+            version = version + 1
         WHERE id = :id
     )";
     
@@ -70,7 +82,38 @@ bool SpaceRepository::update(const ParkingSpace& space)
     params["type"] = space.getType();
     params["hourly_rate"] = space.getHourlyRate();
     
-    return instance().executeQuery(updateQuery, params);
+    if (!instance().executeQuery(updateQuery, params)) {
+        return false;
+    }
+    refreshSnapshot(space.getId());
+    return true;
+}
+
+WriteResult SpaceRepository::compareAndUpdate(ParkingSpace& space)
+{
+    QString updateQuery = R"(
+        UPDATE parking_spaces 
+        SET location = :location, status = :status, current_plate = :current_plate, 
+            occupied_time = :occupied_time, type = :type, hourly_rate = :hourly_rate,
+            version = :new_version
+        WHERE id = :id AND version = :version
+    )";
+    
+    QVariantMap params = spaceToMap(space);
+    params["version"] = space.getVersion();
+    params["new_version"] = space.getVersion() + 1;
+    
+    int affected = instance().executeUpdate(updateQuery, params);
+    if (affected < 0) {
+        return WRITE_ERROR;
+    }
+    if (affected == 0) {
+        return WRITE_CONFLICT;
+    }
+    
+    space.setVersion(space.getVersion() + 1);
+    refreshSnapshot(space.getId());
+    return WRITE_OK;
 }
 
 bool SpaceRepository::remove(int id)
@@ -79,7 +122,12 @@ bool SpaceRepository::remove(int id)
     QVariantMap params;
     params["id"] = id;
     
-    return instance().executeQuery(deleteQuery, params);
+    if (!instance().executeQuery(deleteQuery, params)) {
+        return false;
+    }
+    DataVersion::instance().bump();
+    SpaceSnapshotStore::instance().publishRemoval(id);
+    return true;
 }
 
 ParkingSpace SpaceRepository::findById(int id)
@@ -98,9 +146,17 @@ ParkingSpace SpaceRepository::findById(int id)
 }
 
 QList<ParkingSpace> SpaceRepository::findAll()
+{
+    if (auto snapshot = SpaceSnapshotStore::instance().current()) {
+        return snapshot->findAll();
+    }
+    return queryAll();
+}
+
+QList<ParkingSpace> SpaceRepository::queryAll(bool* ok)
 {
     QString selectQuery = "SELECT * FROM parking_spaces ORDER BY id ASC";
-    QList<QVariantMap> results = instance().executeQueryWithResults(selectQuery);
+    QList<QVariantMap> results = instance().executeQueryWithResults(selectQuery, QVariantMap(), ok);
     
     QList<ParkingSpace> spaces;
     for (const auto& row : results) {
@@ -112,6 +168,10 @@ QList<ParkingSpace> SpaceRepository::findAll()
 
 QList<ParkingSpace> SpaceRepository::findByStatus(ParkingSpace::Status status)
 {
+    if (auto snapshot = SpaceSnapshotStore::instance().current()) {
+        return snapshot->findByStatus(status);
+    }
+    
     QString selectQuery = "SELECT * FROM parking_spaces WHERE status = :status ORDER BY id ASC";
     QVariantMap params;
     params["status"] = ParkingSpace::statusToString(status);
@@ -138,19 +198,24 @@ QList<ParkingSpace> SpaceRepository::findOccupiedSpaces()
 
 bool SpaceRepository::updateStatus(int id, ParkingSpace::Status status)
 {
-    QString updateQuery = "UPDATE parking_spaces SET status = :status WHERE id = :id";
+    QString updateQuery = "UPDATE parking_spaces SET status = :status, version = version + 1 WHERE id = :id";
     QVariantMap params;
     params["id"] = id;
     params["status"] = ParkingSpace::statusToString(status);
     
-    return instance().executeQuery(updateQuery, params);
+    if (!instance().executeQuery(updateQuery, params)) {
+        return false;
+    }
+    refreshSnapshot(id);
+    return true;
 }
 
 bool SpaceRepository::occupySpace(int id, const QString& plate)
 {
     QString updateQuery = R"(
         UPDATE parking_spaces 
-        SET status = 'occupied', current_plate = :plate, occupied_time = strftime('%Y-%m-%d %H:%M:%S', 'now', 'localtime')
+        SET status = 'occupied', current_plate = :plate, occupied_time = strftime('%Y-%m-%d %H:%M:%S', 'now', 'localtime'),
+            version = version + 1
         WHERE id = :id AND status = 'available'
     )";
     
@@ -158,21 +223,32 @@ bool SpaceRepository::occupySpace(int id, const QString& plate)
     params["id"] = id;
     params["plate"] = plate;
     
-    return instance().executeQuery(updateQuery, params);
+    // 车位已不是空闲状态时不更新任何行，视为占用失败
+    if (instance().executeUpdate(updateQuery, params) <= 0) {
+        return false;
+    }
+    refreshSnapshot(id);
+    return true;
 }
 
 bool SpaceRepository::releaseSpace(int id)
 {
     QString updateQuery = R"(
         UPDATE parking_spaces 
-        SET status = 'available', current_plate = NULL, occupied_time = NULL
+        SET status = 'available', current_plate = NULL, occupied_time = NULL,
+            version = version + 1
         WHERE id = :id AND status = 'occupied'
     )";
     
     QVariantMap params;
     params["id"] = id;
     
-    return instance().executeQuery(updateQuery, params);
+    // 车位不是占用状态（或不存在）时不更新任何行，视为释放失败，也不刷新快照
+    if (instance().executeUpdate(updateQuery, params) != 1) {
+        return false;
+    }
+    refreshSnapshot(id);
+    return true;
 }
 
 bool SpaceRepository::exists(int id)
@@ -207,6 +283,10 @@ bool SpaceRepository::existsByLocation(const QString& location)
 
 int SpaceRepository::count()
 {
+    if (auto snapshot = SpaceSnapshotStore::instance().current()) {
+        return snapshot->count();
+    }
+    
     QString countQuery = "SELECT COUNT(*) as count FROM parking_spaces";
     QList<QVariantMap> results = instance().executeQueryWithResults(countQuery);
     
@@ -219,6 +299,10 @@ int SpaceRepository::count()
 
 int SpaceRepository::countByStatus(ParkingSpace::Status status)
 {
+    if (auto snapshot = SpaceSnapshotStore::instance().current()) {
+        return snapshot->countByStatus(status);
+    }
+    
     QString countQuery = "SELECT COUNT(*) as count FROM parking_spaces WHERE status = :status";
     QVariantMap params;
     params["status"] = ParkingSpace::statusToString(status);
@@ -242,6 +326,52 @@ int SpaceRepository::countOccupied()
     return countByStatus(ParkingSpace::OCCUPIED);
 }
 
+bool SpaceRepository::loadSnapshot()
+{
+    bool ok = false;
+    QList<ParkingSpace> spaces = queryAll(&ok);
+    if (!ok) {
+        // 空结果不能当作快照发布，否则所有列表、计数和空闲判断都会错到重启为止
+        m_snapshotPending.storeRelease(1);
+        Logger::error("Failed to load space snapshot, space queries will use the database");
+        return false;
+    }
+    m_snapshotPending.storeRelease(0);
+    SpaceSnapshotStore::instance().rebuild(spaces);
+    Logger::info(QString("Space snapshot loaded: %1 spaces").arg(spaces.size()));
+    return true;
+}
+
+void SpaceRepository::refreshSnapshot(int id)
+{
+    // 所有车位写入成功后都经过这里，同时推进全局数据版本
+    DataVersion::instance().bump();
+    
+    if (!SpaceSnapshotStore::instance().isLoaded()) {
+        if (m_snapshotPending.loadAcquire()) {
+            loadSnapshot();
+        }
+        return;
+    }
+    
+    QVariantMap params;
+    params["id"] = id;
+    bool ok = false;
+    QList<QVariantMap> results = executeQueryWithResults("SELECT * FROM parking_spaces WHERE id = :id", params, &ok);
+    if (!ok) {
+        // 无法确认该车位的最新状态，丢弃快照而不是把它当作已删除
+        Logger::warning(QString("Failed to refresh space %1 in snapshot, discarding snapshot").arg(id));
+        SpaceSnapshotStore::instance().invalidate();
+        m_snapshotPending.storeRelease(1);
+        return;
+    }
+    if (results.isEmpty()) {
+        SpaceSnapshotStore::instance().publishRemoval(id);
+    } else {
+        SpaceSnapshotStore::instance().publish(mapToSpace(results.first()));
+    }
+}
+
 ParkingSpace SpaceRepository::mapToSpace(const QVariantMap& row)
 {
     ParkingSpace space;
@@ -252,6 +382,7 @@ ParkingSpace SpaceRepository::mapToSpace(const QVariantMap& row)
     space.setOccupiedTime(row["occupied_time"].toDateTime());
     space.setType(row["type"].toString());
     space.setHourlyRate(row["hourly_rate"].toDouble());
+    space.setVersion(row["version"].toInt());
     return space;
 }
 
@@ -296,9 +427,42 @@ bool SpaceRepository::executeQuery(const QString& queryStr, const QVariantMap& p
     return success;
 }
 
-QList<QVariantMap> SpaceRepository::executeQueryWithResults(const QString& queryStr, const QVariantMap& params)
+int SpaceRepository::executeUpdate(const QString& queryStr, const QVariantMap& params, QVariant* lastInsertId)
+{
+    QSqlDatabase db = getDatabase();
+    if (!db.isOpen()) {
+        qDebug() << "Database connection is not open";
+        return -1;
+    }
+    
+    int affected = -1;
+    {
+        QSqlQuery query(db);
+        query.prepare(queryStr);
+        
+        for (auto it = params.begin(); it != params.end(); ++it) {
+            query.bindValue(":" + it.key(), it.value());
+        }
+        
+        if (!query.exec()) {
+            qDebug() << "Query failed:" << query.lastError().text() << "Query:" << queryStr;
+        } else {
+            affected = query.numRowsAffected();
+            if (lastInsertId) {
+                *lastInsertId = query.lastInsertId();
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(db.connectionName());
+    return affected;
+}
+
+QList<QVariantMap> SpaceRepository::executeQueryWithResults(const QString& queryStr, const QVariantMap& params, bool* ok)
 {
     QList<QVariantMap> results;
+    if (ok) {
+        *ok = false;
+    }
     QSqlDatabase db = getDatabase();
     if (!db.isOpen()) {
         qDebug() << "Database connection is not open";
@@ -327,6 +491,9 @@ QList<QVariantMap> SpaceRepository::executeQueryWithResults(const QString& query
             }
             results.append(row);
         }
+        if (ok) {
+            *ok = true;
+        }
     }
     QSqlDatabase::removeDatabase(db.connectionName());
     return results;
@@ -335,7 +502,10 @@ QList<QVariantMap> SpaceRepository::executeQueryWithResults(const QString& query
 QSqlDatabase SpaceRepository::getDatabase()
 {
     QString dbPath = QDir::currentPath() + "/data/parking_server.db";
-    QString connectionName = QString("space_repo_%1").arg(QDateTime::currentMSecsSinceEpoch());
+    // 连接名包含线程ID，调度线程与事件循环线程的连接互不冲突
+    QString connectionName = QString("space_repo_%1_%2")
+        .arg((quintptr)QThread::currentThreadId())
+        .arg(QDateTime::currentMSecsSinceEpoch());
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
     db.setDatabaseName(dbPath);
     if (!db.open()) {
@@ -5,9 +5,11 @@
 #include <QString>
 #include <QList>
 #include <QVariantMap>
+#include <QAtomicInt>
 #include <QThreadStorage>
 #include <QSqlDatabase>
 #include "../models/ParkingSpace.h"
+#include "WriteResult.h"
 
 class SpaceRepository
 {
@@ -18,10 +20,13 @@ public:
     bool initializeTable();
     
     // CRUD操作
-    bool insert(const ParkingSpace& space);
+    bool insert(ParkingSpace& space);    // 成功后写回新ID和版本
     bool update(const ParkingSpace& space);
     bool remove(int id);
     
+    // 仅当数据库中的版本与 space 的版本一致时写入；成功后 space 的版本递增
+    WriteResult compareAndUpdate(ParkingSpace& space);
+    
     // 查询操作
     ParkingSpace findById(int id);
     QList<ParkingSpace> findAll();
@@ -31,8 +36,8 @@ public:
     
     // 更新状态
     bool updateStatus(int id, ParkingSpace::Status status);
-    bool occupySpace(int id, const QString& plate);
-    bool releaseSpace(int id);
+    bool occupySpace(int id, const QString& plate);    // 仅空闲车位可占用
+    bool releaseSpace(int id);                           // 仅占用中的车位可释放，否则返回 false
     
     // 存在性检查
     bool exists(int id);
@@ -44,18 +49,32 @@ public:
     int countAvailable();
     int countOccupied();
     
+    // 启动时从数据库加载车位快照，之后列表与计数查询直接读快照
+    // 查询失败时不发布快照并返回 false，查询继续走数据库，下一次车位写入时重试加载
+    bool loadSnapshot();
+    
 private:
     SpaceRepository() = default;
     SpaceRepository(const SpaceRepository&) = delete;
     SpaceRepository& operator=(const SpaceRepository&) = delete;
     
     ParkingSpace mapToSpace(const QVariantMap& row);
+    QList<ParkingSpace> queryAll(bool* ok = nullptr);
+    
+    // 写入后从数据库重新读取该车位并发布到快照；读取失败时丢弃快照
+    void refreshSnapshot(int id);
     
     // 辅助方法
     bool executeQuery(const QString& queryStr, const QVariantMap& params = QVariantMap());
-    QList<QVariantMap> executeQueryWithResults(const QString& queryStr, const QVariantMap& params = QVariantMap());
+    // 返回受影响行数，失败返回-1
+    int executeUpdate(const QString& queryStr, const QVariantMap& params, QVariant* lastInsertId = nullptr);
+    // ok 非空时写入查询是否成功，用于区分“无结果”和“查询失败”
+    QList<QVariantMap> executeQueryWithResults(const QString& queryStr, const QVariantMap& params = QVariantMap(),
+                                               bool* ok = nullptr);
     QSqlDatabase getDatabase();
     QVariantMap spaceToMap(const ParkingSpace& space);
+    
+    QAtomicInt m_snapshotPending;   // 启动加载或刷新失败，等待重新加载
 };
 
 #endif // SPACEREPOSITORY_H
\ No newline at end of file
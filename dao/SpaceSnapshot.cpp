@@ -0,0 +1,219 @@
+#include "SpaceSnapshot.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+QList<ParkingSpace> SpaceSnapshot::findAll() const
+{
+    QList<ParkingSpace> result;
+    result.reserve(m_count);
+    for (const auto& chunk : m_chunks) {
+        for (const ParkingSpace& space : *chunk) {
+            result.append(space);
+        }
+    }
+    return result;
+}
+
+QList<ParkingSpace> SpaceSnapshot::findByStatus(ParkingSpace::Status status) const
+{
+    QList<ParkingSpace> result;
+    result.reserve(countByStatus(status));
+    for (const auto& chunk : m_chunks) {
+        for (const ParkingSpace& space : *chunk) {
+            if (space.getStatus() == status) {
+                result.append(space);
+            }
+        }
+    }
+    return result;
+}
+
+ParkingSpace SpaceSnapshot::findById(int id) const
+{
+    int pos = 0;
+    bool found = false;
+    int chunk = locate(id, pos, found);
+    return found ? m_chunks.at(chunk)->at(pos) : ParkingSpace();
+}
+
+int SpaceSnapshot::countByStatus(ParkingSpace::Status status) const
+{
+    int slot = static_cast<int>(status);
+    return slot >= 0 && slot < STATUS_COUNT ? m_statusCounts[slot] : 0;
+}
+
+int SpaceSnapshot::locate(int id, int& pos, bool& found) const
+{
+    found = false;
+    pos = 0;
+    if (m_chunks.isEmpty()) {
+        return -1;
+    }
+
+    // 第一个末尾 id 不小于 id 的块；都小于时落在最后一块的末尾
+    auto chunkIt = std::lower_bound(m_chunks.constBegin(), m_chunks.constEnd(), id,
+                                    [](const std::shared_ptr<const Chunk>& chunk, int key) {
+                                        return chunk->last().getId() < key;
+                                    });
+    if (chunkIt == m_chunks.constEnd()) {
+        --chunkIt;
+    }
+    const Chunk& chunk = **chunkIt;
+    auto it = std::lower_bound(chunk.constBegin(), chunk.constEnd(), id,
+                               [](const ParkingSpace& space, int key) { return space.getId() < key; });
+    pos = static_cast<int>(it - chunk.constBegin());
+    found = it != chunk.constEnd() && it->getId() == id;
+    return static_cast<int>(chunkIt - m_chunks.constBegin());
+}
+
+void SpaceSnapshot::assign(const QVector<ParkingSpace>& sorted)
+{
+    m_chunks.clear();
+    for (int i = 0; i < sorted.size(); i += CHUNK_SIZE) {
+        m_chunks.append(std::make_shared<const Chunk>(sorted.mid(i, CHUNK_SIZE)));
+    }
+    m_count = sorted.size();
+    recount();
+}
+
+void SpaceSnapshot::recount()
+{
+    std::fill(std::begin(m_statusCounts), std::end(m_statusCounts), 0);
+    for (const auto& chunk : m_chunks) {
+        for (const ParkingSpace& space : *chunk) {
+            adjustCount(space.getStatus(), 1);
+        }
+    }
+}
+
+void SpaceSnapshot::adjustCount(ParkingSpace::Status status, int delta)
+{
+    int slot = static_cast<int>(status);
+    if (slot >= 0 && slot < STATUS_COUNT) {
+        m_statusCounts[slot] += delta;
+    }
+}
+
+SpaceSnapshotStore& SpaceSnapshotStore::instance()
+{
+    static SpaceSnapshotStore instance;
+    return instance;
+}
+
+std::shared_ptr<const SpaceSnapshot> SpaceSnapshotStore::current() const
+{
+    return std::atomic_load(&m_current);
+}
+
+bool SpaceSnapshotStore::isLoaded() const
+{
+    return current() != nullptr;
+}
+
+void SpaceSnapshotStore::rebuild(const QList<ParkingSpace>& spaces)
+{
+    QMutexLocker locker(&m_writeMutex);
+
+    // 全量读取可能早于并发的删除，已删除的车位不再加回
+    QVector<ParkingSpace> sorted;
+    sorted.reserve(spaces.size());
+    for (const ParkingSpace& space : spaces) {
+        if (!m_removed.contains(space.getId())) {
+            sorted.append(space);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const ParkingSpace& a, const ParkingSpace& b) { return a.getId() < b.getId(); });
+
+    auto snapshot = std::make_shared<SpaceSnapshot>();
+    snapshot->assign(sorted);
+
+    std::shared_ptr<const SpaceSnapshot> previous = std::atomic_load(&m_current);
+    snapshot->m_version = previous ? previous->m_version + 1 : 1;
+    std::atomic_store(&m_current, std::shared_ptr<const SpaceSnapshot>(snapshot));
+}
+
+void SpaceSnapshotStore::publish(const ParkingSpace& space)
+{
+    QMutexLocker locker(&m_writeMutex);
+
+    std::shared_ptr<const SpaceSnapshot> previous = std::atomic_load(&m_current);
+    if (!previous || space.getId() <= 0 || m_removed.contains(space.getId())) {
+        return;
+    }
+
+    int pos = 0;
+    bool found = false;
+    int index = previous->locate(space.getId(), pos, found);
+    if (found && previous->m_chunks.at(index)->at(pos).getVersion() > space.getVersion()) {
+        // 并发写者先发布了更新的版本
+        return;
+    }
+
+    // 复制块指针数组和所在的块后修改，其余块与已发布的快照共享
+    auto snapshot = std::make_shared<SpaceSnapshot>(*previous);
+    if (index < 0) {
+        snapshot->m_chunks.append(std::make_shared<const SpaceSnapshot::Chunk>(SpaceSnapshot::Chunk{space}));
+        snapshot->m_count++;
+    } else {
+        SpaceSnapshot::Chunk chunk = *previous->m_chunks.at(index);
+        if (found) {
+            snapshot->adjustCount(chunk.at(pos).getStatus(), -1);
+            chunk[pos] = space;
+        } else {
+            chunk.insert(pos, space);
+            snapshot->m_count++;
+        }
+        if (chunk.size() > 2 * SpaceSnapshot::CHUNK_SIZE) {
+            int half = chunk.size() / 2;
+            snapshot->m_chunks[index] = std::make_shared<const SpaceSnapshot::Chunk>(chunk.mid(0, half));
+            snapshot->m_chunks.insert(index + 1, std::make_shared<const SpaceSnapshot::Chunk>(chunk.mid(half)));
+        } else {
+            snapshot->m_chunks[index] = std::make_shared<const SpaceSnapshot::Chunk>(std::move(chunk));
+        }
+    }
+    snapshot->adjustCount(space.getStatus(), 1);
+    snapshot->m_version = previous->m_version + 1;
+
+    std::atomic_store(&m_current, std::shared_ptr<const SpaceSnapshot>(snapshot));
+}
+
+void SpaceSnapshotStore::publishRemoval(int id)
+{
+    QMutexLocker locker(&m_writeMutex);
+
+    // 快照未加载或尚未包含该车位时也要记录，之后到达的发布和重建据此忽略它
+    m_removed.insert(id);
+
+    std::shared_ptr<const SpaceSnapshot> previous = std::atomic_load(&m_current);
+    if (!previous) {
+        return;
+    }
+
+    int pos = 0;
+    bool found = false;
+    int index = previous->locate(id, pos, found);
+    if (!found) {
+        return;
+    }
+
+    auto snapshot = std::make_shared<SpaceSnapshot>(*previous);
+    SpaceSnapshot::Chunk chunk = *previous->m_chunks.at(index);
+    snapshot->adjustCount(chunk.at(pos).getStatus(), -1);
+    chunk.remove(pos);
+    if (chunk.isEmpty()) {
+        snapshot->m_chunks.remove(index);
+    } else {
+        snapshot->m_chunks[index] = std::make_shared<const SpaceSnapshot::Chunk>(std::move(chunk));
+    }
+    snapshot->m_count--;
+    snapshot->m_version = previous->m_version + 1;
+
+    std::atomic_store(&m_current, std::shared_ptr<const SpaceSnapshot>(snapshot));
+}
+
+void SpaceSnapshotStore::invalidate()
+{
+    QMutexLocker locker(&m_writeMutex);
+    std::atomic_store(&m_current, std::shared_ptr<const SpaceSnapshot>());
+}
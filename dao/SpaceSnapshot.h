@@ -0,0 +1,78 @@
+#ifndef SPACESNAPSHOT_H
+#define SPACESNAPSHOT_H
+
+#include "../models/ParkingSpace.h"
+#include <QVector>
+#include <QList>
+#include <QSet>
+#include <QMutex>
+#include <memory>
+
+// 车位表的不可变快照，发布后不再修改，可在任意线程无锁读取
+// 车位按 id 升序分块存放，块在快照之间共享：单个车位的更新只复制所在的块和块指针数组
+class SpaceSnapshot
+{
+public:
+    quint64 version() const { return m_version; }
+
+    // 按 id 升序
+    QList<ParkingSpace> findAll() const;
+    QList<ParkingSpace> findByStatus(ParkingSpace::Status status) const;
+    ParkingSpace findById(int id) const;
+
+    int count() const { return m_count; }
+    int countByStatus(ParkingSpace::Status status) const;
+
+private:
+    friend class SpaceSnapshotStore;
+
+    typedef QVector<ParkingSpace> Chunk;
+
+    // 定位 id：返回所在（或应插入的）块下标，pos 为块内位置，found 表示是否存在
+    int locate(int id, int& pos, bool& found) const;
+    void assign(const QVector<ParkingSpace>& sorted);
+    void recount();
+    void adjustCount(ParkingSpace::Status status, int delta);
+
+    static const int STATUS_COUNT = 4;
+    static const int CHUNK_SIZE = 64;   // 块超过 2 倍时拆分
+
+    quint64 m_version = 0;
+    QVector<std::shared_ptr<const Chunk>> m_chunks;   // 块内和块之间都按 id 升序，没有空块
+    int m_count = 0;
+    int m_statusCounts[STATUS_COUNT] = {0, 0, 0, 0};
+};
+
+// 快照发布点（RCU）：读者原子地取得当前快照，写者复制-修改后原子替换
+class SpaceSnapshotStore
+{
+public:
+    static SpaceSnapshotStore& instance();
+
+    // 当前快照，未加载时返回空指针
+    std::shared_ptr<const SpaceSnapshot> current() const;
+    bool isLoaded() const;
+
+    // 用数据库中的全部车位重建快照
+    void rebuild(const QList<ParkingSpace>& spaces);
+
+    // 发布单个车位的新状态；行版本比快照中旧的写入、已删除车位的写入会被忽略
+    void publish(const ParkingSpace& space);
+    // 发布车位删除；id 由 AUTOINCREMENT 分配、不会复用，删除后该 id 的发布一律忽略，
+    // 避免删除前读到的行（并发的单车位刷新或全量重建）在删除之后发布而把车位加回来
+    void publishRemoval(int id);
+
+    // 丢弃快照，之后的查询退回数据库，直到再次 rebuild
+    void invalidate();
+
+private:
+    SpaceSnapshotStore() = default;
+    SpaceSnapshotStore(const SpaceSnapshotStore&) = delete;
+    SpaceSnapshotStore& operator=(const SpaceSnapshotStore&) = delete;
+
+    std::shared_ptr<const SpaceSnapshot> m_current;
+    QMutex m_writeMutex;   // 串行化写者，读者不加锁
+    QSet<int> m_removed;   // 已删除的车位 id，受 m_writeMutex 保护
+};
+
+#endif // SPACESNAPSHOT_H
@@ -0,0 +1,11 @@
+#ifndef WRITERESULT_H
+#define WRITERESULT_H
+
+// 带版本比较的写入结果
+enum WriteResult {
+    WRITE_OK = 0,        // 写入成功，版本已递增
+    WRITE_CONFLICT = 1,  // 版本不匹配，记录已被并发修改（或已删除）
+    WRITE_ERROR = 2      // 数据库错误
+};
+
+#endif // WRITERESULT_H
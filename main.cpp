@@ -47,6 +47,13 @@ int main(int argc, char *argv[])
     // 创建应用程序实例
     ParkingServerApplication serverApp;
     
+    // 回填汇总表后退出，不启动服务器
+    if (app.arguments().contains("--rebuild-rollups")) {
+        bool rebuilt = serverApp.rebuildRollups();
+        Logger::shutdown();
+        return rebuilt ? 0 : 1;
+    }
+    
     // 初始化应用程序
     if (!serverApp.initialize()) {
         LOG_ERROR("Failed to initialize application");
@@ -1,13 +1,13 @@
 #include "ParkingRecord.h"
 #include "../utils/DateTimeUtil.h"
 
-ParkingRecord::ParkingRecord() : id(0), spaceId(0), fee(0.0), isPaid(false)
+ParkingRecord::ParkingRecord() : id(0), spaceId(0), fee(0.0), isPaid(false), version(0)
 {
     enterTime = QDateTime::currentDateTime();
 }
 
 ParkingRecord::ParkingRecord(const QString& plate, int spaceId)
-    : id(0), plate(plate), spaceId(spaceId), fee(0.0), isPaid(false)
+    : id(0), plate(plate), spaceId(spaceId), fee(0.0), isPaid(false), version(0)
 {
     enterTime = QDateTime::currentDateTime();
 }
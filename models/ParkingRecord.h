@@ -40,6 +40,16 @@ public:
     QString getPayMethod() const { return payMethod; }
     void setPayMethod(const QString& value) { payMethod = value; }
     
+    int getVersion() const { return version; }
+    void setVersion(int value) { version = value; }
+    
+    // 汇总维度：进场时车位的类型和区域，之后车位修改不影响已有记录的归属
+    QString getSpaceType() const { return spaceType; }
+    void setSpaceType(const QString& value) { spaceType = value; }
+    
+    QString getZone() const { return zone; }
+    void setZone(const QString& value) { zone = value; }
+    
     // 计算停车时长（分钟）
     qint64 getParkingDuration() const;
     
@@ -64,6 +74,9 @@ private:
     bool isPaid;          // 是否已支付
     QDateTime payTime;    // 支付时间
     QString payMethod;    // 支付方式
+    int version;          // 行版本，每次写入递增
+    QString spaceType;    // 进场时的车位类型
+    QString zone;         // 进场时的车位区域
 };
 
 #endif // PARKINGRECORD_H
\ No newline at end of file
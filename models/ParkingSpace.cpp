@@ -1,11 +1,11 @@
 #include "ParkingSpace.h"
 
-ParkingSpace::ParkingSpace() : id(0), status(AVAILABLE), hourlyRate(5.0)
+ParkingSpace::ParkingSpace() : id(0), status(AVAILABLE), hourlyRate(5.0), version(0)
 {
 }
 
 ParkingSpace::ParkingSpace(int id, const QString& location, Status status)
-    : id(id), location(location), status(status), hourlyRate(5.0)
+    : id(id), location(location), status(status), hourlyRate(5.0), version(0)
 {
 }
 
@@ -41,6 +41,9 @@ public:
     double getHourlyRate() const { return hourlyRate; }
     void setHourlyRate(double value) { hourlyRate = value; }
     
+    int getVersion() const { return version; }
+    void setVersion(int value) { version = value; }
+    
     // 状态检查
     bool isAvailable() const { return status == AVAILABLE; }
     bool isOccupied() const { return status == OCCUPIED; }
@@ -70,6 +73,7 @@ private:
     QDateTime occupiedTime;     // 占用时间
     QString type;               // 类型（普通、VIP等）
     double hourlyRate;          // 每小时费率
+    int version;                // 行版本，每次写入递增
 };
 
 #endif // PARKINGSPACE_H
\ No newline at end of file
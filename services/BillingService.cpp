@@ -1,10 +1,14 @@
 #include "BillingService.h"
 #include "../api/ApiResponse.h"
 #include "../utils/Logger.h"
+#include "../utils/PlateValidator.h"
+#include "../utils/GateLock.h"
 #include "../dao/ParkingRecordRepository.h"
+#include "../dao/RollupRepository.h"
+#include "../dao/RevenueIndex.h"
 #include "../dao/SpaceRepository.h"
-#include <QRegularExpression>
 #include <QDateTime>
+#include <QHash>
 
 BillingService& BillingService::instance()
 {
@@ -19,6 +23,9 @@ QJsonObject BillingService::startParking(const QString& plate, int spaceId)
             return ApiResponse::error("Invalid plate number");
         }
 
+        // 同一车位或同一车辆的检查与占用必须串行，防止重复停车
+        GateLocker gateLocker(spaceId, plate);
+
         if (!SpaceRepository::instance().exists(spaceId)) {
             return ApiResponse::error("Space not found");
         }
@@ -44,6 +51,7 @@ QJsonObject BillingService::startParking(const QString& plate, int spaceId)
         record.setIsPaid(false);
 
         if (ParkingRecordRepository::instance().insert(record)) {
+            notifyParkingStarted(record);
             return ApiResponse::success("Parking started", recordToJson(record));
         } else {
             SpaceRepository::instance().releaseSpace(spaceId);
@@ -63,27 +71,42 @@ QJsonObject BillingService::endParking(int recordId)
             return ApiResponse::error("Record not found");
         }
 
-        if (record.getExitTime().isValid()) {
-            return ApiResponse::error("Parking already ended");
-        }
+        GateLocker gateLocker(record.getSpaceId(), record.getPlate());
 
         ParkingSpace space = SpaceRepository::instance().findById(record.getSpaceId());
-        QDateTime endTime = QDateTime::currentDateTime();
-        double fee = record.calculateFee(space.getHourlyRate());
 
-        record.setExitTime(endTime);
-        record.setFee(fee);
+        // 门闸锁不覆盖支付，记录仍可能被并发修改，按版本比较写入并重试
+        for (int attempt = 0; attempt < MAX_WRITE_RETRIES; ++attempt) {
+            // 加锁后重新读取，记录可能已被并发结束
+            record = ParkingRecordRepository::instance().findById(recordId);
+            if (record.getExitTime().isValid()) {
+                return ApiResponse::error("Parking already ended");
+            }
 
-        if (ParkingRecordRepository::instance().update(record)) {
-            SpaceRepository::instance().releaseSpace(record.getSpaceId());
-            
-            // 通知空间可用，触发队列处理
-            SpaceService::instance().notifySpaceAvailable(record.getSpaceId());
-            
-            return ApiResponse::success("Parking ended", recordToJson(record));
-        } else {
-            return ApiResponse::error("Failed to update record");
+            QDateTime endTime = QDateTime::currentDateTime();
+            double fee = record.calculateFee(space.getHourlyRate());
+
+            record.setExitTime(endTime);
+            record.setFee(fee);
+
+            WriteResult result = ParkingRecordRepository::instance().compareAndUpdate(record);
+            if (result == WRITE_OK) {
+                SpaceRepository::instance().releaseSpace(record.getSpaceId());
+                gateLocker.unlock();
+                emit parkingEnded(recordId, fee);
+                
+                // 通知空间可用，触发队列处理
+                SpaceService::instance().notifySpaceAvailable(record.getSpaceId());
+                
+                return ApiResponse::success("Parking ended", recordToJson(record));
+            }
+            if (result == WRITE_ERROR) {
+                return ApiResponse::error("Failed to update record");
+            }
+            Logger::warning(QString("Version conflict ending parking record %1, retrying").arg(recordId));
         }
+
+        return ApiResponse::error("Record modified concurrently, please retry");
     } catch (const std::exception& e) {
         Logger::error(QString("Error ending parking: %1").arg(e.what()));
         return ApiResponse::error("Internal server error");
@@ -161,22 +184,47 @@ QJsonObject BillingService::calculateFee(int recordId)
 QJsonObject BillingService::processPayment(int recordId, double amount, const QString& paymentMethod)
 {
     try {
+        if (!validatePaymentMethod(paymentMethod)) {
+            return ApiResponse::error("Invalid payment method");
+        }
+
         ParkingRecord record = ParkingRecordRepository::instance().findById(recordId);
         if (record.getId() == 0) {
             return ApiResponse::error("Record not found");
         }
-        if (!validatePaymentMethod(paymentMethod)) {
-            return ApiResponse::error("Invalid payment method");
-        }
-        record.setFee(amount);
-        record.setIsPaid(true);
-        record.setPayMethod(paymentMethod);
-        record.setPayTime(QDateTime::currentDateTime());
-        if (ParkingRecordRepository::instance().update(record)) {
-            return ApiResponse::success("Payment processed", recordToJson(record));
-        } else {
-            return ApiResponse::error("Failed to process payment");
+        bool wasPaid = record.getIsPaid();
+
+        for (int attempt = 0; attempt < MAX_WRITE_RETRIES; ++attempt) {
+            if (attempt > 0) {
+                // 版本冲突后按最新记录重新校验前提，支付状态已被他人改变时不再重放本次支付
+                record = ParkingRecordRepository::instance().findById(recordId);
+                if (record.getId() == 0) {
+                    return ApiResponse::error("Record not found");
+                }
+                if (wasPaid) {
+                    return ApiResponse::error("Record modified concurrently, please retry");
+                }
+                if (record.getIsPaid()) {
+                    return ApiResponse::error("Record already paid");
+                }
+            }
+            record.setFee(amount);
+            record.setIsPaid(true);
+            record.setPayMethod(paymentMethod);
+            record.setPayTime(QDateTime::currentDateTime());
+
+            WriteResult result = ParkingRecordRepository::instance().compareAndUpdate(record);
+            if (result == WRITE_OK) {
+                emit paymentProcessed(recordId, amount);
+                return ApiResponse::success("Payment processed", recordToJson(record));
+            }
+            if (result == WRITE_ERROR) {
+                return ApiResponse::error("Failed to process payment");
+            }
+            Logger::warning(QString("Version conflict processing payment for record %1, retrying").arg(recordId));
         }
+
+        return ApiResponse::error("Record modified concurrently, please retry");
     } catch (const std::exception& e) {
         Logger::error(QString("Error processing payment: %1").arg(e.what()));
         return ApiResponse::error("Internal server error");
@@ -186,13 +234,28 @@ QJsonObject BillingService::processPayment(int recordId, double amount, const QS
 QJsonObject BillingService::getRevenueStatistics(const QDateTime& startTime, const QDateTime& endTime)
 {
     try {
-        // 获取指定时间范围内的收入统计
-        double totalRevenue = ParkingRecordRepository::instance().sumRevenueByDateRange(startTime, endTime);
-        int totalRecords = ParkingRecordRepository::instance().countByDateRange(startTime, endTime);
-        int paidRecords = ParkingRecordRepository::instance().countByPaymentStatus(true, startTime, endTime);
-        int unpaidRecords = ParkingRecordRepository::instance().countByPaymentStatus(false, startTime, endTime);
-        double paidRevenue = ParkingRecordRepository::instance().sumRevenueByPaymentStatus(true, startTime, endTime);
-        double unpaidRevenue = ParkingRecordRepository::instance().sumRevenueByPaymentStatus(false, startTime, endTime);
+        // 获取指定时间范围内的收入统计（口径与按 enter_time 过滤原始记录一致）
+        // 优先使用内存前缀和索引，未加载时读汇总表
+        qint64 totalRecords = 0;
+        qint64 paidRecords = 0;
+        double paidRevenue = 0.0;
+        double billedRevenue = 0.0;
+        RevenueIndex::Sums sums;
+        if (RevenueIndex::instance().sumRange(startTime, endTime, sums)) {
+            totalRecords = sums.entries;
+            paidRecords = sums.paidCount;
+            paidRevenue = sums.paidRevenue();
+            billedRevenue = sums.billedRevenue();
+        } else {
+            RollupRepository::Totals totals = RollupRepository::instance().sumRange(startTime, endTime);
+            totalRecords = totals.entries;
+            paidRecords = totals.paidCount;
+            paidRevenue = totals.paidRevenue;
+            billedRevenue = totals.billedRevenue;
+        }
+        double totalRevenue = paidRevenue;
+        qint64 unpaidRecords = totalRecords - paidRecords;
+        double unpaidRevenue = billedRevenue - paidRevenue;
         
         QJsonObject stats;
         stats["totalRevenue"] = totalRevenue;
@@ -217,24 +280,14 @@ QJsonObject BillingService::getParkingStatistics(const QDateTime& startTime, con
 {
     try {
         // 获取指定时间范围内的停车统计
-        int totalParkings = ParkingRecordRepository::instance().countByDateRange(startTime, endTime);
-        int activeParkings = ParkingRecordRepository::instance().countByPaymentStatus(false, startTime, endTime); // 未支付表示可能还在停车
-        int completedParkings = ParkingRecordRepository::instance().countByPaymentStatus(true, startTime, endTime); // 已支付表示已完成
-        
-        // 计算平均停车时长和总时长
-        QList<ParkingRecord> records = ParkingRecordRepository::instance().findAll();
-        qint64 totalDuration = 0;
-        int completedCount = 0;
+        RollupRepository::Totals totals = RollupRepository::instance().sumRange(startTime, endTime);
+        qint64 totalParkings = totals.entries;
+        qint64 activeParkings = totals.unpaidCount(); // 未支付表示可能还在停车
+        qint64 completedParkings = totals.paidCount; // 已支付表示已完成
         
-        for (const ParkingRecord& record : records) {
-            if (record.getEnterTime() >= startTime && record.getEnterTime() <= endTime) {
-                if (record.getExitTime().isValid()) {
-                    qint64 duration = record.getEnterTime().secsTo(record.getExitTime());
-                    totalDuration += duration;
-                    completedCount++;
-                }
-            }
-        }
+        // 平均停车时长和总时长（已出场的记录）
+        qint64 totalDuration = totals.durationSeconds;
+        qint64 completedCount = totals.exits;
         
         double avgDurationHours = completedCount > 0 ? (double)totalDuration / completedCount / 3600.0 : 0.0;
         double totalDurationHours = totalDuration / 3600.0;
@@ -261,33 +314,23 @@ QJsonObject BillingService::getPaymentStatistics(const QDateTime& startTime, con
 {
     try {
         // 获取支付统计
-        int paidRecords = ParkingRecordRepository::instance().countByPaymentStatus(true, startTime, endTime);
-        int unpaidRecords = ParkingRecordRepository::instance().countByPaymentStatus(false, startTime, endTime);
-        double paidRevenue = ParkingRecordRepository::instance().sumRevenueByPaymentStatus(true, startTime, endTime);
-        double unpaidRevenue = ParkingRecordRepository::instance().sumRevenueByPaymentStatus(false, startTime, endTime);
-        int totalRecords = paidRecords + unpaidRecords;
+        RollupRepository::Totals totals = RollupRepository::instance().sumRange(startTime, endTime);
+        qint64 paidRecords = totals.paidCount;
+        qint64 unpaidRecords = totals.unpaidCount();
+        double paidRevenue = totals.paidRevenue;
+        double unpaidRevenue = totals.unpaidRevenue();
+        qint64 totalRecords = paidRecords + unpaidRecords;
         double totalRevenue = paidRevenue + unpaidRevenue;
         
         // 支付方式统计
         QJsonObject paymentMethodStats;
         QStringList methods = {"cash", "card", "mobile", "online"};
         for (const QString& method : methods) {
-            int count = 0;
-            double amount = 0.0;
-            
-            QList<ParkingRecord> records = ParkingRecordRepository::instance().findAll();
-            for (const ParkingRecord& record : records) {
-                if (record.getEnterTime() >= startTime && record.getEnterTime() <= endTime && 
-                    record.getIsPaid() && record.getPayMethod() == method) {
-                    count++;
-                    amount += record.getFee();
-                }
-            }
-            
-            if (count > 0) {
+            auto it = totals.byMethod.constFind(method);
+            if (it != totals.byMethod.constEnd() && it.value().count > 0) {
                 QJsonObject methodStat;
-                methodStat["count"] = count;
-                methodStat["amount"] = amount;
+                methodStat["count"] = it.value().count;
+                methodStat["amount"] = it.value().amount;
                 paymentMethodStats[method] = methodStat;
             }
         }
@@ -330,6 +373,63 @@ QJsonArray BillingService::getUnpaidRecords()
     }
 }
 
+bool BillingService::parseFieldMask(const QString& spec, FieldMask& mask, QString& error)
+{
+    static const char* const names[RECORD_FIELD_COUNT] = {
+        "createdAt", "endTime", "fee", "id", "overdueDays", "paidAmount",
+        "paymentMethod", "paymentStatus", "plate", "spaceId", "startTime", "unpaidAmount"
+    };
+    return FieldMask::parse(spec, names, RECORD_FIELD_COUNT, mask, error);
+}
+
+int BillingService::writeUnpaidRecords(QByteArray& out, const FieldMask& fields)
+{
+    // 逐行从游标写出，不整体载入记录；外壳中的 count 在写完后补上
+    std::unique_ptr<ParkingRecordCursor> cursor = ParkingRecordRepository::instance().openNewestFirstCursor(true);
+    
+    int count = 0;
+    JsonWriter writer(out);
+    writer.beginApiList();
+    ParkingRecord record;
+    while (cursor->next(record)) {
+        writeRecord(writer, record, fields);
+        count++;
+    }
+    writer.endApiList("Unpaid records retrieved successfully", count);
+    return count;
+}
+
+int BillingService::writeOverdueRecords(QByteArray& out, int limit, const FieldMask& fields)
+{
+    // 与 findAll(limit) 相同，只检查最近进场的 limit 条记录
+    std::unique_ptr<ParkingRecordCursor> cursor = ParkingRecordRepository::instance().openNewestFirstCursor();
+    QDateTime now = QDateTime::currentDateTime();
+    
+    // 应收金额按车位当前费率重新计算；支付时 fee 被改写为实付金额，不能拿它和自身比较
+    QHash<int, double> hourlyRates;
+    int count = 0;
+    JsonWriter writer(out);
+    writer.beginApiList();
+    ParkingRecord record;
+    while ((limit <= 0 || cursor->rowsRead() < limit) && cursor->next(record)) {
+        if (!record.getExitTime().isValid()) {
+            continue;
+        }
+        auto rate = hourlyRates.find(record.getSpaceId());
+        if (rate == hourlyRates.end()) {
+            rate = hourlyRates.insert(record.getSpaceId(),
+                                      SpaceRepository::instance().findById(record.getSpaceId()).getHourlyRate());
+        }
+        double amountDue = record.calculateFee(rate.value());
+        if (isOverdue(record, amountDue, now)) {
+            writeRecord(writer, record, fields, now, amountDue);
+            count++;
+        }
+    }
+    writer.endApiList("Overdue records retrieved successfully", count);
+    return count;
+}
+
 QJsonObject BillingService::getUnpaidAmount(const QString& plate)
 {
     try {
@@ -382,6 +482,11 @@ double BillingService::getHourlyRate(int spaceId)
     }
 }
 
+void BillingService::notifyParkingStarted(const ParkingRecord& record)
+{
+    emit parkingStarted(record.getId(), record.getPlate(), record.getSpaceId());
+}
+
 QJsonObject BillingService::recordToJson(const ParkingRecord& record)
 {
     QJsonObject json;
@@ -398,6 +503,57 @@ QJsonObject BillingService::recordToJson(const ParkingRecord& record)
     return json;
 }
 
+void BillingService::writeRecord(JsonWriter& writer, const ParkingRecord& record, const FieldMask& fields,
+                                 const QDateTime& overdueAsOf, double amountDue)
+{
+    // 键按字母序，与 recordToJson 的序列化结果一致；overdueAsOf 有效时附加欠费字段
+    // 未请求的字段不做时间格式化等计算
+    double paidAmount = overdueAsOf.isValid() ? paidAmountOf(record) : record.getFee();
+    QString startTime;
+    if (fields.has(RECORD_CREATED_AT) || fields.has(RECORD_START_TIME)) {
+        startTime = record.getEnterTime().toString(Qt::ISODate);
+    }
+    
+    writer.beginObject();
+    if (fields.has(RECORD_CREATED_AT)) {
+        writer.field("createdAt", startTime);
+    }
+    if (fields.has(RECORD_END_TIME)) {
+        writer.field("endTime", record.getExitTime().isValid() ? record.getExitTime().toString(Qt::ISODate) : QString());
+    }
+    if (fields.has(RECORD_FEE)) {
+        writer.field("fee", record.getFee());
+    }
+    if (fields.has(RECORD_ID)) {
+        writer.field("id", record.getId());
+    }
+    if (overdueAsOf.isValid() && fields.has(RECORD_OVERDUE_DAYS)) {
+        writer.field("overdueDays", record.getExitTime().daysTo(overdueAsOf));
+    }
+    if (fields.has(RECORD_PAID_AMOUNT)) {
+        writer.field("paidAmount", paidAmount);
+    }
+    if (fields.has(RECORD_PAYMENT_METHOD)) {
+        writer.field("paymentMethod", record.getPayMethod());
+    }
+    if (fields.has(RECORD_PAYMENT_STATUS)) {
+        writer.field("paymentStatus", record.getIsPaid() ? "paid" : "unpaid");
+    }
+    if (fields.has(RECORD_PLATE)) {
+        writer.field("plate", record.getPlate());
+    }
+    if (fields.has(RECORD_SPACE_ID)) {
+        writer.field("spaceId", record.getSpaceId());
+    }
+    if (fields.has(RECORD_START_TIME)) {
+        writer.field("startTime", startTime);
+    }
+    if (overdueAsOf.isValid() && fields.has(RECORD_UNPAID_AMOUNT)) {
+        writer.field("unpaidAmount", amountDue - paidAmount);
+    }
+    writer.endObject();
+}
+
 QJsonArray BillingService::recordsToJson(const QList<ParkingRecord>& records)
 {
     QJsonArray array;
@@ -409,12 +565,7 @@ QJsonArray BillingService::recordsToJson(const QList<ParkingRecord>& records)
 
 bool BillingService::validatePlate(const QString& plate)
 {
-    // 第1位汉字 + 第2位大写字母 + 后5位大写字母或数字
-    static QRegularExpression reg(
-        R"(^[\x{4e00}-\x{9fa5}][A-Z][A-Z0-9]{5}$)"
-    );
-    
-    return reg.match(plate).hasMatch();
+    return PlateValidator::isValid(plate);
 }
 
 bool BillingService::validatePaymentMethod(const QString& method)
@@ -432,13 +583,18 @@ double BillingService::calculateParkingFee(const QDateTime& startTime, const QDa
     return qRound(fee * 100) / 100.0;
 }
 
-bool BillingService::isOverdue(const ParkingRecord& record)
+bool BillingService::isOverdue(const ParkingRecord& record, double amountDue, const QDateTime& now)
 {
-    if (record.getExitTime().isValid() && !record.getIsPaid()) {
-        QDateTime now = QDateTime::currentDateTime();
-        return record.getExitTime().addDays(1) < now;
+    if (!record.getExitTime().isValid() || record.getExitTime().addDays(1) >= now) {
+        return false;
     }
-    return false;
+    // 金额按分比较，避免浮点误差把足额支付判成欠费
+    return qRound64(paidAmountOf(record) * 100) < qRound64(amountDue * 100);
+}
+
+double BillingService::paidAmountOf(const ParkingRecord& record)
+{
+    return record.getIsPaid() ? record.getFee() : 0.0;
 }
 
 QJsonObject BillingService::generatePaymentReminder(const QString& plate, double amount)
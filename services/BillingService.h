@@ -6,6 +6,8 @@
 #include <QJsonArray>
 #include "../models/ParkingRecord.h"
 #include "../dao/SpaceRepository.h"
+#include "../core/JsonWriter.h"
+#include "../core/FieldMask.h"
 #include "SpaceService.h"
 
 class BillingService : public QObject
@@ -34,6 +36,28 @@ public:
     
     // 欠费管理
     QJsonArray getUnpaidRecords();
+    
+    // 列表响应直接写入 out，返回记录数
+    // 停车记录可投影字段，按 JSON 键的字母序排列
+    enum RecordField {
+        RECORD_CREATED_AT = 0,
+        RECORD_END_TIME,
+        RECORD_FEE,
+        RECORD_ID,
+        RECORD_OVERDUE_DAYS,
+        RECORD_PAID_AMOUNT,
+        RECORD_PAYMENT_METHOD,
+        RECORD_PAYMENT_STATUS,
+        RECORD_PLATE,
+        RECORD_SPACE_ID,
+        RECORD_START_TIME,
+        RECORD_UNPAID_AMOUNT,
+        RECORD_FIELD_COUNT
+    };
+    static bool parseFieldMask(const QString& spec, FieldMask& mask, QString& error);
+    
+    int writeUnpaidRecords(QByteArray& out, const FieldMask& fields = FieldMask());
+    int writeOverdueRecords(QByteArray& out, int limit = 1000, const FieldMask& fields = FieldMask());
     QJsonObject getUnpaidAmount(const QString& plate);
     QJsonObject sendPaymentReminder(const QString& plate);
     
@@ -43,6 +67,12 @@ public:
     // 费率管理
     QJsonObject getCurrentRates();
     double getHourlyRate(int spaceId);
+    
+    // 记录已由其他流程（排队分配）写入后发出 parkingStarted，订阅方与 startParking() 的一致
+    void notifyParkingStarted(const ParkingRecord& record);
+    
+    // 停车记录的 JSON 表示（各列表和仪表板共用）
+    QJsonObject recordToJson(const ParkingRecord& record);
 
 signals:
     void parkingStarted(int recordId, const QString& plate, int spaceId);
@@ -55,13 +85,20 @@ private:
     BillingService(const BillingService&) = delete;
     BillingService& operator=(const BillingService&) = delete;
     
-    QJsonObject recordToJson(const ParkingRecord& record);
     QJsonArray recordsToJson(const QList<ParkingRecord>& records);
+    // overdueAsOf 有效时按欠费口径输出：paidAmount 为实付金额，unpaidAmount 为 amountDue 与实付之差
+    void writeRecord(JsonWriter& writer, const ParkingRecord& record, const FieldMask& fields,
+                     const QDateTime& overdueAsOf = QDateTime(), double amountDue = 0.0);
     bool validatePlate(const QString& plate);
     bool validatePaymentMethod(const QString& method);
     double calculateParkingFee(const QDateTime& startTime, const QDateTime& endTime, double hourlyRate);
-    bool isOverdue(const ParkingRecord& record);
+    // 出场超过24小时，且未支付或实付低于按车位费率重新计算的应收金额
+    bool isOverdue(const ParkingRecord& record, double amountDue, const QDateTime& now);
+    static double paidAmountOf(const ParkingRecord& record);
     QJsonObject generatePaymentReminder(const QString& plate, double amount);
+    
+    // 版本冲突时的最大重试次数
+    static const int MAX_WRITE_RETRIES = 3;
 };
 
 #endif // BILLINGSERVICE_H
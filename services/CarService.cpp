@@ -1,8 +1,8 @@
 #include "CarService.h"
 #include "../api/ApiResponse.h"
 #include "../utils/Logger.h"
+#include "../utils/PlateValidator.h"
 #include "../dao/CarRepository.h"
-#include <QRegularExpression>
 
 CarService& CarService::instance()
 {
@@ -37,6 +37,7 @@ QJsonObject CarService::registerCar(const QString& plate, const QString& type, c
         car.setCreateTime(QDateTime::currentDateTime());
         
         if (CarRepository::instance().insert(car)) {
+            emit carRegistered(plate);
             return ApiResponse::success("Car registered", carToJson(car));
         } else {
             return ApiResponse::error("Failed to register car");
@@ -73,6 +74,20 @@ QJsonArray CarService::getAllCars()
     }
 }
 
+int CarService::writeAllCars(QByteArray& out)
+{
+    QList<Car> cars = CarRepository::instance().findAll();
+    out.reserve(out.size() + cars.size() * 96 + 128);
+    
+    JsonWriter writer(out);
+    writer.beginApiList(cars.size());
+    for (const Car& car : cars) {
+        writeCar(writer, car);
+    }
+    writer.endApiList("Cars retrieved successfully");
+    return cars.size();
+}
+
 QJsonArray CarService::getCarsByType(const QString& type)
 {
     try {
@@ -105,6 +120,7 @@ QJsonObject CarService::updateCar(const QString& plate, const QString& type, con
         car.setUpdateTime(QDateTime::currentDateTime());
         
         if (CarRepository::instance().update(car)) {
+            emit carUpdated(plate);
             return ApiResponse::success("Car updated", carToJson(car));
         } else {
             return ApiResponse::error("Failed to update car");
@@ -123,6 +139,7 @@ QJsonObject CarService::deleteCar(const QString& plate)
         }
         
         if (CarRepository::instance().remove(plate)) {
+            emit carDeleted(plate);
             return ApiResponse::success("Car deleted");
         } else {
             return ApiResponse::error("Failed to delete car");
@@ -173,6 +190,17 @@ QJsonObject CarService::carToJson(const Car& car)
     return json;
 }
 
+void CarService::writeCar(JsonWriter& writer, const Car& car)
+{
+    // 键按字母序，与 carToJson 的序列化结果一致
+    writer.beginObject();
+    writer.field("color", car.getColor());
+    writer.field("createdAt", car.getCreateTime().toString(Qt::ISODate));
+    writer.field("plate", car.getPlate());
+    writer.field("type", car.getType());
+    writer.endObject();
+}
+
 QJsonArray CarService::carsToJson(const QList<Car>& cars)
 {
     QJsonArray array;
@@ -184,12 +212,7 @@ QJsonArray CarService::carsToJson(const QList<Car>& cars)
 
 bool CarService::validatePlate(const QString& plate)
 {
-    // 第1位汉字 + 第2位大写字母 + 后5位大写字母或数字
-    static QRegularExpression reg(
-        R"(^[\x{4e00}-\x{9fa5}][A-Z][A-Z0-9]{5}$)"
-    );
-
-    return reg.match(plate).hasMatch();
+    return PlateValidator::isValid(plate);
 }
 
 bool CarService::validateCarType(const QString& type)
@@ -6,6 +6,7 @@
 #include <QJsonArray>
 #include "../models/Car.h"
 #include "../dao/CarRepository.h"
+#include "../core/JsonWriter.h"
 
 class CarService : public QObject
 {
@@ -22,6 +23,9 @@ public:
     QJsonArray getAllCars();
     QJsonArray getCarsByType(const QString& type);
     
+    // 将全部车辆的列表响应直接写入 out，返回车辆数
+    int writeAllCars(QByteArray& out);
+    
     // 车辆信息更新
     QJsonObject updateCar(const QString& plate, const QString& type, const QString& owner);
     
@@ -46,6 +50,7 @@ private:
     
     QJsonObject carToJson(const Car& car);
     QJsonArray carsToJson(const QList<Car>& cars);
+    void writeCar(JsonWriter& writer, const Car& car);
     bool validatePlate(const QString& plate);
     bool validateCarType(const QString& type);
 };
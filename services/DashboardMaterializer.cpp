@@ -0,0 +1,283 @@
+#include "DashboardMaterializer.h"
+#include "SpaceService.h"
+#include "CarService.h"
+#include "BillingService.h"
+#include "../dao/ParkingRecordRepository.h"
+#include "../utils/Logger.h"
+#include <QtConcurrent>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QTimer>
+
+DashboardMaterializer& DashboardMaterializer::instance()
+{
+    static DashboardMaterializer instance;
+    return instance;
+}
+
+void DashboardMaterializer::attach()
+{
+    if (m_watcher) {
+        return;
+    }
+
+    m_watcher = new QFutureWatcher<void>(this);
+    connect(m_watcher, &QFutureWatcher<void>::finished, this, [this]() {
+        // 执行期间到达的事件已在 m_pending 中累积
+        if (!m_pending.isEmpty()) {
+            scheduleUpdate();
+        }
+    });
+
+    // 以 this 为上下文连接：调度线程发出的信号排队到主线程
+    SpaceService& spaceService = SpaceService::instance();
+    connect(&spaceService, &SpaceService::spaceAdded, this, [this](int) { markDirty(SECTION_SPACES); });
+    connect(&spaceService, &SpaceService::spaceUpdated, this, [this](int) { markDirty(SECTION_SPACES); });
+    connect(&spaceService, &SpaceService::spaceDeleted, this, [this](int) { markDirty(SECTION_SPACES); });
+    connect(&spaceService, &SpaceService::spaceOccupied, this, [this](int, const QString&) { markDirty(SECTION_SPACES); });
+    connect(&spaceService, &SpaceService::spaceReleased, this, [this](int) { markDirty(SECTION_SPACES); });
+
+    CarService& carService = CarService::instance();
+    connect(&carService, &CarService::carRegistered, this, [this](const QString&) { markDirty(SECTION_CARS); });
+    connect(&carService, &CarService::carUpdated, this, [this](const QString&) { markDirty(SECTION_CARS); });
+    connect(&carService, &CarService::carDeleted, this, [this](const QString&) { markDirty(SECTION_CARS); });
+
+    BillingService& billingService = BillingService::instance();
+    connect(&billingService, &BillingService::parkingStarted, this, [this](int recordId, const QString&, int) {
+        markDirty(SECTION_REVENUE, recordId);
+    });
+    connect(&billingService, &BillingService::parkingEnded, this, [this](int recordId, double) {
+        markDirty(SECTION_REVENUE, recordId);
+    });
+    connect(&billingService, &BillingService::paymentProcessed, this, [this](int recordId, double) {
+        markDirty(SECTION_REVENUE, recordId);
+    });
+
+    m_reconcileTimer = new QTimer(this);
+    connect(m_reconcileTimer, &QTimer::timeout, this, [this]() {
+        m_pending.full = true;
+        startUpdate();
+    });
+    m_reconcileTimer->start(RECONCILE_INTERVAL_MS);
+
+    m_pending.full = true;
+    startUpdate();
+
+    Logger::info("Dashboard materializer attached");
+}
+
+std::shared_ptr<const QByteArray> DashboardMaterializer::current() const
+{
+    return std::atomic_load(&m_current);
+}
+
+QJsonObject DashboardMaterializer::statistics() const
+{
+    QMutexLocker locker(&m_statsMutex);
+
+    QJsonObject stats;
+    stats["ready"] = m_generatedAt.isValid();
+    stats["generatedAt"] = m_generatedAt.isValid() ? m_generatedAt.toString(Qt::ISODate) : QString();
+    stats["ageMs"] = m_generatedAt.isValid() ? m_generatedAt.msecsTo(QDateTime::currentDateTime()) : -1;
+    stats["incrementalUpdates"] = m_incrementalUpdates;
+    stats["fullReconciles"] = m_fullReconciles;
+    stats["recordsApplied"] = m_recordsApplied;
+    stats["lastUpdateMs"] = m_lastUpdateMs;
+    stats["maxUpdateMs"] = m_maxUpdateMs;
+    return stats;
+}
+
+void DashboardMaterializer::markDirty(int sections, int recordId)
+{
+    m_pending.sections |= sections;
+    if (recordId > 0) {
+        m_pending.records.insert(recordId);
+    } else if (recordId == 0) {
+        // 事件未带回记录 id，只能全量重读
+        m_pending.full = true;
+    }
+    scheduleUpdate();
+}
+
+void DashboardMaterializer::scheduleUpdate()
+{
+    if (m_updateScheduled) {
+        return;
+    }
+    m_updateScheduled = true;
+    QTimer::singleShot(DEBOUNCE_MS, this, [this]() {
+        m_updateScheduled = false;
+        startUpdate();
+    });
+}
+
+void DashboardMaterializer::startUpdate()
+{
+    // 上一次更新尚未完成时保留待处理事件，完成后再调度
+    if (!m_watcher || m_watcher->isRunning() || m_pending.isEmpty()) {
+        return;
+    }
+
+    Update update = m_pending;
+    m_pending = Update();
+    m_watcher->setFuture(QtConcurrent::run([this, update]() {
+        apply(update);
+    }));
+}
+
+void DashboardMaterializer::apply(const Update& update)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        QDateTime now = QDateTime::currentDateTime();
+        int sections = update.full ? SECTION_ALL : update.sections;
+
+        // 跨天后当日收入需要按新的日期重新统计
+        if (now.date() != m_revenueDate) {
+            sections |= SECTION_REVENUE;
+        }
+
+        if (update.full) {
+            reloadRecords();
+        } else {
+            for (int recordId : update.records) {
+                applyRecord(recordId);
+            }
+        }
+
+        if (sections & SECTION_SPACES) {
+            m_spaces = SpaceService::instance().getStatistics()["data"].toObject();
+        }
+        if (sections & SECTION_CARS) {
+            m_cars = CarService::instance().getStatistics()["data"].toObject();
+        }
+        if (sections & SECTION_REVENUE) {
+            QDateTime todayStart = QDateTime(now.date(), QTime(0, 0, 0));
+            QDateTime todayEnd = QDateTime(now.date(), QTime(23, 59, 59));
+            m_revenue = BillingService::instance().getRevenueStatistics(todayStart, todayEnd)["data"].toObject();
+            m_revenueDate = now.date();
+        }
+
+        std::atomic_store(&m_current, std::make_shared<const QByteArray>(encode(now)));
+
+        qint64 elapsed = timer.elapsed();
+        QMutexLocker locker(&m_statsMutex);
+        m_generatedAt = now;
+        if (update.full) {
+            m_fullReconciles++;
+        } else {
+            m_incrementalUpdates++;
+            m_recordsApplied += update.records.size();
+        }
+        m_lastUpdateMs = elapsed;
+        m_maxUpdateMs = qMax(m_maxUpdateMs, elapsed);
+
+    } catch (const std::exception& e) {
+        // 保留上一次发布的结果，下一次对账会重新构建
+        Logger::error(QString("Error materializing dashboard: %1").arg(e.what()));
+    }
+}
+
+void DashboardMaterializer::applyRecord(int recordId)
+{
+    ParkingRecord record = ParkingRecordRepository::instance().findById(recordId);
+    if (record.getId() == 0) {
+        m_active.remove(recordId);
+        removeUnpaid(recordId);
+        return;
+    }
+
+    QJsonObject json = BillingService::instance().recordToJson(record);
+    if (record.getExitTime().isValid()) {
+        m_active.remove(recordId);
+    } else {
+        m_active.insert(recordId, json);
+    }
+    if (record.getIsPaid()) {
+        removeUnpaid(recordId);
+    } else {
+        setUnpaid(record, json);
+    }
+}
+
+void DashboardMaterializer::setUnpaid(const ParkingRecord& record, const QJsonObject& json)
+{
+    // 进场时间可能被修改，先按旧键移除
+    removeUnpaid(record.getId());
+    RecordKey key(record.getEnterTime(), record.getId());
+    m_unpaid.insert(key, json);
+    m_unpaidKeys.insert(record.getId(), key);
+}
+
+void DashboardMaterializer::removeUnpaid(int recordId)
+{
+    auto it = m_unpaidKeys.find(recordId);
+    if (it != m_unpaidKeys.end()) {
+        m_unpaid.remove(it.value());
+        m_unpaidKeys.erase(it);
+    }
+}
+
+void DashboardMaterializer::reloadRecords()
+{
+    QMap<int, QJsonObject> active;
+    for (const ParkingRecord& record : ParkingRecordRepository::instance().findActive()) {
+        active.insert(record.getId(), BillingService::instance().recordToJson(record));
+    }
+
+    QMap<RecordKey, QJsonObject> unpaid;
+    QHash<int, RecordKey> unpaidKeys;
+    for (const ParkingRecord& record : ParkingRecordRepository::instance().findAll()) {
+        if (!record.getIsPaid()) {
+            RecordKey key(record.getEnterTime(), record.getId());
+            unpaid.insert(key, BillingService::instance().recordToJson(record));
+            unpaidKeys.insert(record.getId(), key);
+        }
+    }
+
+    m_active.swap(active);
+    m_unpaid.swap(unpaid);
+    m_unpaidKeys.swap(unpaidKeys);
+}
+
+QByteArray DashboardMaterializer::encode(const QDateTime& generatedAt) const
+{
+    // 字段和记录顺序与同步生成的仪表板响应相同（tests/dashboard 对比两者）：
+    // 活跃停车按记录 id 升序（findActive），未支付记录按 enter_time DESC, id DESC（getUnpaidRecords）
+    QJsonArray activeParkings;
+    for (const QJsonObject& record : m_active) {
+        activeParkings.append(record);
+    }
+    QJsonArray unpaidRecords;
+    for (auto it = m_unpaid.constEnd(); it != m_unpaid.constBegin();) {
+        --it;
+        unpaidRecords.append(it.value());
+    }
+
+    QJsonObject dashboard;
+    dashboard["spaces"] = m_spaces;
+    dashboard["cars"] = m_cars;
+    dashboard["revenue"] = m_revenue;
+    dashboard["activeParkings"] = activeParkings;
+    dashboard["activeParkingCount"] = activeParkings.size();
+    dashboard["unpaidRecords"] = unpaidRecords;
+    dashboard["unpaidCount"] = unpaidRecords.size();
+    dashboard["systemTime"] = generatedAt.toString(Qt::ISODate);
+    dashboard["generatedAt"] = generatedAt.toString(Qt::ISODate);
+    dashboard["serverStatus"] = "running";
+
+    QJsonObject result;
+    result["success"] = true;
+    result["data"] = dashboard;
+    result["message"] = "Dashboard data retrieved successfully";
+
+    QJsonObject envelope;
+    envelope["code"] = 0;
+    envelope["msg"] = "success";
+    envelope["data"] = result;
+    return QJsonDocument(envelope).toJson(QJsonDocument::Compact);
+}
@@ -0,0 +1,105 @@
+#ifndef DASHBOARDMATERIALIZER_H
+#define DASHBOARDMATERIALIZER_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QDate>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <memory>
+
+class QTimer;
+class ParkingRecord;
+
+// 仪表板的物化视图：在线程池中维护，请求只取已编码好的响应体
+// 领域事件只标记受影响的部分（车位、车辆、当日收入、单条停车记录），合并一个短窗口后增量更新
+// 定时全量对账纠正遗漏的事件并处理跨天；对象位于主线程，其他线程发出的信号经排队连接转入
+class DashboardMaterializer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static DashboardMaterializer& instance();
+
+    // 连接领域信号，开始首次全量构建并启动对账定时器
+    void attach();
+
+    // 最新的完整响应体（含 ApiResponse 外壳），首次构建完成前为空指针；任意线程可调用
+    std::shared_ptr<const QByteArray> current() const;
+
+    // 更新次数、耗时和数据新鲜度
+    QJsonObject statistics() const;
+
+    static const int DEBOUNCE_MS = 100;               // 事件合并窗口
+    static const int RECONCILE_INTERVAL_MS = 60000;   // 全量对账间隔
+
+private:
+    enum Section {
+        SECTION_SPACES = 0x1,
+        SECTION_CARS = 0x2,
+        SECTION_REVENUE = 0x4,
+        SECTION_ALL = 0x7
+    };
+
+    // 一次后台更新的输入
+    struct Update {
+        int sections = 0;
+        QSet<int> records;      // 需要重新读取的停车记录 id
+        bool full = false;
+
+        bool isEmpty() const { return sections == 0 && records.isEmpty() && !full; }
+    };
+
+    DashboardMaterializer() = default;
+    DashboardMaterializer(const DashboardMaterializer&) = delete;
+    DashboardMaterializer& operator=(const DashboardMaterializer&) = delete;
+
+    // 主线程
+    void markDirty(int sections, int recordId = -1);
+    void scheduleUpdate();
+    void startUpdate();
+
+    // 线程池线程，同一时刻只有一个更新在执行，模型无需加锁
+    void apply(const Update& update);
+    void applyRecord(int recordId);
+    void reloadRecords();
+    QByteArray encode(const QDateTime& generatedAt) const;
+    void setUnpaid(const ParkingRecord& record, const QJsonObject& json);
+    void removeUnpaid(int recordId);
+
+    // 未支付记录按 (进场时间, 记录 id) 排序，逆序遍历即 enter_time DESC, id DESC
+    typedef QPair<QDateTime, int> RecordKey;
+
+    // 模型
+    QJsonObject m_spaces;
+    QJsonObject m_cars;
+    QJsonObject m_revenue;
+    QDate m_revenueDate;                 // 当日收入对应的日期
+    QMap<int, QJsonObject> m_active;           // 活跃停车，按记录 id，与 findActive 的顺序一致
+    QMap<RecordKey, QJsonObject> m_unpaid;     // 未支付记录（含活跃停车）
+    QHash<int, RecordKey> m_unpaidKeys;        // 记录 id 到 m_unpaid 中的键
+
+    // 主线程状态
+    Update m_pending;
+    bool m_updateScheduled = false;
+    QFutureWatcher<void>* m_watcher = nullptr;
+    QTimer* m_reconcileTimer = nullptr;
+
+    std::shared_ptr<const QByteArray> m_current;
+
+    // 统计
+    mutable QMutex m_statsMutex;
+    QDateTime m_generatedAt;
+    qint64 m_incrementalUpdates = 0;
+    qint64 m_fullReconciles = 0;
+    qint64 m_recordsApplied = 0;
+    qint64 m_lastUpdateMs = 0;
+    qint64 m_maxUpdateMs = 0;
+};
+
+#endif // DASHBOARDMATERIALIZER_H
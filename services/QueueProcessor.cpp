@@ -1,13 +1,16 @@
 #include "QueueProcessor.h"
 #include "../utils/Logger.h"
+#include "../utils/GateLock.h"
 #include "../dao/QueueRepository.h"
 #include "../dao/SpaceRepository.h"
 #include "../dao/ParkingRecordRepository.h"
+#include "SpaceService.h"
+#include "BillingService.h"
 #include "../api/ApiResponse.h"
-#include <QtConcurrent/QtConcurrent>
 #include <QMutexLocker>
 #include <QTimer>
 #include <QDateTime>
+#include <QElapsedTimer>
 
 QueueProcessor& QueueProcessor::instance()
 {
@@ -15,45 +18,66 @@ QueueProcessor& QueueProcessor::instance()
     return instance;
 }
 
-QJsonObject QueueProcessor::processQueueForAvailableSpaces()
+QueueProcessor::~QueueProcessor()
 {
-    QMutexLocker locker(&m_mutex);
-    
-    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-    
-    // 检查处理间隔
-    if (currentTime - m_lastProcessTime < MIN_PROCESS_INTERVAL) {
-        QJsonObject result;
-        result["assignedCount"] = 0;
-        result["message"] = "Queue processing too frequent";
-        result["success"] = false;
-        return result;
+    stop();
+}
+
+void QueueProcessor::start()
+{
+    QMutexLocker locker(&m_signalMutex);
+    if (m_dispatcherThread) {
+        return;
     }
-    
-    if (m_processing) {
-        QJsonObject result;
-        result["assignedCount"] = 0;
-        result["message"] = "Queue processing already in progress";
-        result["success"] = false;
-        return result;
+
+    m_stopping = false;
+    // 启动时队列里可能已有车辆，先排空一次
+    m_pending = true;
+    m_dispatcherThread = QThread::create([this]() {
+        dispatchLoop();
+    });
+    m_dispatcherThread->setObjectName("QueueDispatcher");
+    m_dispatcherThread->start();
+
+    Logger::info("Queue dispatcher thread started");
+}
+
+void QueueProcessor::stop()
+{
+    QThread* thread = nullptr;
+    {
+        QMutexLocker locker(&m_signalMutex);
+        if (!m_dispatcherThread) {
+            return;
+        }
+        m_stopping = true;
+        m_wakeCondition.wakeAll();
+        thread = m_dispatcherThread;
+        m_dispatcherThread = nullptr;
     }
-    
-    m_processing = true;
-    m_lastProcessTime = currentTime;
+
+    thread->wait();
+    delete thread;
+    Logger::info("Queue dispatcher thread stopped");
+}
+
+QJsonObject QueueProcessor::processQueueForAvailableSpaces()
+{
+    QMutexLocker locker(&m_mutex);
+
     QJsonObject result;
-    
+
     try {
-        // 直接处理队列分配逻辑，避免递归调用
-        result = processQueueLogic();
+        result = drainQueue();
         int assignedCount = result["assignedCount"].toInt();
-        
+
         if (assignedCount > 0) {
             emit queueProcessed(assignedCount);
             Logger::info(QString("Queue processor assigned %1 spaces to queued vehicles").arg(assignedCount));
         }
-        
+
         result["success"] = true;
-        
+
     } catch (const std::exception& e) {
         Logger::error(QString("Error in queue processor: %1").arg(e.what()));
         result["assignedCount"] = 0;
@@ -62,112 +86,272 @@ QJsonObject QueueProcessor::processQueueForAvailableSpaces()
         result["error"] = e.what();
         emit queueProcessError(e.what());
     }
-    
-    m_processing = false;
+
     return result;
 }
 
+void QueueProcessor::notifySpaceReleased(int count)
+{
+    QMutexLocker locker(&m_signalMutex);
+
+    // 每个实际释放的车位记录一次释放时间，按先进先出与之后的分配配对统计延迟
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < count && m_releaseTimes.size() < MAX_PENDING_RELEASES; ++i) {
+        m_releaseTimes.enqueue(now);
+    }
+
+    wakeDispatcherLocked();
+}
+
 void QueueProcessor::checkAndProcessQueue()
 {
-    // 使用延迟处理，避免在高频调用时阻塞
-    // 延迟100ms执行，让当前操作先完成
-    QTimer::singleShot(100, [this]() {
-        processQueueForAvailableSpaces();
-    });
+    QMutexLocker locker(&m_signalMutex);
+    wakeDispatcherLocked();
 }
 
 void QueueProcessor::forceProcessQueue()
 {
-    QMutexLocker locker(&m_mutex);
-    
-    // 强制重置处理状态
-    m_processing = false;
-    
-    // 延迟处理，避免立即阻塞
-    QTimer::singleShot(50, [this]() {
+    QMutexLocker locker(&m_signalMutex);
+    wakeDispatcherLocked();
+}
+
+void QueueProcessor::wakeDispatcherLocked()
+{
+    if (!m_dispatcherThread) {
+        // 调度线程未启动时退化为事件循环中异步处理
+        QTimer::singleShot(0, [this]() {
+            processQueueForAvailableSpaces();
+        });
+        return;
+    }
+
+    m_pending = true;
+    m_wakeCondition.wakeOne();
+}
+
+QJsonObject QueueProcessor::getDispatchStatistics()
+{
+    QMutexLocker locker(&m_signalMutex);
+
+    QJsonObject stats;
+    stats["dispatcherRunning"] = m_dispatcherThread != nullptr;
+    stats["assignedTotal"] = m_assignedTotal;
+    stats["pendingReleases"] = m_releaseTimes.size();
+    stats["batchSize"] = m_batchSize;
+    stats["latencySamples"] = m_latencySamples;
+    stats["avgAssignLatencyMs"] = m_latencySamples > 0 ? (double)m_latencyTotalMs / m_latencySamples : 0.0;
+    stats["maxAssignLatencyMs"] = m_latencyMaxMs;
+    stats["lastAssignLatencyMs"] = m_latencyLastMs;
+    return stats;
+}
+
+void QueueProcessor::dispatchLoop()
+{
+    forever {
+        {
+            QMutexLocker locker(&m_signalMutex);
+            while (!m_pending && !m_stopping) {
+                m_wakeCondition.wait(&m_signalMutex);
+            }
+            if (m_stopping) {
+                return;
+            }
+            // 在排空期间到达的释放事件会重新置位，不会丢失
+            m_pending = false;
+        }
+
         processQueueForAvailableSpaces();
-    });
+    }
 }
 
-QJsonObject QueueProcessor::processQueueLogic()
+QJsonObject QueueProcessor::drainQueue()
 {
     QJsonObject result;
     int assignedCount = 0;
-    
+    int batches = 0;
+    bool queueEmpty = false;
+    bool spacesExhausted = false;
+
+    forever {
+        int batchSize;
+        {
+            QMutexLocker locker(&m_signalMutex);
+            batchSize = m_batchSize;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QJsonObject batch = processQueueLogic(batchSize);
+        qint64 elapsed = timer.elapsed();
+        batches++;
+
+        int assigned = batch["assignedCount"].toInt();
+        int handled = batch["handledCount"].toInt();
+        assignedCount += assigned;
+        queueEmpty = batch["queueEmpty"].toBool();
+        spacesExhausted = batch["spacesExhausted"].toBool();
+
+        // 自适应批次：批次跑满且耗时低于目标则放大，超出目标则缩小
+        {
+            QMutexLocker locker(&m_signalMutex);
+            if (elapsed > TARGET_BATCH_MS) {
+                m_batchSize = qMax(MIN_BATCH_SIZE, m_batchSize / 2);
+            } else if (handled >= batchSize) {
+                m_batchSize = qMin(MAX_BATCH_SIZE, m_batchSize * 2);
+            }
+        }
+
+        if (handled == 0 || !batch["hasMore"].toBool()) {
+            break;
+        }
+    }
+
+    if (queueEmpty || spacesExhausted) {
+        // 没有车辆在等待，或释放的车位已被占用（包括非排队车辆直接停入），剩余的释放事件不再计入分配延迟
+        QMutexLocker locker(&m_signalMutex);
+        m_releaseTimes.clear();
+    }
+
+    result["assignedCount"] = assignedCount;
+    result["batches"] = batches;
+    result["message"] = QString("Assigned %1 spaces to queued vehicles").arg(assignedCount);
+    return result;
+}
+
+QJsonObject QueueProcessor::processQueueLogic(int maxBatch)
+{
+    QJsonObject result;
+    int assignedCount = 0;
+    int handledCount = 0;
+    int removedCount = 0;
+
     try {
         // 获取所有排队车辆
         QList<QueueItem> queueItems = QueueRepository::instance().findAll();
         if (queueItems.isEmpty()) {
             result["assignedCount"] = 0;
+            result["handledCount"] = 0;
+            result["queueEmpty"] = true;
+            result["hasMore"] = false;
             result["message"] = "No vehicles in queue";
             return result;
         }
-        
+
         // 获取可用车位
         QList<ParkingSpace> availableSpaces = SpaceRepository::instance().findAvailableSpaces();
         if (availableSpaces.isEmpty()) {
             result["assignedCount"] = 0;
+            result["handledCount"] = 0;
+            result["hasMore"] = false;
+            result["spacesExhausted"] = true;
             result["message"] = "No available spaces";
             return result;
         }
-        
-        Logger::info(QString("Processing queue: %1 vehicles, %2 available spaces")
-                    .arg(queueItems.size()).arg(availableSpaces.size()));
-        
-        // 为排队车辆分配车位，限制每次处理的数量避免阻塞
-        int maxProcessBatch = 10; // 每次最多处理10辆车
-        int spacesToAssign = qMin(qMin(queueItems.size(), availableSpaces.size()), maxProcessBatch);
-        
-        for (int i = 0; i < spacesToAssign; ++i) {
+
+        Logger::info(QString("Processing queue: %1 vehicles, %2 available spaces, batch %3")
+                    .arg(queueItems.size()).arg(availableSpaces.size()).arg(maxBatch));
+
+        int spacesToAssign = qMin(qMin(queueItems.size(), availableSpaces.size()), maxBatch);
+        int spaceIndex = 0;
+
+        for (int i = 0; i < spacesToAssign && spaceIndex < availableSpaces.size(); ++i) {
             QueueItem queueItem = queueItems[i];
-            ParkingSpace space = availableSpaces[i];
-            
+            ParkingSpace space = availableSpaces[spaceIndex];
+            handledCount++;
+
             try {
-                // 检查车辆是否还在停车
-                QList<ParkingRecord> activeRecords = ParkingRecordRepository::instance().findActiveByPlate(queueItem.plate);
-                if (!activeRecords.isEmpty()) {
-                    Logger::info(QString("Vehicle %1 already parking, removing from queue").arg(queueItem.plate));
-                    QueueRepository::instance().remove(queueItem.plate);
-                    continue;
-                }
-                
-                // 占用车位
-                if (SpaceRepository::instance().occupySpace(space.getId(), queueItem.plate)) {
-                    // 创建停车记录
-                    ParkingRecord record;
-                    record.setPlate(queueItem.plate);
-                    record.setSpaceId(space.getId());
-                    record.setEnterTime(QDateTime::currentDateTime());
-                    record.setIsPaid(false);
-                    
-                    if (ParkingRecordRepository::instance().insert(record)) {
-                        assignedCount++;
+                ParkingRecord started;   // 分配成功的停车记录，释放门闸锁后再通知
+                {
+                    GateLocker gateLocker(space.getId(), queueItem.plate);
+
+                    // 加锁后确认车位仍然空闲，否则换下一个车位重试当前车辆
+                    if (SpaceRepository::instance().findById(space.getId()).getStatus() != ParkingSpace::AVAILABLE) {
+                        spaceIndex++;
+                        handledCount--;
+                        --i;
+                        continue;
+                    }
+
+                    // 检查车辆是否还在停车
+                    QList<ParkingRecord> activeRecords = ParkingRecordRepository::instance().findActiveByPlate(queueItem.plate);
+                    if (!activeRecords.isEmpty()) {
+                        Logger::info(QString("Vehicle %1 already parking, removing from queue").arg(queueItem.plate));
                         QueueRepository::instance().remove(queueItem.plate);
-                        Logger::info(QString("Assigned space %1 to vehicle %2 from queue")
-                                   .arg(space.getId()).arg(queueItem.plate));
+                        removedCount++;
+                        continue;
+                    }
+
+                    // 占用车位
+                    spaceIndex++;
+                    if (SpaceRepository::instance().occupySpace(space.getId(), queueItem.plate)) {
+                        // 创建停车记录
+                        ParkingRecord record;
+                        record.setPlate(queueItem.plate);
+                        record.setSpaceId(space.getId());
+                        record.setEnterTime(QDateTime::currentDateTime());
+                        record.setIsPaid(false);
+
+                        if (ParkingRecordRepository::instance().insert(record)) {
+                            started = record;
+                            assignedCount++;
+                            QueueRepository::instance().remove(queueItem.plate);
+                            recordAssignment();
+                            Logger::info(QString("Assigned space %1 to vehicle %2 from queue")
+                                       .arg(space.getId()).arg(queueItem.plate));
+                        } else {
+                            // 如果创建记录失败，释放车位
+                            SpaceRepository::instance().releaseSpace(space.getId());
+                            Logger::warning(QString("Failed to create parking record for vehicle %1").arg(queueItem.plate));
+                        }
                     } else {
-                        // 如果创建记录失败，释放车位
-                        SpaceRepository::instance().releaseSpace(space.getId());
-                        Logger::warning(QString("Failed to create parking record for vehicle %1").arg(queueItem.plate));
+                        Logger::warning(QString("Failed to occupy space %1 for vehicle %2").arg(space.getId()).arg(queueItem.plate));
                     }
-                } else {
-                    Logger::warning(QString("Failed to occupy space %1 for vehicle %2").arg(space.getId()).arg(queueItem.plate));
                 }
-                
+
+                // 信号的直连槽（响应缓存失效、车位 JSON 缓存）在当前线程同步执行，不在门闸锁内发出
+                if (started.getId() > 0) {
+                    BillingService::instance().notifyParkingStarted(started);
+                    SpaceService::instance().notifySpaceOccupied(started.getSpaceId(), started.getPlate());
+                }
+
             } catch (const std::exception& e) {
                 Logger::error(QString("Error assigning space to vehicle %1: %2").arg(queueItem.plate).arg(e.what()));
             }
         }
-        
+
         result["assignedCount"] = assignedCount;
+        result["handledCount"] = handledCount;
+        result["queueEmpty"] = assignedCount + removedCount >= queueItems.size();
+        result["hasMore"] = queueItems.size() > handledCount && availableSpaces.size() > spaceIndex;
+        result["spacesExhausted"] = spaceIndex >= availableSpaces.size();
         result["message"] = QString("Assigned %1 spaces to queued vehicles").arg(assignedCount);
-        
+
     } catch (const std::exception& e) {
         Logger::error(QString("Error in queue processing logic: %1").arg(e.what()));
         result["assignedCount"] = 0;
+        result["handledCount"] = 0;
+        result["hasMore"] = false;
         result["message"] = "Error processing queue";
         result["error"] = e.what();
     }
-    
+
     return result;
-}
\ No newline at end of file
+}
+
+void QueueProcessor::recordAssignment()
+{
+    QMutexLocker locker(&m_signalMutex);
+
+    m_assignedTotal++;
+    if (m_releaseTimes.isEmpty()) {
+        return;
+    }
+
+    qint64 latency = QDateTime::currentMSecsSinceEpoch() - m_releaseTimes.dequeue();
+    m_latencySamples++;
+    m_latencyTotalMs += latency;
+    m_latencyLastMs = latency;
+    m_latencyMaxMs = qMax(m_latencyMaxMs, latency);
+
+    Logger::debug(QString("Queue assignment latency: %1 ms").arg(latency));
+}
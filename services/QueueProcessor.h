@@ -5,6 +5,9 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QThread>
 
 class QueueProcessor : public QObject
 {
@@ -13,31 +16,74 @@ class QueueProcessor : public QObject
 public:
     static QueueProcessor& instance();
 
-    // 处理排队队列，为排队车辆分配可用车位
-    QJsonObject processQueueForAvailableSpaces();
-    
-    // 检查并处理队列（线程安全）
+    // 启动/停止调度线程
+    void start();
+    void stop();
+
+    // 通知调度线程有 count 个车位释放并记录释放时间（线程安全，立即返回）
+    void notifySpaceReleased(int count = 1);
+
+    // 唤醒调度线程检查队列，不计入释放延迟统计（线程安全，立即返回）
     void checkAndProcessQueue();
-    
-    // 强制处理队列（重置状态并立即处理）
+
+    // 强制处理队列（唤醒调度线程）
     void forceProcessQueue();
 
+    // 调度统计：从车位释放到车辆分配的延迟
+    QJsonObject getDispatchStatistics();
+
 signals:
     void queueProcessed(int assignedCount);
     void queueProcessError(const QString& error);
 
 private:
     QueueProcessor() = default;
+    ~QueueProcessor();
     QueueProcessor(const QueueProcessor&) = delete;
     QueueProcessor& operator=(const QueueProcessor&) = delete;
-    
-    // 实际的队列处理逻辑
-    QJsonObject processQueueLogic();
-    
-    bool m_processing = false;
-    QMutex m_mutex;
-    qint64 m_lastProcessTime = 0;  // 上次处理时间
-    static const int MIN_PROCESS_INTERVAL = 500; // 最小处理间隔（毫秒）
+
+    // 调度线程主循环
+    void dispatchLoop();
+
+    // 处理排队队列，为排队车辆分配可用车位（同步，直到队列或空闲车位耗尽）
+    // 只在调度线程上执行；其他线程经 notifySpaceReleased/checkAndProcessQueue 唤醒调度线程
+    QJsonObject processQueueForAvailableSpaces();
+
+    // 置位并唤醒调度线程；调用方需持有 m_signalMutex
+    void wakeDispatcherLocked();
+
+    // 排空队列：按自适应批次分配，直到队列或空闲车位为空
+    QJsonObject drainQueue();
+
+    // 实际的队列处理逻辑（处理一个批次）
+    QJsonObject processQueueLogic(int maxBatch);
+
+    // 记录一次分配的延迟
+    void recordAssignment();
+
+    QMutex m_mutex;                 // 串行化队列排空
+    QMutex m_signalMutex;           // 保护唤醒状态和统计
+    QWaitCondition m_wakeCondition;
+    QThread* m_dispatcherThread = nullptr;
+    bool m_pending = false;
+    bool m_stopping = false;
+
+    // 尚未被分配消费的车位释放时间戳（毫秒）
+    QQueue<qint64> m_releaseTimes;
+
+    // 自适应批次
+    int m_batchSize = MIN_BATCH_SIZE;
+    static const int MIN_BATCH_SIZE = 4;
+    static const int MAX_BATCH_SIZE = 256;
+    static const int TARGET_BATCH_MS = 50;  // 单批次目标耗时（毫秒）
+    static const int MAX_PENDING_RELEASES = 10000;
+
+    // 延迟统计
+    qint64 m_assignedTotal = 0;
+    qint64 m_latencySamples = 0;
+    qint64 m_latencyTotalMs = 0;
+    qint64 m_latencyMaxMs = 0;
+    qint64 m_latencyLastMs = 0;
 };
 
-#endif // QUEUEPROCESSOR_H
\ No newline at end of file
+#endif // QUEUEPROCESSOR_H
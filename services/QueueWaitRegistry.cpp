@@ -0,0 +1,270 @@
+#include "QueueWaitRegistry.h"
+#include "SpaceService.h"
+#include "QueueProcessor.h"
+#include "../core/HttpResponse.h"
+#include "../dao/QueueRepository.h"
+#include "../api/ApiResponse.h"
+#include "../utils/DataVersion.h"
+#include "../utils/Logger.h"
+#include <QTimer>
+#include <QDateTime>
+
+QueueWaitRegistry& QueueWaitRegistry::instance()
+{
+    static QueueWaitRegistry instance;
+    return instance;
+}
+
+QueueWaitRegistry::QueueWaitRegistry()
+{
+    m_sweepTimer = new QTimer(this);
+    m_sweepTimer->setInterval(SWEEP_INTERVAL_MS);
+    connect(m_sweepTimer, &QTimer::timeout, this, &QueueWaitRegistry::sweepExpired);
+}
+
+void QueueWaitRegistry::attach()
+{
+    // 以 this 为上下文连接：其他线程发出的信号排队到本对象所在线程
+    SpaceService& spaceService = SpaceService::instance();
+    connect(&spaceService, &SpaceService::spaceOccupied, this, [this](int id, const QString& plate) {
+        onAssigned(id, plate);
+        scheduleRefresh();
+    });
+    connect(&spaceService, &SpaceService::queueJoined, this, [this](const QString&) {
+        scheduleRefresh();
+    });
+    connect(&QueueProcessor::instance(), &QueueProcessor::queueProcessed, this, [this](int) {
+        scheduleRefresh();
+    });
+}
+
+void QueueWaitRegistry::wait(const QString& plate, quint64 since, int timeoutMs, HttpResponse& response)
+{
+    PlateId id = PlateId::fromString(plate);
+    if (!id.isValid()) {
+        // 无法紧凑编码的特殊车牌不挂起，直接返回当前位置
+        PlateState state;
+        state.position = qMax(0, QueueRepository::instance().getPosition(plate));
+        state.version = DataVersion::instance().current();
+        response.ok(ApiResponse::success(stateJson(plate, state, true)));
+        return;
+    }
+
+    ensureFresh();
+
+    PlateState state = m_states.value(id);
+    if (since == 0 || state.version > since) {
+        response.ok(ApiResponse::success(stateJson(plate, state, true)));
+        return;
+    }
+
+    if (m_waiterCount >= MAX_WAITERS) {
+        response.serverError("Too many waiting requests");
+        response.setStatusCode(503);
+        response.setHeader("Retry-After", "5");
+        return;
+    }
+
+    Waiter waiter;
+    waiter.handle = std::make_shared<DeferredResponse>();
+    waiter.since = since;
+    waiter.deadline = QDateTime::currentMSecsSinceEpoch() + timeoutMs;
+    m_waiters[id].append(waiter);
+    m_waiterCount++;
+
+    if (!m_sweepTimer->isActive()) {
+        m_sweepTimer->start();
+    }
+
+    response.defer(waiter.handle);
+}
+
+void QueueWaitRegistry::ensureFresh()
+{
+    if (!m_loaded || QueueRepository::instance().version() != m_queueVersion) {
+        refresh();
+    }
+}
+
+void QueueWaitRegistry::refresh()
+{
+    // 先取写入计数：读取期间的写入会让下次检查重新读取
+    m_queueVersion = QueueRepository::instance().version();
+    QList<QueueItem> items = QueueRepository::instance().findAll();
+    m_loaded = true;
+    m_queueLength = items.size();
+
+    quint64 version = DataVersion::instance().current();
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVector<PlateId> changed;
+
+    QHash<PlateId, int> positions;
+    positions.reserve(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        PlateId id = PlateId::fromString(items[i].plate);
+        if (id.isValid()) {
+            positions.insert(id, i + 1);
+        }
+    }
+
+    for (auto it = m_states.begin(); it != m_states.end();) {
+        int position = positions.value(it.key(), 0);
+        if (position != it->position) {
+            if (position > 0) {
+                it->spaceId = 0;      // 重新排队，之前的分配结果作废
+            } else {
+                it->leftAt = now;
+            }
+            it->position = position;
+            it->version = version;
+            changed.append(it.key());
+        }
+
+        if (it->position == 0 && now - it->leftAt > RETENTION_MS && !m_waiters.contains(it.key())) {
+            it = m_states.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = positions.constBegin(); it != positions.constEnd(); ++it) {
+        if (!m_states.contains(it.key())) {
+            PlateState state;
+            state.position = it.value();
+            state.version = version;
+            m_states.insert(it.key(), state);
+            changed.append(it.key());
+        }
+    }
+
+    wakeWaiters(changed);
+}
+
+void QueueWaitRegistry::onAssigned(int spaceId, const QString& plate)
+{
+    PlateId id = PlateId::fromString(plate);
+    // 只跟踪排过队或正在等待的车牌，直接入场的车辆不占用内存
+    if (!id.isValid() || (!m_states.contains(id) && !m_waiters.contains(id))) {
+        return;
+    }
+
+    PlateState& state = m_states[id];
+    state.position = 0;
+    state.spaceId = spaceId;
+    state.version = DataVersion::instance().current();
+    state.leftAt = QDateTime::currentMSecsSinceEpoch();
+
+    wakeWaiters(QVector<PlateId>() << id);
+}
+
+void QueueWaitRegistry::scheduleRefresh()
+{
+    // 没有挂起的请求时不读队列，下次轮询按写入计数判断是否需要重读
+    if (m_waiterCount == 0 || m_refreshPending) {
+        return;
+    }
+    m_refreshPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_refreshPending = false;
+        if (m_waiterCount > 0) {
+            ensureFresh();
+        }
+    });
+}
+
+template <typename Predicate>
+bool QueueWaitRegistry::takeWaiters(QHash<PlateId, QVector<Waiter>>::iterator it, Predicate done,
+                                    bool changed, QVector<Ready>& ready)
+{
+    QVector<Waiter>& waiters = it.value();
+    for (int i = waiters.size() - 1; i >= 0; --i) {
+        if (!done(waiters[i])) {
+            continue;
+        }
+        Ready entry;
+        entry.handle = waiters[i].handle;
+        entry.plate = it.key();
+        entry.changed = changed;
+        ready.append(entry);
+        waiters.remove(i);
+        m_waiterCount--;
+    }
+    return waiters.isEmpty();
+}
+
+void QueueWaitRegistry::wakeWaiters(const QVector<PlateId>& plates)
+{
+    QVector<Ready> ready;
+    for (const PlateId& id : plates) {
+        auto it = m_waiters.find(id);
+        if (it == m_waiters.end()) {
+            continue;
+        }
+
+        const quint64 version = m_states.value(id).version;
+        if (takeWaiters(it, [version](const Waiter& waiter) {
+                return !waiter.handle->isPending() || version > waiter.since;
+            }, true, ready)) {
+            m_waiters.erase(it);
+        }
+    }
+    respondAll(ready);
+}
+
+void QueueWaitRegistry::sweepExpired()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVector<Ready> ready;
+
+    for (auto it = m_waiters.begin(); it != m_waiters.end();) {
+        // 超时：返回当前状态，changed 为 false，客户端用同一个 since 重新等待
+        if (takeWaiters(it, [now](const Waiter& waiter) {
+                return !waiter.handle->isPending() || waiter.deadline <= now;
+            }, false, ready)) {
+            it = m_waiters.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    respondAll(ready);
+}
+
+void QueueWaitRegistry::respondAll(const QVector<Ready>& ready)
+{
+    if (m_waiterCount == 0) {
+        m_sweepTimer->stop();
+    }
+
+    // 等待表整理完毕后再发送：发送时可能处理同一连接上的下一个请求并重新挂起
+    for (const Ready& entry : ready) {
+        respond(entry.handle, entry.plate.toString(), m_states.value(entry.plate), entry.changed);
+    }
+}
+
+QJsonObject QueueWaitRegistry::stateJson(const QString& plate, const PlateState& state, bool changed) const
+{
+    QJsonObject data;
+    data["plate"] = plate;
+    data["position"] = state.position;
+    data["queueLength"] = m_queueLength;
+    data["assigned"] = state.spaceId > 0;
+    if (state.spaceId > 0) {
+        data["spaceId"] = state.spaceId;
+    }
+    data["version"] = static_cast<qint64>(state.version);
+    data["changed"] = changed;
+    return data;
+}
+
+void QueueWaitRegistry::respond(const std::shared_ptr<DeferredResponse>& handle, const QString& plate,
+                                const PlateState& state, bool changed)
+{
+    // 连接已断开的句柄直接丢弃
+    if (!handle->isPending()) {
+        return;
+    }
+
+    HttpResponse response;
+    response.ok(ApiResponse::success(stateJson(plate, state, changed)));
+    handle->complete(response);
+}
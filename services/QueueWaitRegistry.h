@@ -0,0 +1,94 @@
+#ifndef QUEUEWAITREGISTRY_H
+#define QUEUEWAITREGISTRY_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QJsonObject>
+#include <memory>
+#include "../core/DeferredResponse.h"
+#include "../utils/PlateId.h"
+
+class HttpResponse;
+class QTimer;
+
+// 排队位置长轮询：按车牌挂起请求，位置或分配结果变化时完成
+// 排队位置由一次全表读取统一计算后缓存，轮询本身不再逐个调用 getPosition
+// 对象位于主线程，调度线程发出的信号经排队连接转到主线程处理
+class QueueWaitRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    static QueueWaitRegistry& instance();
+
+    // 连接排队相关信号
+    void attach();
+
+    // since 为 0 或该车牌在 since 之后有变化时立即响应，否则挂起到变化或超时
+    void wait(const QString& plate, quint64 since, int timeoutMs, HttpResponse& response);
+
+    int waiterCount() const { return m_waiterCount; }
+
+    static const int DEFAULT_TIMEOUT_MS = 25000;
+    static const int MAX_TIMEOUT_MS = 60000;
+
+private:
+    struct PlateState {
+        int position = 0;       // 0 表示不在队列中
+        int spaceId = 0;        // 离开队列时分配到的车位
+        quint64 version = 0;    // 最近一次变化时的全局数据版本
+        qint64 leftAt = 0;      // 离开队列的时间（毫秒）
+    };
+
+    struct Waiter {
+        std::shared_ptr<DeferredResponse> handle;
+        quint64 since;
+        qint64 deadline;
+    };
+
+    // 已从等待表取出、待发送的响应
+    struct Ready {
+        std::shared_ptr<DeferredResponse> handle;
+        PlateId plate;
+        bool changed;
+    };
+
+    QueueWaitRegistry();
+    QueueWaitRegistry(const QueueWaitRegistry&) = delete;
+    QueueWaitRegistry& operator=(const QueueWaitRegistry&) = delete;
+
+    // 队列写入计数变化时重读一次队列
+    void ensureFresh();
+    void refresh();
+
+    void onAssigned(int spaceId, const QString& plate);
+    void scheduleRefresh();
+    void wakeWaiters(const QVector<PlateId>& plates);
+    void sweepExpired();
+
+    // 从车牌的等待列表取出满足条件的等待者，列表取空时返回 true（由调用方删除该车牌）
+    template <typename Predicate>
+    bool takeWaiters(QHash<PlateId, QVector<Waiter>>::iterator it, Predicate done,
+                     bool changed, QVector<Ready>& ready);
+    void respondAll(const QVector<Ready>& ready);
+
+    QJsonObject stateJson(const QString& plate, const PlateState& state, bool changed) const;
+    void respond(const std::shared_ptr<DeferredResponse>& handle, const QString& plate,
+                 const PlateState& state, bool changed);
+
+    QHash<PlateId, PlateState> m_states;          // 队列中及最近离开队列的车牌
+    QHash<PlateId, QVector<Waiter>> m_waiters;
+    int m_waiterCount = 0;
+    int m_queueLength = 0;
+    quint64 m_queueVersion = 0;
+    bool m_loaded = false;
+    bool m_refreshPending = false;
+    QTimer* m_sweepTimer;
+
+    static const int SWEEP_INTERVAL_MS = 1000;
+    static const int MAX_WAITERS = 10000;
+    static const qint64 RETENTION_MS = 5 * 60 * 1000;   // 离开队列的车牌保留多久，供稍后轮询取到分配结果
+};
+
+#endif // QUEUEWAITREGISTRY_H
@@ -0,0 +1,160 @@
+#include "ReportExecutor.h"
+#include "../utils/Logger.h"
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <memory>
+
+// 一次并行执行的共享状态；调用方超时返回后，仍在运行的子报表继续持有它
+struct ReportExecutor::FanOut {
+    QMutex mutex;
+    QWaitCondition done;
+    int remaining = 0;
+    QVector<bool> finished;
+    QVector<bool> succeeded;
+    QVector<QJsonValue> values;
+    QVector<qint64> elapsed;
+    QVector<QString> errors;
+    Cancellation cancellation;
+};
+
+ReportExecutor& ReportExecutor::instance()
+{
+    static ReportExecutor instance;
+    return instance;
+}
+
+ReportExecutor::ReportExecutor()
+{
+    m_pool.setMaxThreadCount(MAX_THREADS);
+    m_pool.setObjectName("ReportExecutor");
+}
+
+ReportExecutor::Outcome ReportExecutor::run(const TaskList& tasks, int deadlineMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto state = std::make_shared<FanOut>();
+    int count = tasks.size();
+    state->remaining = count;
+    state->finished.fill(false, count);
+    state->succeeded.fill(false, count);
+    state->values.resize(count);
+    state->elapsed.fill(0, count);
+    state->errors.resize(count);
+
+    Outcome outcome;
+    {
+        // 提交的子报表都能立即拿到线程时才执行；超时后尚未结束的子报表仍占用线程，
+        // 持续过载时在这里拒绝，而不是排队到已经过期的截止时间之后
+        QMutexLocker admission(&m_admissionMutex);
+        if (m_pool.activeThreadCount() + count > m_pool.maxThreadCount()) {
+            outcome.rejected = true;
+            outcome.elapsedMs = timer.elapsed();
+            m_rejected.fetchAndAddRelaxed(1);
+            Logger::warning(QString("Composite report rejected: %1 of %2 report threads busy")
+                           .arg(m_pool.activeThreadCount()).arg(m_pool.maxThreadCount()));
+            return outcome;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            submit(state, tasks[i].second, i);
+        }
+    }
+
+    {
+        QMutexLocker locker(&state->mutex);
+        while (state->remaining > 0) {
+            qint64 left = deadlineMs - timer.elapsed();
+            if (left <= 0) {
+                break;
+            }
+            state->done.wait(&state->mutex, static_cast<unsigned long>(left));
+        }
+        if (state->remaining > 0) {
+            // 结果不再被使用，通知仍在运行的子报表尽早结束
+            state->cancellation.m_flag->storeRelease(1);
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const QString& name = tasks[i].first;
+            if (!state->finished[i]) {
+                outcome.timedOut.append(name);
+            } else if (!state->succeeded[i]) {
+                outcome.failed.append(name);
+                Logger::error(QString("Sub-report %1 failed: %2").arg(name, state->errors[i]));
+            } else {
+                outcome.results[name] = state->values[i];
+                outcome.timings[name] = state->elapsed[i];
+            }
+        }
+    }
+    outcome.elapsedMs = timer.elapsed();
+
+    if (!outcome.timedOut.isEmpty()) {
+        Logger::warning(QString("Composite report deadline %1 ms exceeded, %2 sub-reports timed out")
+                       .arg(deadlineMs).arg(outcome.timedOut.size()));
+    }
+
+    m_runs.fetchAndAddRelaxed(1);
+    m_tasks.fetchAndAddRelaxed(count);
+    m_timedOut.fetchAndAddRelaxed(outcome.timedOut.size());
+    m_failed.fetchAndAddRelaxed(outcome.failed.size());
+    qint64 previous = m_maxElapsedMs.loadAcquire();
+    while (outcome.elapsedMs > previous && !m_maxElapsedMs.testAndSetOrdered(previous, outcome.elapsedMs)) {
+        previous = m_maxElapsedMs.loadAcquire();
+    }
+
+    return outcome;
+}
+
+void ReportExecutor::submit(const std::shared_ptr<FanOut>& state, const Task& task, int index)
+{
+    QtConcurrent::run(&m_pool, [this, state, task, index]() {
+        QElapsedTimer taskTimer;
+        taskTimer.start();
+
+        QJsonValue value;
+        QString error;
+        bool ok = false;
+        try {
+            // 开始前调用方可能已超时返回
+            state->cancellation.throwIfCancelled();
+            value = task(state->cancellation);
+            ok = true;
+        } catch (const Cancelled& e) {
+            error = e.what();
+            m_cancelled.fetchAndAddRelaxed(1);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        QMutexLocker locker(&state->mutex);
+        state->finished[index] = true;
+        state->succeeded[index] = ok;
+        state->values[index] = value;
+        state->elapsed[index] = taskTimer.elapsed();
+        state->errors[index] = error;
+        if (--state->remaining == 0) {
+            state->done.wakeAll();
+        }
+    });
+}
+
+QJsonObject ReportExecutor::statistics() const
+{
+    QJsonObject stats;
+    stats["runs"] = m_runs.loadAcquire();
+    stats["tasks"] = m_tasks.loadAcquire();
+    stats["timedOut"] = m_timedOut.loadAcquire();
+    stats["cancelled"] = m_cancelled.loadAcquire();
+    stats["failed"] = m_failed.loadAcquire();
+    stats["rejected"] = m_rejected.loadAcquire();
+    stats["maxElapsedMs"] = m_maxElapsedMs.loadAcquire();
+    stats["activeThreads"] = m_pool.activeThreadCount();
+    stats["maxThreads"] = m_pool.maxThreadCount();
+    return stats;
+}
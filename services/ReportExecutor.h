@@ -0,0 +1,93 @@
+#ifndef REPORTEXECUTOR_H
+#define REPORTEXECUTOR_H
+
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QString>
+#include <QVector>
+#include <QPair>
+#include <QThreadPool>
+#include <QAtomicInteger>
+#include <QMutex>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+// 组合报表的子报表并行执行器：独立线程池，与请求合并使用的全局线程池互不占用
+// 每个子报表在自己的线程上经仓储打开独立的只读连接；调用方阻塞等待，直到全部完成或到达截止时间
+// 到达截止时间后置位取消标记，子报表在两次查询之间检查并提前结束，结果丢弃
+// 线程池剩余线程不足以让全部子报表立即开始时拒绝执行，调用方立即得到结果，不排队
+class ReportExecutor
+{
+public:
+    // 子报表检查到取消时抛出
+    class Cancelled : public std::runtime_error
+    {
+    public:
+        Cancelled() : std::runtime_error("Sub-report cancelled") {}
+    };
+
+    // 一次执行的取消标记，传给每个子报表
+    class Cancellation
+    {
+    public:
+        bool isCancelled() const { return m_flag->loadAcquire() != 0; }
+        // 已取消时抛出 Cancelled；子报表在两次查询之间调用
+        void throwIfCancelled() const { if (isCancelled()) throw Cancelled(); }
+
+    private:
+        friend class ReportExecutor;
+        std::shared_ptr<QAtomicInt> m_flag = std::make_shared<QAtomicInt>(0);
+    };
+
+    // 子报表：返回该部分的 JSON，失败时抛出异常
+    typedef std::function<QJsonValue(const Cancellation&)> Task;
+    typedef QVector<QPair<QString, Task>> TaskList;
+
+    struct Outcome {
+        QJsonObject results;     // 按名称，只含按时成功完成的子报表
+        QJsonArray timedOut;     // 截止时间内未完成
+        QJsonArray failed;       // 抛出异常
+        QJsonObject timings;     // 已完成子报表的耗时（毫秒）
+        qint64 elapsedMs = 0;
+        bool rejected = false;   // 线程池已满，没有执行任何子报表
+
+        bool isPartial() const { return !timedOut.isEmpty() || !failed.isEmpty(); }
+    };
+
+    static ReportExecutor& instance();
+
+    // 并行执行 tasks，最多等待 deadlineMs 毫秒（从提交时算起，每个子报表相同）
+    Outcome run(const TaskList& tasks, int deadlineMs);
+
+    // 执行次数、超时、取消和失败的子报表数，被拒绝的执行次数
+    QJsonObject statistics() const;
+
+    static const int DEFAULT_DEADLINE_MS = 5000;
+    static const int MAX_DEADLINE_MS = 30000;
+    static const int MAX_THREADS = 12;   // 两个组合报表可同时全部并行
+
+private:
+    struct FanOut;
+
+    ReportExecutor();
+    ReportExecutor(const ReportExecutor&) = delete;
+    ReportExecutor& operator=(const ReportExecutor&) = delete;
+
+    // 在线程池上执行第 index 个子报表，结束时写回 state
+    void submit(const std::shared_ptr<FanOut>& state, const Task& task, int index);
+
+    QThreadPool m_pool;
+    QMutex m_admissionMutex;   // 串行化“检查空闲线程 + 提交”，并发的执行不会同时通过检查
+
+    QAtomicInteger<qint64> m_runs;
+    QAtomicInteger<qint64> m_tasks;
+    QAtomicInteger<qint64> m_timedOut;
+    QAtomicInteger<qint64> m_cancelled;
+    QAtomicInteger<qint64> m_failed;
+    QAtomicInteger<qint64> m_rejected;
+    QAtomicInteger<qint64> m_maxElapsedMs;
+};
+
+#endif // REPORTEXECUTOR_H
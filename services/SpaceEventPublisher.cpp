@@ -0,0 +1,178 @@
+#include "SpaceEventPublisher.h"
+#include "SpaceService.h"
+#include "QueueProcessor.h"
+#include "../core/JsonWriter.h"
+#include "../dao/QueueRepository.h"
+#include "../dao/SpaceRepository.h"
+#include "../utils/DataVersion.h"
+#include "../utils/PlateValidator.h"
+#include "../utils/Logger.h"
+#include <QTimer>
+
+SpaceEventPublisher& SpaceEventPublisher::instance()
+{
+    static SpaceEventPublisher instance;
+    return instance;
+}
+
+void SpaceEventPublisher::attach(EventStreamHub* hub)
+{
+    if (m_hub) {
+        return;
+    }
+    m_hub = hub;
+    m_hub->setSnapshotProvider([this](QString& channel, EventStreamHub::Snapshot& snapshot) {
+        return this->snapshot(channel, snapshot);
+    });
+
+    // 以 this 为上下文连接：其他线程发出的信号排队到本对象所在线程
+    SpaceService& spaceService = SpaceService::instance();
+    connect(&spaceService, &SpaceService::spaceAdded, this, [this](int id) {
+        publishSpaceEvent("added", id);
+    });
+    connect(&spaceService, &SpaceService::spaceUpdated, this, [this](int id) {
+        publishSpaceEvent("updated", id);
+    });
+    connect(&spaceService, &SpaceService::spaceDeleted, this, [this](int id) {
+        publishSpaceEvent("deleted", id);
+    });
+    connect(&spaceService, &SpaceService::spaceReleased, this, [this](int id) {
+        publishSpaceEvent("released", id, "available");
+    });
+    connect(&spaceService, &SpaceService::spaceOccupied, this, [this](int id, const QString& plate) {
+        publishSpaceEvent("occupied", id, "occupied");
+        publishAssignment(id, plate);
+        scheduleQueueRefresh();
+    });
+    connect(&spaceService, &SpaceService::queueJoined, this, [this](const QString&) {
+        scheduleQueueRefresh();
+    });
+    connect(&QueueProcessor::instance(), &QueueProcessor::queueProcessed, this, [this](int) {
+        scheduleQueueRefresh();
+    });
+
+    Logger::info("Space event publisher attached");
+}
+
+bool SpaceEventPublisher::snapshot(QString& channel, EventStreamHub::Snapshot& snapshot)
+{
+    // 先取版本号：快照之后的变化一定带有更大的事件 id
+    snapshot.id = DataVersion::instance().current();
+
+    if (channel == spacesChannel()) {
+        QByteArray data;
+        JsonWriter writer(data);
+        writer.beginObject();
+        writer.field("available", SpaceRepository::instance().countAvailable());
+        writer.field("occupied", SpaceRepository::instance().countOccupied());
+        writer.endObject();
+
+        snapshot.event = "ready";
+        snapshot.data = data;
+        return true;
+    }
+
+    const QString prefix = queueChannel(QString());
+    if (channel.startsWith(prefix)) {
+        QString plate = PlateValidator::normalize(channel.mid(prefix.size()));
+        if (!PlateValidator::isValid(plate)) {
+            return false;
+        }
+
+        int position = qMax(0, QueueRepository::instance().getPosition(plate));
+        int queueLength = QueueRepository::instance().count();
+        m_lastPositions.insert(plate, position);
+
+        channel = queueChannel(plate);
+        snapshot.event = "position";
+        snapshot.data = encodePosition(plate, position, queueLength);
+        return true;
+    }
+
+    return false;
+}
+
+void SpaceEventPublisher::publishSpaceEvent(const QByteArray& event, int spaceId, const char* status)
+{
+    QByteArray data;
+    JsonWriter writer(data);
+    writer.beginObject();
+    writer.field("id", spaceId);
+    if (status) {
+        writer.field("status", status);
+    }
+    writer.endObject();
+
+    m_hub->publish(spacesChannel(), event, data, DataVersion::instance().current());
+}
+
+void SpaceEventPublisher::publishAssignment(int spaceId, const QString& plate)
+{
+    QString channel = queueChannel(plate);
+    QByteArray data;
+    JsonWriter writer(data);
+    writer.beginObject();
+    writer.field("plate", plate);
+    writer.field("spaceId", spaceId);
+    writer.endObject();
+
+    m_hub->publish(channel, "assigned", data, DataVersion::instance().current());
+    m_lastPositions.insert(plate, 0);
+}
+
+void SpaceEventPublisher::scheduleQueueRefresh()
+{
+    if (m_queueRefreshPending) {
+        return;
+    }
+    m_queueRefreshPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_queueRefreshPending = false;
+        refreshQueuePositions();
+    });
+}
+
+void SpaceEventPublisher::refreshQueuePositions()
+{
+    const QString prefix = queueChannel(QString());
+    QStringList channels = m_hub->channels(prefix);
+    if (channels.isEmpty()) {
+        m_lastPositions.clear();
+        return;
+    }
+
+    // 整个队列读取一次，为所有订阅车牌计算位置
+    QList<QueueItem> items = QueueRepository::instance().findAll();
+    QHash<QString, int> positions;
+    positions.reserve(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        positions.insert(items[i].plate, i + 1);
+    }
+
+    QHash<QString, int> current;
+    quint64 version = DataVersion::instance().current();
+    for (const QString& channel : channels) {
+        QString plate = channel.mid(prefix.size());
+        int position = positions.value(plate, 0);
+        current.insert(plate, position);
+
+        if (m_lastPositions.value(plate, -1) != position) {
+            m_hub->publish(channel, "position", encodePosition(plate, position, items.size()), version);
+        }
+    }
+
+    // 只保留仍有订阅者的车牌
+    m_lastPositions = current;
+}
+
+QByteArray SpaceEventPublisher::encodePosition(const QString& plate, int position, int queueLength)
+{
+    QByteArray data;
+    JsonWriter writer(data);
+    writer.beginObject();
+    writer.field("plate", plate);
+    writer.field("position", position);
+    writer.field("queueLength", queueLength);
+    writer.endObject();
+    return data;
+}
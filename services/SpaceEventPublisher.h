@@ -0,0 +1,48 @@
+#ifndef SPACEEVENTPUBLISHER_H
+#define SPACEEVENTPUBLISHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include "../core/EventStreamHub.h"
+
+// 把车位和排队的领域信号转换为 SSE 增量事件
+// 频道：spaces（所有车位变化）、queue:<车牌>（该车辆的排队位置和分配结果）
+// 对象位于主线程，调度线程发出的信号经排队连接转到主线程处理
+class SpaceEventPublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SpaceEventPublisher& instance();
+
+    // 连接领域信号，之后的事件推送到 hub
+    void attach(EventStreamHub* hub);
+
+    static QString spacesChannel() { return QStringLiteral("spaces"); }
+    static QString queueChannel(const QString& plate) { return QStringLiteral("queue:") + plate; }
+
+    // 校验并规范化频道名（queue: 后的车牌按规范格式），返回新订阅者的初始事件
+    // spaces 为 ready 摘要，queue:<车牌> 为当前排队位置
+    bool snapshot(QString& channel, EventStreamHub::Snapshot& snapshot);
+
+private:
+    SpaceEventPublisher() = default;
+    SpaceEventPublisher(const SpaceEventPublisher&) = delete;
+    SpaceEventPublisher& operator=(const SpaceEventPublisher&) = delete;
+
+    void publishSpaceEvent(const QByteArray& event, int spaceId, const char* status = nullptr);
+    void publishAssignment(int spaceId, const QString& plate);
+
+    // 同一轮事件循环内的多次排队变化合并为一次重算
+    void scheduleQueueRefresh();
+    void refreshQueuePositions();
+    static QByteArray encodePosition(const QString& plate, int position, int queueLength);
+
+    EventStreamHub* m_hub = nullptr;
+    bool m_queueRefreshPending = false;
+    QHash<QString, int> m_lastPositions;   // 每个被订阅车牌最近一次推送的位置
+};
+
+#endif // SPACEEVENTPUBLISHER_H
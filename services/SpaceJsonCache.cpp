@@ -0,0 +1,61 @@
+#include "SpaceJsonCache.h"
+#include "SpaceService.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+
+SpaceJsonCache& SpaceJsonCache::instance()
+{
+    static SpaceJsonCache instance;
+    return instance;
+}
+
+SpaceJsonCache::SpaceJsonCache()
+{
+    // 直接连接：在发出信号的线程内同步失效，调度线程发出的信号同样生效
+    SpaceService& spaceService = SpaceService::instance();
+    QObject::connect(&spaceService, &SpaceService::spaceUpdated, [this](int id) { invalidate(id); });
+    QObject::connect(&spaceService, &SpaceService::spaceDeleted, [this](int id) { invalidate(id); });
+    QObject::connect(&spaceService, &SpaceService::spaceReleased, [this](int id) { invalidate(id); });
+    QObject::connect(&spaceService, &SpaceService::spaceOccupied,
+                     [this](int id, const QString&) { invalidate(id); });
+}
+
+bool SpaceJsonCache::lookup(int spaceId, int version, QByteArray& bytes) const
+{
+    QReadLocker locker(&m_lock);
+    auto it = m_entries.constFind(spaceId);
+    if (it == m_entries.constEnd() || it->version != version) {
+        return false;
+    }
+    bytes = it->bytes;
+    return true;
+}
+
+void SpaceJsonCache::store(int spaceId, int version, const QByteArray& bytes)
+{
+    QWriteLocker locker(&m_lock);
+    auto it = m_entries.find(spaceId);
+    // 并发编码时保留版本较新的片段
+    if (it != m_entries.end() && it->version > version) {
+        return;
+    }
+    m_entries.insert(spaceId, Entry{version, bytes});
+}
+
+void SpaceJsonCache::invalidate(int spaceId)
+{
+    QWriteLocker locker(&m_lock);
+    m_entries.remove(spaceId);
+}
+
+void SpaceJsonCache::clear()
+{
+    QWriteLocker locker(&m_lock);
+    m_entries.clear();
+}
+
+int SpaceJsonCache::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_entries.size();
+}
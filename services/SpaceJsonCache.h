@@ -0,0 +1,38 @@
+#ifndef SPACEJSONCACHE_H
+#define SPACEJSONCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+
+// 每个车位已编码的 JSON 片段（UTF-8，紧凑格式）
+// 以车位ID + 行版本为键；车位变更信号到达时丢弃对应片段
+class SpaceJsonCache
+{
+public:
+    static SpaceJsonCache& instance();
+
+    // 命中时写入 bytes 并返回 true
+    bool lookup(int spaceId, int version, QByteArray& bytes) const;
+    void store(int spaceId, int version, const QByteArray& bytes);
+
+    void invalidate(int spaceId);
+    void clear();
+
+    int size() const;
+
+private:
+    SpaceJsonCache();
+    SpaceJsonCache(const SpaceJsonCache&) = delete;
+    SpaceJsonCache& operator=(const SpaceJsonCache&) = delete;
+
+    struct Entry {
+        int version;
+        QByteArray bytes;
+    };
+
+    mutable QReadWriteLock m_lock;
+    QHash<int, Entry> m_entries;
+};
+
+#endif // SPACEJSONCACHE_H
@@ -1,12 +1,15 @@
 #include "SpaceService.h"
 #include "../api/ApiResponse.h"
 #include "../utils/Logger.h"
+#include "../utils/PlateValidator.h"
+#include "../utils/GateLock.h"
 #include "../dao/SpaceRepository.h"
 #include "../dao/ParkingRecordRepository.h"
 #include "../dao/QueueRepository.h"
 #include "../services/BillingService.h"
 #include "../services/QueueProcessor.h"
-#include <QRegularExpression>
+#include "../services/SpaceJsonCache.h"
+#include <QJsonDocument>
 
 SpaceService& SpaceService::instance()
 {
@@ -38,6 +41,7 @@ QJsonObject SpaceService::addSpace(const QString& location, const QString& type,
         // No setCreatedAt, assuming it's set in repository
         
         if (SpaceRepository::instance().insert(space)) {
+            emit spaceAdded(space.getId());
             return ApiResponse::success("Space added", spaceToJson(space));
         } else {
             return ApiResponse::error("Failed to add space");
@@ -63,16 +67,39 @@ QJsonObject SpaceService::updateSpace(int id, const QString& location, const QSt
             return ApiResponse::error("Invalid rate");
         }
         
-        ParkingSpace space = SpaceRepository::instance().findById(id);
-        space.setLocation(location);
-        space.setType(type);
-        space.setHourlyRate(hourlyRate);
-        
-        if (SpaceRepository::instance().update(space)) {
-            return ApiResponse::success("Space updated", spaceToJson(space));
-        } else {
-            return ApiResponse::error("Failed to update space");
+        // 读取-修改-比较写入；版本冲突时基于最新数据重试，但只在冲突来自其他字段（如占用状态）时重放
+        ParkingSpace original = SpaceRepository::instance().findById(id);
+        if (original.getId() == 0) {
+            return ApiResponse::error("Space not found");
+        }
+        ParkingSpace space = original;
+        for (int attempt = 0; attempt < MAX_WRITE_RETRIES; ++attempt) {
+            if (attempt > 0) {
+                space = SpaceRepository::instance().findById(id);
+                if (space.getId() == 0) {
+                    return ApiResponse::error("Space not found");
+                }
+                if (space.getLocation() != original.getLocation() || space.getType() != original.getType() ||
+                    !qFuzzyCompare(space.getHourlyRate(), original.getHourlyRate())) {
+                    return ApiResponse::error("Space modified concurrently, please retry");
+                }
+            }
+            space.setLocation(location);
+            space.setType(type);
+            space.setHourlyRate(hourlyRate);
+            
+            WriteResult result = SpaceRepository::instance().compareAndUpdate(space);
+            if (result == WRITE_OK) {
+                emit spaceUpdated(id);
+                return ApiResponse::success("Space updated", spaceToJson(space));
+            }
+            if (result == WRITE_ERROR) {
+                return ApiResponse::error("Failed to update space");
+            }
+            Logger::warning(QString("Version conflict updating space %1, retrying").arg(id));
         }
+        
+        return ApiResponse::error("Space modified concurrently, please retry");
     } catch (const std::exception& e) {
         Logger::error(QString("Error updating space: %1").arg(e.what()));
         return ApiResponse::error("Internal server error");
@@ -92,6 +119,7 @@ QJsonObject SpaceService::deleteSpace(int id)
         }
         
         if (SpaceRepository::instance().remove(id)) {
+            emit spaceDeleted(id);
             return ApiResponse::success("Space deleted");
         } else {
             return ApiResponse::error("Failed to delete space");
@@ -162,6 +190,42 @@ QJsonArray SpaceService::getOccupiedSpaces()
     }
 }
 
+bool SpaceService::parseFieldMask(const QString& spec, FieldMask& mask, QString& error)
+{
+    static const char* const names[SPACE_FIELD_COUNT] = {
+        "currentPlate", "hourlyRate", "id", "location", "occupiedTime", "status", "type"
+    };
+    return FieldMask::parse(spec, names, SPACE_FIELD_COUNT, mask, error);
+}
+
+QByteArray SpaceService::getAllSpacesEncoded(int& count, const FieldMask& fields)
+{
+    QList<ParkingSpace> spaces = SpaceRepository::instance().findAll();
+    count = spaces.size();
+    return spacesToJsonBytes(spaces, fields);
+}
+
+QByteArray SpaceService::getSpacesByStatusEncoded(const QString& status, int& count, const FieldMask& fields)
+{
+    QList<ParkingSpace> spaces = SpaceRepository::instance().findByStatus(parseStatus(status));
+    count = spaces.size();
+    return spacesToJsonBytes(spaces, fields);
+}
+
+QByteArray SpaceService::getAvailableSpacesEncoded(int& count, const FieldMask& fields)
+{
+    QList<ParkingSpace> spaces = SpaceRepository::instance().findAvailableSpaces();
+    count = spaces.size();
+    return spacesToJsonBytes(spaces, fields);
+}
+
+QByteArray SpaceService::getOccupiedSpacesEncoded(int& count, const FieldMask& fields)
+{
+    QList<ParkingSpace> spaces = SpaceRepository::instance().findOccupiedSpaces();
+    count = spaces.size();
+    return spacesToJsonBytes(spaces, fields);
+}
+
 QJsonObject SpaceService::occupySpace(int id, const QString& plate)
 {
     try {
@@ -184,6 +248,7 @@ QJsonObject SpaceService::occupySpace(int id, const QString& plate)
         if (billingResult["code"] != 0) {
             return billingResult; // 返回计费服务的错误
         }
+        emit spaceOccupied(id, plate);
         
         // 重新获取车位信息
         space = SpaceRepository::instance().findById(id);
@@ -218,9 +283,9 @@ QJsonObject SpaceService::releaseSpace(int id)
         if (billingResult["code"] != 0) {
             return billingResult; // 返回计费服务的错误
         }
+        emit spaceReleased(id);
         
-        // 通知队列处理器有空位可用
-        notifySpaceAvailable(id);
+        // endParking 已通知队列处理器，这里不再重复通知
         
         // 重新获取车位信息
         ParkingSpace space = SpaceRepository::instance().findById(id);
@@ -240,19 +305,42 @@ QJsonObject SpaceService::updateSpaceStatus(int id, const QString& status)
         
         ParkingSpace::Status spaceStatus = parseStatus(status);
         ParkingSpace space = SpaceRepository::instance().findById(id);
+        if (space.getId() == 0) {
+            return ApiResponse::error("Space not found");
+        }
         ParkingSpace::Status oldStatus = space.getStatus();
-        space.setStatus(spaceStatus);
         
-        if (SpaceRepository::instance().update(space)) {
-            // 如果状态从非可用变为可用，通知队列处理器
-            if (oldStatus != ParkingSpace::AVAILABLE && spaceStatus == ParkingSpace::AVAILABLE) {
-                notifySpaceAvailable(id);
+        for (int attempt = 0; attempt < MAX_WRITE_RETRIES; ++attempt) {
+            if (attempt > 0) {
+                // 版本冲突后重新读取：状态已被并发修改（例如车位刚被占用）时，原来的状态转换不再成立
+                space = SpaceRepository::instance().findById(id);
+                if (space.getId() == 0) {
+                    return ApiResponse::error("Space not found");
+                }
+                if (space.getStatus() != oldStatus) {
+                    return ApiResponse::error("Space status changed concurrently, please retry");
+                }
             }
+            space.setStatus(spaceStatus);
             
-            return ApiResponse::success("Status updated", spaceToJson(space));
-        } else {
-            return ApiResponse::error("Failed to update status");
+            WriteResult result = SpaceRepository::instance().compareAndUpdate(space);
+            if (result == WRITE_OK) {
+                emit spaceUpdated(id);
+                
+                // 如果状态从非可用变为可用，通知队列处理器
+                if (oldStatus != ParkingSpace::AVAILABLE && spaceStatus == ParkingSpace::AVAILABLE) {
+                    notifySpaceAvailable(id);
+                }
+                
+                return ApiResponse::success("Status updated", spaceToJson(space));
+            }
+            if (result == WRITE_ERROR) {
+                return ApiResponse::error("Failed to update status");
+            }
+            Logger::warning(QString("Version conflict updating status of space %1, retrying").arg(id));
         }
+        
+        return ApiResponse::error("Space modified concurrently, please retry");
     } catch (const std::exception& e) {
         Logger::error(QString("Error updating status: %1").arg(e.what()));
         return ApiResponse::error("Internal server error");
@@ -388,6 +476,72 @@ QJsonArray SpaceService::spacesToJson(const QList<ParkingSpace>& spaces)
     return array;
 }
 
+QByteArray SpaceService::spacesToJsonBytes(const QList<ParkingSpace>& spaces, const FieldMask& fields)
+{
+    if (!fields.isAll()) {
+        // 投影输出只编码请求的字段，不经过整行缓存
+        QByteArray out;
+        out.reserve(spaces.size() * 64 + 2);
+        JsonWriter writer(out);
+        writer.beginArray();
+        for (const ParkingSpace& space : spaces) {
+            writeSpace(writer, space, fields);
+        }
+        writer.endArray();
+        return out;
+    }
+    
+    SpaceJsonCache& cache = SpaceJsonCache::instance();
+    
+    QByteArray out;
+    out.reserve(spaces.size() * 192 + 2);
+    out.append('[');
+    
+    QByteArray fragment;
+    for (int i = 0; i < spaces.size(); ++i) {
+        const ParkingSpace& space = spaces.at(i);
+        if (!cache.lookup(space.getId(), space.getVersion(), fragment)) {
+            fragment = QJsonDocument(spaceToJson(space)).toJson(QJsonDocument::Compact);
+            cache.store(space.getId(), space.getVersion(), fragment);
+        }
+        if (i > 0) {
+            out.append(',');
+        }
+        out.append(fragment);
+    }
+    
+    out.append(']');
+    return out;
+}
+
+void SpaceService::writeSpace(JsonWriter& writer, const ParkingSpace& space, const FieldMask& fields)
+{
+    // 键按字母序，与 spaceToJson 经 QJsonDocument 输出的顺序一致
+    writer.beginObject();
+    if (fields.has(SPACE_CURRENT_PLATE)) {
+        writer.field("currentPlate", space.getCurrentPlate());
+    }
+    if (fields.has(SPACE_HOURLY_RATE)) {
+        writer.field("hourlyRate", space.getHourlyRate());
+    }
+    if (fields.has(SPACE_ID)) {
+        writer.field("id", space.getId());
+    }
+    if (fields.has(SPACE_LOCATION)) {
+        writer.field("location", space.getLocation());
+    }
+    if (fields.has(SPACE_OCCUPIED_TIME)) {
+        writer.field("occupiedTime", space.getOccupiedTime().isValid() ? space.getOccupiedTime().toString(Qt::ISODate) : QString());
+    }
+    if (fields.has(SPACE_STATUS)) {
+        writer.field("status", statusToString(space.getStatus()));
+    }
+    if (fields.has(SPACE_TYPE)) {
+        writer.field("type", space.getType());
+    }
+    writer.endObject();
+}
+
 bool SpaceService::validateLocation(const QString& location)
 {
     return !location.trimmed().isEmpty() && location.length() <= 50;
@@ -395,12 +549,7 @@ bool SpaceService::validateLocation(const QString& location)
 
 bool SpaceService::validatePlate(const QString& plate)
 {
-    // 第1位汉字 + 第2位大写字母 + 后5位大写字母或数字
-    static QRegularExpression reg(
-        R"(^[\x{4e00}-\x{9fa5}][A-Z][A-Z0-9]{5}$)"
-    );
-
-    return reg.match(plate).hasMatch();
+    return PlateValidator::isValid(plate);
 }
 
 
@@ -448,40 +597,33 @@ QJsonObject SpaceService::joinQueue(const QString& plate)
             return ApiResponse::success("Space assigned directly", spaceInfo);
         }
         
-        // 检查是否有空闲车位
+        // 无人排队时直接占用空闲车位；有车辆排队时先入队，由调度线程按先后顺序分配
         QJsonArray availableSpaces = getAvailableSpaces();
-        if (!availableSpaces.isEmpty()) {
-            // 处理排队队列，按顺序为排队车辆分配车位
-            QJsonObject processResult = processQueueAndAssignSpaces();
-            
-            // 重新检查当前车辆是否已经被分配车位（可能在处理队列时被分配）
-            QList<ParkingRecord> updatedRecords = ParkingRecordRepository::instance().findActiveByPlate(plate);
-            if (!updatedRecords.isEmpty()) {
-                ParkingRecord assignedRecord = updatedRecords.first();
-                QJsonObject spaceInfo;
-                spaceInfo["spaceId"] = assignedRecord.getSpaceId();
-                spaceInfo["plate"] = plate;
-                spaceInfo["startTime"] = assignedRecord.getEnterTime().toString(Qt::ISODate);
-                spaceInfo["message"] = "Space assigned from queue processing";
-                return ApiResponse::success("Space assigned from queue", spaceInfo);
-            }
+        if (!availableSpaces.isEmpty() && QueueRepository::instance().count() == 0) {
+            QJsonObject firstSpace = availableSpaces.first().toObject();
+            int spaceId = firstSpace["id"].toInt();
             
-            // 如果还有剩余车位，直接分配给当前车辆
-            QJsonArray remainingSpaces = getAvailableSpaces();
-            if (!remainingSpaces.isEmpty()) {
-                QJsonObject firstSpace = remainingSpaces.first().toObject();
-                int spaceId = firstSpace["id"].toInt();
-                
-                QJsonObject occupyResult = occupySpace(spaceId, plate);
-                if (occupyResult["code"] == 0) {
-                    return ApiResponse::success("Space assigned directly", occupyResult["data"].toObject());
-                } else {
-                    // 占用失败，加入队列
-                    Logger::warning(QString("Failed to occupy available space %1 for plate %2, adding to queue").arg(spaceId).arg(plate));
-                }
+            QJsonObject occupyResult = occupySpace(spaceId, plate);
+            if (occupyResult["code"] == 0) {
+                return ApiResponse::success("Space assigned directly", occupyResult["data"].toObject());
+            } else {
+                // 占用失败，加入队列
+                Logger::warning(QString("Failed to occupy available space %1 for plate %2, adding to queue").arg(spaceId).arg(plate));
             }
         }
 
+        // 入队前按车牌加锁，与队列分配串行，避免已分配车位的车辆再次入队
+        GateLocker gateLocker(plate);
+        QList<ParkingRecord> lockedRecords = ParkingRecordRepository::instance().findActiveByPlate(plate);
+        if (!lockedRecords.isEmpty()) {
+            ParkingRecord assignedRecord = lockedRecords.first();
+            QJsonObject spaceInfo;
+            spaceInfo["spaceId"] = assignedRecord.getSpaceId();
+            spaceInfo["plate"] = plate;
+            spaceInfo["startTime"] = assignedRecord.getEnterTime().toString(Qt::ISODate);
+            return ApiResponse::success("Space assigned directly", spaceInfo);
+        }
+
         // 检查车辆是否已经在排队
         if (QueueRepository::instance().exists(plate)) {
             QueueItem existingItem = QueueRepository::instance().findByPlate(plate);
@@ -489,12 +631,21 @@ QJsonObject SpaceService::joinQueue(const QString& plate)
             queueInfo["plate"] = plate;
             queueInfo["queueTime"] = existingItem.queueTime.toString(Qt::ISODate);
             queueInfo["position"] = QueueRepository::instance().getPosition(plate);
+            if (!availableSpaces.isEmpty()) {
+                QueueProcessor::instance().checkAndProcessQueue();
+            }
             return ApiResponse::success("Vehicle already in queue", queueInfo);
         }
         
         // 加入排队队列
         QueueItem item(plate);
         if (QueueRepository::instance().insert(item)) {
+            emit queueJoined(plate);
+            // 有空闲车位时唤醒调度线程分配，不在请求线程上处理队列
+            if (!availableSpaces.isEmpty()) {
+                QueueProcessor::instance().checkAndProcessQueue();
+            }
+            
             QJsonObject queueInfo;
             queueInfo["plate"] = plate;
             queueInfo["queueTime"] = item.queueTime.toString(Qt::ISODate);
@@ -513,8 +664,20 @@ QJsonObject SpaceService::joinQueue(const QString& plate)
 
 QJsonObject SpaceService::processQueueAndAssignSpaces()
 {
-    // 使用集中式队列处理器
-    return QueueProcessor::instance().processQueueForAvailableSpaces();
+    // 分配只在调度线程上执行，这里只唤醒调度线程，立即返回
+    QueueProcessor::instance().checkAndProcessQueue();
+
+    QJsonObject result;
+    result["assignedCount"] = 0;
+    result["dispatched"] = true;
+    result["message"] = "Queue dispatcher notified";
+    result["success"] = true;
+    return result;
+}
+
+void SpaceService::notifySpaceOccupied(int spaceId, const QString& plate)
+{
+    emit spaceOccupied(spaceId, plate);
 }
 
 void SpaceService::notifySpaceAvailable(int spaceId)
@@ -527,13 +690,12 @@ void SpaceService::notifySpaceAvailable(int spaceId)
         }
         
         if (space.getStatus() == ParkingSpace::AVAILABLE) {
-            Logger::info(QString("Space %1 is now available, triggering queue processing").arg(spaceId));
-            
             // 检查是否有排队车辆，避免无谓的队列处理
             int queueCount = QueueRepository::instance().count();
             if (queueCount > 0) {
-                // 异步处理队列，避免阻塞当前操作
-                QueueProcessor::instance().checkAndProcessQueue();
+                // 唤醒调度线程，由其在队列与空闲车位之间排空分配
+                Logger::info(QString("Space %1 is now available, waking queue dispatcher").arg(spaceId));
+                QueueProcessor::instance().notifySpaceReleased();
             } else {
                 Logger::debug(QString("No vehicles in queue, skipping queue processing for space %1").arg(spaceId));
             }
@@ -549,13 +711,11 @@ void SpaceService::notifySpacesAvailable(const QList<int>& spaceIds)
         return;
     }
     
-    // 检查是否有排队车辆，避免无谓的队列处理
-    int queueCount = QueueRepository::instance().count();
-    if (queueCount > 0) {
-        Logger::info(QString("Notifying %1 spaces available, triggering queue processing").arg(spaceIds.size()));
-        // 异步处理队列，避免阻塞当前操作
-        QueueProcessor::instance().checkAndProcessQueue();
-    } else {
+    if (QueueRepository::instance().count() == 0) {
         Logger::debug(QString("No vehicles in queue, skipping queue processing for %1 spaces").arg(spaceIds.size()));
+        return;
     }
+    
+    Logger::info(QString("Notifying %1 spaces available, waking queue dispatcher").arg(spaceIds.size()));
+    QueueProcessor::instance().notifySpaceReleased(spaceIds.size());
 }
@@ -6,6 +6,8 @@
 #include <QJsonArray>
 #include "../models/ParkingSpace.h"
 #include "../dao/SpaceRepository.h"
+#include "../core/FieldMask.h"
+#include "../core/JsonWriter.h"
 
 class SpaceService : public QObject
 {
@@ -26,6 +28,25 @@ public:
     QJsonArray getAvailableSpaces();
     QJsonArray getOccupiedSpaces();
     
+    // 车位可投影字段，按 JSON 键的字母序排列
+    enum SpaceField {
+        SPACE_CURRENT_PLATE = 0,
+        SPACE_HOURLY_RATE,
+        SPACE_ID,
+        SPACE_LOCATION,
+        SPACE_OCCUPIED_TIME,
+        SPACE_STATUS,
+        SPACE_TYPE,
+        SPACE_FIELD_COUNT
+    };
+    static bool parseFieldMask(const QString& spec, FieldMask& mask, QString& error);
+    
+    // 预编码的车位列表：返回 JSON 数组的 UTF-8 字节，count 为元素个数；fields 限定输出字段
+    QByteArray getAllSpacesEncoded(int& count, const FieldMask& fields = FieldMask());
+    QByteArray getSpacesByStatusEncoded(const QString& status, int& count, const FieldMask& fields = FieldMask());
+    QByteArray getAvailableSpacesEncoded(int& count, const FieldMask& fields = FieldMask());
+    QByteArray getOccupiedSpacesEncoded(int& count, const FieldMask& fields = FieldMask());
+    
     // 停车位状态管理
     QJsonObject occupySpace(int id, const QString& plate);
     QJsonObject releaseSpace(int id);
@@ -44,8 +65,12 @@ public:
     
     // 排队系统
     QJsonObject joinQueue(const QString& plate);
+    // 唤醒调度线程处理排队队列，立即返回，不在调用线程上分配
     QJsonObject processQueueAndAssignSpaces();
     
+    // 车位已由其他流程（排队分配）占用后发出 spaceOccupied，订阅方与 occupySpace() 的一致
+    void notifySpaceOccupied(int spaceId, const QString& plate);
+    
     // 空间可用性通知（当车位变为可用时调用）
     void notifySpaceAvailable(int spaceId);
     void notifySpacesAvailable(const QList<int>& spaceIds);
@@ -56,6 +81,7 @@ signals:
     void spaceDeleted(int id);
     void spaceOccupied(int id, const QString& plate);
     void spaceReleased(int id);
+    void queueJoined(const QString& plate);
 
 private:
     SpaceService() = default;
@@ -64,12 +90,17 @@ private:
     
     QJsonObject spaceToJson(const ParkingSpace& space);
     QJsonArray spacesToJson(const QList<ParkingSpace>& spaces);
+    QByteArray spacesToJsonBytes(const QList<ParkingSpace>& spaces, const FieldMask& fields);
+    void writeSpace(JsonWriter& writer, const ParkingSpace& space, const FieldMask& fields);
     bool validateLocation(const QString& location);
     bool validatePlate(const QString& plate);
     bool validateType(const QString& type);
     bool validateHourlyRate(double rate);
     ParkingSpace::Status parseStatus(const QString& status);
     QString statusToString(ParkingSpace::Status status);
+    
+    // 版本冲突时的最大重试次数
+    static const int MAX_WRITE_RETRIES = 3;
 };
 
 #endif // SPACESERVICE_H
\ No newline at end of file
@@ -0,0 +1,16 @@
+include(../tests.pri)
+
+TARGET = tst_cbor
+
+SOURCES += \
+    tst_cbor.cpp \
+    $$SRC_DIR/core/HttpRequest.cpp \
+    $$SRC_DIR/core/HttpResponse.cpp \
+    $$SRC_DIR/core/DeferredResponse.cpp \
+    $$SRC_DIR/core/JsonReader.cpp
+
+HEADERS += \
+    $$SRC_DIR/core/HttpRequest.h \
+    $$SRC_DIR/core/HttpResponse.h \
+    $$SRC_DIR/core/DeferredResponse.h \
+    $$SRC_DIR/core/JsonReader.h
@@ -0,0 +1,329 @@
+#include <QtTest>
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include "core/HttpRequest.h"
+#include "core/HttpResponse.h"
+#include "core/JsonReader.h"
+
+namespace {
+
+// 覆盖 JsonReader 支持的全部字段类型
+struct SampleRequest
+{
+    QString plate;
+    int spaceId = 0;
+    double fee = 0.0;
+    bool paid = false;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.required("plate", plate);
+        b.required("spaceId", spaceId);
+        b.optional("fee", fee);
+        b.optional("paid", paid);
+    }
+};
+
+// 与车位列表接口相同形状的响应数据
+QJsonObject spaceList(int count)
+{
+    QRandomGenerator random(7);
+    QJsonArray spaces;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject space;
+        space["id"] = i + 1;
+        space["location"] = QString::fromUtf8("B%1区-%2").arg(1 + random.bounded(3)).arg(random.bounded(200));
+        space["type"] = random.bounded(2) ? "standard" : "large";
+        space["status"] = random.bounded(3) ? "available" : "occupied";
+        space["hourlyRate"] = 5.0 + random.bounded(4) * 2.5;
+        space["version"] = random.bounded(100);
+        spaces.append(space);
+    }
+    QJsonObject data;
+    data["count"] = count;
+    data["data"] = spaces;
+    data["message"] = "Spaces retrieved successfully";
+    data["success"] = true;
+    return data;
+}
+
+// 替换前的编码路径：响应体 JSON 文本重新解析为 DOM，再转 CBOR
+QByteArray legacyEncode(const QByteArray& json)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    QCborValue value = doc.isArray() ? QCborValue::fromJsonValue(doc.array())
+                                     : QCborValue::fromJsonValue(doc.object());
+    return value.toCbor();
+}
+
+// 替换前的解码路径：CBOR 转写为 JSON 文本，再按 JSON 解码到 DTO
+bool legacyDecode(const QByteArray& cbor, SampleRequest& dto, QString& error)
+{
+    QCborParserError parseError;
+    QCborValue value = QCborValue::fromCbor(cbor, &parseError);
+    if (parseError.error != QCborError::NoError) {
+        error = "Invalid CBOR format";
+        return false;
+    }
+    if (!value.isMap()) {
+        error = "CBOR body must be a map";
+        return false;
+    }
+    QByteArray json = QJsonDocument(value.toMap().toJsonObject()).toJson(QJsonDocument::Compact);
+    return JsonReader::decode(json, dto, error);
+}
+
+HttpRequest cborRequest(const QByteArray& body)
+{
+    HttpRequest request;
+    request.headers["content-type"] = "application/cbor";
+    request.bodyRaw = body;
+    return request;
+}
+
+}
+
+class TestCbor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encodeFromValue();
+    void encodeTranscoded_data();
+    void encodeTranscoded();
+    void encodeSkipsReplacedBody();
+    void decodeAgreesWithLegacy_data();
+    void decodeAgreesWithLegacy();
+    void decodeChunkedAndIndefinite();
+    void jsonBodyFromCbor();
+    void payloadSize_data();
+    void payloadSize();
+
+    void benchmarkEncodeLegacy();
+    void benchmarkEncodeFromValue();
+    void benchmarkEncodeTranscoded();
+    void benchmarkDecodeLegacy();
+    void benchmarkDecodeDirect();
+};
+
+void TestCbor::encodeFromValue()
+{
+    HttpResponse response;
+    response.ok(spaceList(50));
+    QByteArray json = response.body;
+
+    QVERIFY(response.encodeAsCbor());
+    QCOMPARE(response.getHeader("Content-Type"), QString("application/cbor"));
+    QCOMPARE(response.body, legacyEncode(json));
+}
+
+void TestCbor::encodeTranscoded_data()
+{
+    QTest::addColumn<QByteArray>("json");
+
+    QTest::newRow("list") << QJsonDocument(spaceList(50)).toJson(QJsonDocument::Compact);
+    QTest::newRow("array") << QByteArray("[1,-2,2.5,\"a\",true,false,null,[],{}]");
+    QTest::newRow("escapes") << QByteArray("{\"a\\\"b\":\"\\u4eac\\n\\ud83d\\ude97\",\"c\":\"\xe4\xba\xac\"}");
+    QTest::newRow("large integers") << QByteArray("{\"a\":9007199254740993,\"b\":-9223372036854775808,\"c\":1e300}");
+    QTest::newRow("whitespace") << QByteArray(" { \"a\" : [ 1 , 2 ] } \r\n");
+}
+
+void TestCbor::encodeTranscoded()
+{
+    QFETCH(QByteArray, json);
+
+    HttpResponse response;
+    response.rawJson(json);
+    QVERIFY(response.encodeAsCbor());
+
+    // 容器为不定长编码，字节与 DOM 路径不同，解码后的值必须相同（包括整数/浮点类型）
+    QCborParserError error;
+    QCborValue transcoded = QCborValue::fromCbor(response.body, &error);
+    QVERIFY(error.error == QCborError::NoError);
+    QCOMPARE(transcoded, QCborValue::fromCbor(legacyEncode(json)));
+}
+
+void TestCbor::encodeSkipsReplacedBody()
+{
+    // json() 之后 body 被替换（如缓存命中），必须编码新的 body 而不是保留的值
+    HttpResponse response;
+    response.ok(spaceList(1));
+    response.body = QByteArray("{\"cached\":true}");
+    QVERIFY(response.encodeAsCbor());
+    QCOMPARE(QCborValue::fromCbor(response.body).toMap().toJsonObject(),
+             QJsonObject{{"cached", true}});
+
+    HttpResponse invalid;
+    invalid.rawJson("{\"a\":");
+    QVERIFY(!invalid.encodeAsCbor());
+}
+
+void TestCbor::decodeAgreesWithLegacy_data()
+{
+    QTest::addColumn<QByteArray>("cbor");
+
+    auto map = [](const QCborMap& m) { return QCborValue(m).toCbor(); };
+    QTest::newRow("all fields") << map({{"plate", QString::fromUtf8("京A12345")}, {"spaceId", 3}, {"fee", 12.5}, {"paid", true}});
+    QTest::newRow("required only") << map({{"plate", "A"}, {"spaceId", 1}});
+    QTest::newRow("missing required") << map({{"plate", "A"}});
+    QTest::newRow("null optional") << map({{"plate", "A"}, {"spaceId", 1}, {"fee", QCborValue(nullptr)}});
+    QTest::newRow("null required") << map({{"plate", QCborValue(nullptr)}, {"spaceId", 1}});
+    QTest::newRow("unknown fields") << map({{"extra", QCborArray{1, QCborMap{{"x", "y"}}}}, {"plate", "A"}, {"spaceId", 2}});
+    QTest::newRow("negative int") << map({{"plate", "A"}, {"spaceId", -5}});
+    QTest::newRow("integral double for int") << map({{"plate", "A"}, {"spaceId", 2.0}});
+    QTest::newRow("fraction for int") << map({{"plate", "A"}, {"spaceId", 2.5}});
+    QTest::newRow("int overflow") << map({{"plate", "A"}, {"spaceId", qint64(1) << 40}});
+    QTest::newRow("negative overflow") << map({{"plate", "A"}, {"spaceId", -(qint64(1) << 40)}});
+    QTest::newRow("int for double") << map({{"plate", "A"}, {"spaceId", 1}, {"fee", 7}});
+    QTest::newRow("string for int") << map({{"plate", "A"}, {"spaceId", "1"}});
+    QTest::newRow("int for string") << map({{"plate", 1}, {"spaceId", 1}});
+    QTest::newRow("int for bool") << map({{"plate", "A"}, {"spaceId", 1}, {"paid", 1}});
+    QTest::newRow("array body") << QCborValue(QCborArray{1, 2}).toCbor();
+    QTest::newRow("empty map") << map({});
+    QTest::newRow("truncated") << map({{"plate", "A"}, {"spaceId", 1}}).left(5);
+    QTest::newRow("empty body") << QByteArray();
+}
+
+void TestCbor::decodeAgreesWithLegacy()
+{
+    QFETCH(QByteArray, cbor);
+
+    SampleRequest expected;
+    QString expectedError;
+    bool expectedOk = legacyDecode(cbor, expected, expectedError);
+
+    SampleRequest actual;
+    QString actualError;
+    bool actualOk = cborRequest(cbor).bindBody(actual, actualError);
+
+    QCOMPARE(actualOk, expectedOk);
+    QCOMPARE(actualError, expectedError);
+    if (expectedOk) {
+        QCOMPARE(actual.plate, expected.plate);
+        QCOMPARE(actual.spaceId, expected.spaceId);
+        QCOMPARE(actual.fee, expected.fee);
+        QCOMPARE(actual.paid, expected.paid);
+    }
+}
+
+void TestCbor::decodeChunkedAndIndefinite()
+{
+    // 不定长 map 和分段文本串，客户端流式编码时会产生
+    QByteArray cbor;
+    cbor.append(char(0xBF));                              // 不定长 map
+    cbor.append(char(0x65)).append("plate");
+    cbor.append(char(0x7F));                              // 不定长文本串
+    cbor.append(char(0x62)).append("AB");
+    cbor.append(char(0x63)).append("CDE");
+    cbor.append(char(0xFF));
+    cbor.append(char(0x67)).append("spaceId");
+    cbor.append(char(0x09));
+    cbor.append(char(0xFF));
+
+    SampleRequest dto;
+    QString error;
+    QVERIFY2(cborRequest(cbor).bindBody(dto, error), qPrintable(error));
+    QCOMPARE(dto.plate, QString("ABCDE"));
+    QCOMPARE(dto.spaceId, 9);
+}
+
+void TestCbor::jsonBodyFromCbor()
+{
+    QJsonObject object{{"plate", QString::fromUtf8("京A12345")}, {"spaceId", 3}, {"tags", QJsonArray{"a", "b"}}};
+    bool ok = false;
+    QCOMPARE(cborRequest(QCborValue::fromJsonValue(object).toCbor()).jsonBody(&ok), object);
+    QVERIFY(ok);
+
+    cborRequest(QByteArray("\xA1", 1)).jsonBody(&ok);
+    QVERIFY(!ok);
+}
+
+void TestCbor::payloadSize_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::newRow("1 space") << 1;
+    QTest::newRow("100 spaces") << 100;
+    QTest::newRow("1000 spaces") << 1000;
+}
+
+void TestCbor::payloadSize()
+{
+    QFETCH(int, rows);
+
+    HttpResponse fromValue;
+    fromValue.ok(spaceList(rows));
+    QByteArray json = fromValue.body;
+
+    HttpResponse transcoded;
+    transcoded.rawJson(json);
+
+    QVERIFY(fromValue.encodeAsCbor());
+    QVERIFY(transcoded.encodeAsCbor());
+
+    qInfo("%d spaces: JSON %d bytes, CBOR %d bytes (definite), %d bytes (transcoded)",
+          rows, json.size(), fromValue.body.size(), transcoded.body.size());
+    QVERIFY(fromValue.body.size() < json.size());
+    QVERIFY(transcoded.body.size() < json.size());
+}
+
+void TestCbor::benchmarkEncodeLegacy()
+{
+    QByteArray json = QJsonDocument(spaceList(1000)).toJson(QJsonDocument::Compact);
+    QBENCHMARK {
+        QByteArray cbor = legacyEncode(json);
+        Q_UNUSED(cbor);
+    }
+}
+
+void TestCbor::benchmarkEncodeFromValue()
+{
+    QJsonObject data = spaceList(1000);
+    HttpResponse prototype;
+    prototype.ok(data);
+    QBENCHMARK {
+        HttpResponse response(prototype);
+        response.encodeAsCbor();
+    }
+}
+
+void TestCbor::benchmarkEncodeTranscoded()
+{
+    QByteArray json = QJsonDocument(spaceList(1000)).toJson(QJsonDocument::Compact);
+    QBENCHMARK {
+        QByteArray cbor;
+        JsonReader::transcodeToCbor(json, cbor);
+    }
+}
+
+void TestCbor::benchmarkDecodeLegacy()
+{
+    QByteArray cbor = QCborValue(QCborMap{{"plate", QString::fromUtf8("京A12345")}, {"spaceId", 3},
+                                          {"fee", 12.5}, {"paid", true}, {"note", "gate 2"}}).toCbor();
+    QBENCHMARK {
+        SampleRequest dto;
+        QString error;
+        legacyDecode(cbor, dto, error);
+    }
+}
+
+void TestCbor::benchmarkDecodeDirect()
+{
+    QByteArray cbor = QCborValue(QCborMap{{"plate", QString::fromUtf8("京A12345")}, {"spaceId", 3},
+                                          {"fee", 12.5}, {"paid", true}, {"note", "gate 2"}}).toCbor();
+    HttpRequest request = cborRequest(cbor);
+    QBENCHMARK {
+        SampleRequest dto;
+        QString error;
+        request.bindBody(dto, error);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestCbor)
+
+#include "tst_cbor.moc"
@@ -0,0 +1,74 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstddef>
+
+namespace {
+
+std::atomic<qint64> allocatedBytes{0};
+std::atomic<qint64> allocationCount{0};
+
+inline void track(std::size_t size)
+{
+    allocatedBytes.fetch_add(static_cast<qint64>(size), std::memory_order_relaxed);
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+}
+
+#if defined(__GLIBC__)
+
+extern "C" {
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+
+// realloc 按新申请的大小计入，与重新分配一块新内存的代价相当
+void* malloc(std::size_t size)
+{
+    track(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size)
+{
+    track(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, std::size_t size)
+{
+    track(size);
+    return __libc_realloc(pointer, size);
+}
+
+}
+
+#endif
+
+AllocationCounter::AllocationCounter()
+    : m_startBytes(allocatedBytes.load(std::memory_order_relaxed))
+    , m_startCount(allocationCount.load(std::memory_order_relaxed))
+{
+}
+
+AllocationCounter::~AllocationCounter() = default;
+
+qint64 AllocationCounter::bytes() const
+{
+    return allocatedBytes.load(std::memory_order_relaxed) - m_startBytes;
+}
+
+qint64 AllocationCounter::count() const
+{
+    return allocationCount.load(std::memory_order_relaxed) - m_startCount;
+}
+
+bool AllocationCounter::isSupported()
+{
+#if defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
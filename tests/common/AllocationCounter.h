@@ -0,0 +1,24 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// 统计作用域内的堆分配（malloc/calloc/realloc，operator new 和 Qt 容器最终都经过这里）
+// 仅 glibc 下可用：通过符号覆盖拦截分配函数；其他平台 isSupported() 返回 false
+class AllocationCounter
+{
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    qint64 bytes() const;
+    qint64 count() const;
+
+    static bool isSupported();
+
+private:
+    qint64 m_startBytes;
+    qint64 m_startCount;
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,82 @@
+include(../tests.pri)
+
+QT += sql concurrent
+
+TARGET = tst_dashboard
+
+SOURCES += \
+    tst_dashboard.cpp \
+    $$SRC_DIR/services/DashboardMaterializer.cpp \
+    $$SRC_DIR/services/BillingService.cpp \
+    $$SRC_DIR/services/CarService.cpp \
+    $$SRC_DIR/services/SpaceService.cpp \
+    $$SRC_DIR/services/QueueProcessor.cpp \
+    $$SRC_DIR/services/SpaceJsonCache.cpp \
+    $$SRC_DIR/services/ReportExecutor.cpp \
+    $$SRC_DIR/controllers/ReportController.cpp \
+    $$SRC_DIR/core/HttpRequest.cpp \
+    $$SRC_DIR/core/HttpResponse.cpp \
+    $$SRC_DIR/core/DeferredResponse.cpp \
+    $$SRC_DIR/core/FieldMask.cpp \
+    $$SRC_DIR/core/JsonReader.cpp \
+    $$SRC_DIR/core/JsonWriter.cpp \
+    $$SRC_DIR/api/ApiResponse.cpp \
+    $$SRC_DIR/dao/DatabaseSchema.cpp \
+    $$SRC_DIR/dao/ActiveSessionIndex.cpp \
+    $$SRC_DIR/dao/CarRepository.cpp \
+    $$SRC_DIR/dao/ParkingRecordCursor.cpp \
+    $$SRC_DIR/dao/ParkingRecordRepository.cpp \
+    $$SRC_DIR/dao/QueueRepository.cpp \
+    $$SRC_DIR/dao/RevenueIndex.cpp \
+    $$SRC_DIR/dao/RollupRepository.cpp \
+    $$SRC_DIR/dao/SpaceRepository.cpp \
+    $$SRC_DIR/dao/SpaceSnapshot.cpp \
+    $$SRC_DIR/models/Car.cpp \
+    $$SRC_DIR/models/ParkingRecord.cpp \
+    $$SRC_DIR/models/ParkingSpace.cpp \
+    $$SRC_DIR/utils/DataVersion.cpp \
+    $$SRC_DIR/utils/DateTimeUtil.cpp \
+    $$SRC_DIR/utils/GateLock.cpp \
+    $$SRC_DIR/utils/JsonUtil.cpp \
+    $$SRC_DIR/utils/Logger.cpp \
+    $$SRC_DIR/utils/PlateId.cpp \
+    $$SRC_DIR/utils/PlateValidator.cpp
+
+HEADERS += \
+    $$SRC_DIR/services/DashboardMaterializer.h \
+    $$SRC_DIR/services/BillingService.h \
+    $$SRC_DIR/services/CarService.h \
+    $$SRC_DIR/services/SpaceService.h \
+    $$SRC_DIR/services/QueueProcessor.h \
+    $$SRC_DIR/services/SpaceJsonCache.h \
+    $$SRC_DIR/services/ReportExecutor.h \
+    $$SRC_DIR/controllers/ReportController.h \
+    $$SRC_DIR/core/HttpRequest.h \
+    $$SRC_DIR/core/HttpResponse.h \
+    $$SRC_DIR/core/DeferredResponse.h \
+    $$SRC_DIR/core/FieldMask.h \
+    $$SRC_DIR/core/JsonReader.h \
+    $$SRC_DIR/core/JsonWriter.h \
+    $$SRC_DIR/api/ApiResponse.h \
+    $$SRC_DIR/dao/DatabaseSchema.h \
+    $$SRC_DIR/dao/ActiveSessionIndex.h \
+    $$SRC_DIR/dao/CarRepository.h \
+    $$SRC_DIR/dao/ParkingRecordCursor.h \
+    $$SRC_DIR/dao/ParkingRecordRepository.h \
+    $$SRC_DIR/dao/QueueRepository.h \
+    $$SRC_DIR/dao/RevenueIndex.h \
+    $$SRC_DIR/dao/RollupRepository.h \
+    $$SRC_DIR/dao/SpaceRepository.h \
+    $$SRC_DIR/dao/SpaceSnapshot.h \
+    $$SRC_DIR/models/Car.h \
+    $$SRC_DIR/models/ParkingRecord.h \
+    $$SRC_DIR/models/ParkingSpace.h \
+    $$SRC_DIR/utils/DataVersion.h \
+    $$SRC_DIR/utils/DateTimeUtil.h \
+    $$SRC_DIR/utils/GateLock.h \
+    $$SRC_DIR/utils/JsonUtil.h \
+    $$SRC_DIR/utils/Logger.h \
+    $$SRC_DIR/utils/PlateId.h \
+    $$SRC_DIR/utils/PlateValidator.h \
+    $$SRC_DIR/api/RequestDto.h \
+    $$SRC_DIR/dao/WriteResult.h
@@ -0,0 +1,209 @@
+#include <QtTest>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include "dao/DatabaseSchema.h"
+#include "dao/ParkingRecordRepository.h"
+#include "services/BillingService.h"
+#include "services/DashboardMaterializer.h"
+#include "controllers/ReportController.h"
+
+namespace {
+
+const char* const SETUP_CONNECTION = "tst_dashboard";
+const int RECORD_COUNT = 60;
+const int SPACE_COUNT = 10;
+const int UPDATE_TIMEOUT_MS = 10000;
+
+QDateTime baseTime()
+{
+    return QDateTime(QDate(2024, 6, 3), QTime(8, 0));
+}
+
+// 生成时间随请求变化，比较前去掉
+QJsonObject withoutTimestamps(QJsonObject envelope)
+{
+    QJsonObject result = envelope["data"].toObject();
+    QJsonObject dashboard = result["data"].toObject();
+    dashboard.remove("systemTime");
+    dashboard.remove("generatedAt");
+    result["data"] = dashboard;
+    envelope["data"] = result;
+    return envelope;
+}
+
+QJsonObject dashboardOf(const QJsonObject& envelope)
+{
+    return envelope.value("data").toObject().value("data").toObject();
+}
+
+qint64 statistic(const char* name)
+{
+    return DashboardMaterializer::instance().statistics().value(name).toVariant().toLongLong();
+}
+
+}
+
+class TestDashboard : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void fullBuildMatchesSynchronous();
+    void unpaidNewestFirst();
+    void incrementalUpdateMatchesSynchronous();
+
+private:
+    QJsonObject materialized();
+    void populate();
+
+    QTemporaryDir m_dir;
+    QString m_previousDir;
+    QJsonObject m_synchronous;      // 物化完成前同步生成的响应
+    QList<ParkingRecord> m_records;
+};
+
+void TestDashboard::initTestCase()
+{
+    // 各仓库固定读取 <当前目录>/data/parking_server.db
+    QVERIFY(m_dir.isValid());
+    m_previousDir = QDir::currentPath();
+    QVERIFY(QDir(m_dir.path()).mkpath("data"));
+    QVERIFY(QDir::setCurrent(m_dir.path()));
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", SETUP_CONNECTION);
+        db.setDatabaseName(QDir::currentPath() + "/data/parking_server.db");
+        QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+        QVERIFY(DatabaseSchema::create(db));
+        QSqlQuery query(db);
+        for (int i = 1; i <= SPACE_COUNT; ++i) {
+            query.prepare("INSERT INTO parking_spaces (location, type) VALUES (?, ?)");
+            query.addBindValue(QString("A-%1").arg(i));
+            query.addBindValue(QString::fromUtf8("普通"));
+            QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        }
+    }
+    QSqlDatabase::removeDatabase(SETUP_CONNECTION);
+
+    populate();
+
+    // 物化视图首次构建前，请求走同步生成的路径
+    QVERIFY(!DashboardMaterializer::instance().current());
+    HttpRequest request;
+    HttpResponse response;
+    ReportController::instance().getDashboardSummary(request, response);
+    QCOMPARE(response.statusCode, 200);
+    m_synchronous = QJsonDocument::fromJson(response.body).object();
+    QVERIFY(!m_synchronous.isEmpty());
+
+    DashboardMaterializer::instance().attach();
+    QTRY_VERIFY_WITH_TIMEOUT(DashboardMaterializer::instance().current(), UPDATE_TIMEOUT_MS);
+}
+
+void TestDashboard::cleanupTestCase()
+{
+    QDir::setCurrent(m_previousDir);
+}
+
+// 进场时间只取少数几个值，制造大量相同进场时间的记录；写入顺序与进场时间无关
+void TestDashboard::populate()
+{
+    QRandomGenerator random(20240603);
+    for (int i = 0; i < RECORD_COUNT; ++i) {
+        ParkingRecord record(QString::fromUtf8("京B%1").arg(20000 + i), 1 + random.bounded(SPACE_COUNT));
+        record.setEnterTime(baseTime().addSecs(random.bounded(8) * 900));
+        QVERIFY(ParkingRecordRepository::instance().insert(record));
+
+        int action = random.bounded(4);
+        if (action > 0) {
+            record.setExitTime(record.getEnterTime().addSecs(1800));
+            record.setFee(10.0);
+            QCOMPARE(ParkingRecordRepository::instance().compareAndUpdate(record), WRITE_OK);
+        }
+        if (action > 1) {
+            record.setIsPaid(true);
+            record.setPayTime(record.getExitTime());
+            record.setPayMethod("cash");
+            QCOMPARE(ParkingRecordRepository::instance().compareAndUpdate(record), WRITE_OK);
+        }
+        m_records.append(record);
+    }
+}
+
+QJsonObject TestDashboard::materialized()
+{
+    std::shared_ptr<const QByteArray> body = DashboardMaterializer::instance().current();
+    return body ? QJsonDocument::fromJson(*body).object() : QJsonObject();
+}
+
+void TestDashboard::fullBuildMatchesSynchronous()
+{
+    QJsonObject actual = withoutTimestamps(materialized());
+    QJsonObject expected = withoutTimestamps(m_synchronous);
+    QCOMPARE(dashboardOf(actual).value("activeParkings"), dashboardOf(expected).value("activeParkings"));
+    QCOMPARE(dashboardOf(actual).value("unpaidRecords"), dashboardOf(expected).value("unpaidRecords"));
+    QCOMPARE(actual, expected);
+}
+
+// 与改为物化前的 findAll 结果相同：enter_time DESC，相同进场时间按 id DESC
+void TestDashboard::unpaidNewestFirst()
+{
+    QJsonArray unpaid = dashboardOf(materialized()).value("unpaidRecords").toArray();
+    QVERIFY(unpaid.size() > 1);
+    for (int i = 1; i < unpaid.size(); ++i) {
+        QJsonObject previous = unpaid.at(i - 1).toObject();
+        QJsonObject current = unpaid.at(i).toObject();
+        QString previousStart = previous["startTime"].toString();
+        QString currentStart = current["startTime"].toString();
+        QVERIFY2(previousStart > currentStart
+                 || (previousStart == currentStart && previous["id"].toInt() > current["id"].toInt()),
+                 qPrintable(QString("records %1 and %2 out of order")
+                            .arg(previous["id"].toInt()).arg(current["id"].toInt())));
+    }
+}
+
+// 增量更新后未支付列表仍保持顺序：新记录与已有记录进场时间相同，另一条记录变为已支付
+void TestDashboard::incrementalUpdateMatchesSynchronous()
+{
+    qint64 updatesBefore = statistic("incrementalUpdates");
+
+    ParkingRecord inserted(QString::fromUtf8("京B29999"), 1);
+    inserted.setEnterTime(m_records.first().getEnterTime());
+    QVERIFY(ParkingRecordRepository::instance().insert(inserted));
+
+    ParkingRecord paid;
+    for (const ParkingRecord& record : m_records) {
+        if (record.getExitTime().isValid() && !record.getIsPaid()) {
+            paid = ParkingRecordRepository::instance().findById(record.getId());
+            break;
+        }
+    }
+    QVERIFY(paid.getId() > 0);
+    paid.setIsPaid(true);
+    paid.setPayTime(paid.getExitTime());
+    paid.setPayMethod("cash");
+    QCOMPARE(ParkingRecordRepository::instance().compareAndUpdate(paid), WRITE_OK);
+
+    BillingService& billing = BillingService::instance();
+    emit billing.parkingStarted(inserted.getId(), inserted.getPlate(), inserted.getSpaceId());
+    emit billing.paymentProcessed(paid.getId(), paid.getFee());
+    QTRY_VERIFY_WITH_TIMEOUT(statistic("incrementalUpdates") > updatesBefore, UPDATE_TIMEOUT_MS);
+
+    QJsonObject dashboard = dashboardOf(materialized());
+    QCOMPARE(dashboard.value("activeParkings").toArray(), billing.getActiveParkingRecords());
+    QCOMPARE(dashboard.value("unpaidRecords").toArray(), billing.getUnpaidRecords());
+}
+
+QTEST_GUILESS_MAIN(TestDashboard)
+
+#include "tst_dashboard.moc"
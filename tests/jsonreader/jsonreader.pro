@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_jsonreader
+
+SOURCES += \
+    tst_jsonreader.cpp \
+    $$SRC_DIR/core/JsonReader.cpp
+
+HEADERS += \
+    $$SRC_DIR/core/JsonReader.h
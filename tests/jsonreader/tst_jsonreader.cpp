@@ -0,0 +1,210 @@
+#include <QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "core/JsonReader.h"
+
+namespace {
+
+struct NumberDto
+{
+    double value = 0.0;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.required("value", value);
+    }
+};
+
+struct TextDto
+{
+    QString text;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.required("text", text);
+    }
+};
+
+// 与 api/RequestDto.h 中的写法相同：缺失时使用统一提示
+struct SpaceDto
+{
+    QString location;
+    int floor = 0;
+    double rate = 0.0;
+    bool covered = false;
+
+    template <typename Binder>
+    void bind(Binder& b)
+    {
+        b.missingMessage("Missing required fields: location, rate");
+        b.required("location", location);
+        b.required("rate", rate);
+        b.optional("floor", floor);
+        b.optional("covered", covered);
+    }
+};
+
+// 把数字原样拼进请求体，QByteArray 构造保留内嵌的 NUL
+QByteArray numberBody(const QByteArray& number)
+{
+    return QByteArray("{\"value\":") + number + QByteArray("}");
+}
+
+}
+
+class TestJsonReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void acceptsNumbers_data();
+    void acceptsNumbers();
+    void rejectsNumbers_data();
+    void rejectsNumbers();
+    void rejectsNumbersInSkippedFields();
+
+    void reportsMissingFields();
+    void mismatchedTypesUseDefaults();
+
+    void decodesSurrogatePairs();
+    void rejectsLoneSurrogates_data();
+    void rejectsLoneSurrogates();
+};
+
+void TestJsonReader::acceptsNumbers_data()
+{
+    QTest::addColumn<QByteArray>("number");
+    QTest::newRow("zero") << QByteArray("0");
+    QTest::newRow("negative zero") << QByteArray("-0");
+    QTest::newRow("integer") << QByteArray("120");
+    QTest::newRow("negative") << QByteArray("-7");
+    QTest::newRow("fraction") << QByteArray("0.5");
+    QTest::newRow("negative fraction") << QByteArray("-12.25");
+    QTest::newRow("exponent") << QByteArray("1e3");
+    QTest::newRow("signed exponent") << QByteArray("2.5E-2");
+    QTest::newRow("plus exponent") << QByteArray("4e+1");
+    QTest::newRow("zero with exponent") << QByteArray("0e0");
+}
+
+// 与 QJsonDocument 解析的值一致
+void TestJsonReader::acceptsNumbers()
+{
+    QFETCH(QByteArray, number);
+    NumberDto dto;
+    QString error;
+    QVERIFY2(JsonReader::decode(numberBody(number), dto, error), qPrintable(error));
+    QCOMPARE(dto.value, QJsonDocument::fromJson(numberBody(number)).object().value("value").toDouble());
+}
+
+void TestJsonReader::rejectsNumbers_data()
+{
+    QTest::addColumn<QByteArray>("number");
+    QTest::newRow("leading zero") << QByteArray("05");
+    QTest::newRow("negative leading zero") << QByteArray("-01");
+    QTest::newRow("trailing dot") << QByteArray("1.");
+    QTest::newRow("leading dot") << QByteArray(".5");
+    QTest::newRow("leading plus") << QByteArray("+1");
+    QTest::newRow("empty exponent") << QByteArray("1e");
+    QTest::newRow("signed empty exponent") << QByteArray("1e-");
+    QTest::newRow("double minus") << QByteArray("--1");
+    QTest::newRow("lone minus") << QByteArray("-");
+    QTest::newRow("dot before exponent") << QByteArray("1.e5");
+    QTest::newRow("two dots") << QByteArray("1.2.3");
+    QTest::newRow("hex") << QByteArray("0x10");
+    QTest::newRow("infinity") << QByteArray("1e999");
+    QTest::newRow("embedded NUL") << QByteArray("1\0" "2", 3);
+    QTest::newRow("trailing NUL") << QByteArray("1\0", 2);
+}
+
+void TestJsonReader::rejectsNumbers()
+{
+    QFETCH(QByteArray, number);
+    NumberDto dto;
+    QString error;
+    QVERIFY(!JsonReader::decode(numberBody(number), dto, error));
+    QVERIFY(!error.isEmpty());
+}
+
+// 未声明的字段同样按 JSON 语法检查，CBOR 转写也走同一个数字解析
+void TestJsonReader::rejectsNumbersInSkippedFields()
+{
+    NumberDto dto;
+    QString error;
+    QVERIFY(JsonReader::decode("{\"other\":[1,-2.5e3],\"value\":1}", dto, error));
+    QVERIFY(!JsonReader::decode("{\"other\":[1,05],\"value\":1}", dto, error));
+    QVERIFY(!JsonReader::decode("{\"other\":+1,\"value\":1}", dto, error));
+
+    QByteArray cbor;
+    QVERIFY(JsonReader::transcodeToCbor("[0,-1,2.5]", cbor));
+    QVERIFY(!JsonReader::transcodeToCbor("[1.]", cbor));
+    QVERIFY(!JsonReader::transcodeToCbor("[05]", cbor));
+}
+
+void TestJsonReader::reportsMissingFields()
+{
+    SpaceDto space;
+    QString error;
+    QVERIFY(!JsonReader::decode("{\"location\":\"A-1\"}", space, error));
+    QCOMPARE(error, QString("Missing required fields: location, rate"));
+
+    NumberDto number;
+    QVERIFY(!JsonReader::decode("{}", number, error));
+    QCOMPARE(error, QString("Missing required field: value"));
+
+    QVERIFY(!JsonReader::decode("[1]", number, error));
+    QCOMPARE(error, QString("Invalid JSON format"));
+}
+
+// 与 QJsonObject::contains() 加 toString()/toInt()/toDouble()/toBool() 一致：字段算已提供，值取默认
+void TestJsonReader::mismatchedTypesUseDefaults()
+{
+    QByteArray body("{\"location\":5,\"rate\":\"5\",\"floor\":1.5,\"covered\":[true]}");
+    SpaceDto space;
+    space.floor = 7;
+    space.covered = true;
+    QString error;
+    QVERIFY2(JsonReader::decode(body, space, error), qPrintable(error));
+
+    QJsonObject json = QJsonDocument::fromJson(body).object();
+    QCOMPARE(space.location, json["location"].toString());
+    QCOMPARE(space.rate, json["rate"].toDouble());
+    QCOMPARE(space.floor, json["floor"].toInt());
+    QCOMPARE(space.covered, json["covered"].toBool());
+
+    SpaceDto nulls;
+    QVERIFY2(JsonReader::decode("{\"location\":null,\"rate\":null}", nulls, error), qPrintable(error));
+    QVERIFY(nulls.location.isEmpty());
+    QCOMPARE(nulls.rate, 0.0);
+}
+
+void TestJsonReader::decodesSurrogatePairs()
+{
+    TextDto dto;
+    QString error;
+    QVERIFY2(JsonReader::decode("{\"text\":\"\\ud83d\\ude97 \\u4eac\"}", dto, error), qPrintable(error));
+    QCOMPARE(dto.text, QString::fromUtf8("\xF0\x9F\x9A\x97 \xE4\xBA\xAC"));
+}
+
+void TestJsonReader::rejectsLoneSurrogates_data()
+{
+    QTest::addColumn<QByteArray>("body");
+    QTest::newRow("lone low") << QByteArray("{\"text\":\"\\udc00\"}");
+    QTest::newRow("low then high") << QByteArray("{\"text\":\"\\ude97\\ud83d\"}");
+    QTest::newRow("lone high") << QByteArray("{\"text\":\"\\ud83d\"}");
+    QTest::newRow("high then text") << QByteArray("{\"text\":\"\\ud83dA\"}");
+    QTest::newRow("high then high") << QByteArray("{\"text\":\"\\ud83d\\ud83d\"}");
+}
+
+void TestJsonReader::rejectsLoneSurrogates()
+{
+    QFETCH(QByteArray, body);
+    TextDto dto;
+    QString error;
+    QVERIFY(!JsonReader::decode(body, dto, error));
+}
+
+QTEST_APPLESS_MAIN(TestJsonReader)
+
+#include "tst_jsonreader.moc"
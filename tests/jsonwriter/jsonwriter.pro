@@ -0,0 +1,14 @@
+include(../tests.pri)
+
+TARGET = tst_jsonwriter
+
+SOURCES += \
+    tst_jsonwriter.cpp \
+    ../common/AllocationCounter.cpp \
+    $$SRC_DIR/core/JsonWriter.cpp \
+    $$SRC_DIR/api/ApiResponse.cpp
+
+HEADERS += \
+    ../common/AllocationCounter.h \
+    $$SRC_DIR/core/JsonWriter.h \
+    $$SRC_DIR/api/ApiResponse.h
@@ -0,0 +1,274 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QVector>
+#include "../common/AllocationCounter.h"
+#include "core/JsonWriter.h"
+#include "api/ApiResponse.h"
+
+namespace {
+
+// 与 ParkingRecord 序列化字段一致的测试数据，避免依赖数据库
+struct Row {
+    int id;
+    QString plate;
+    int spaceId;
+    QString startTime;
+    QString endTime;
+    double fee;
+    bool paid;
+    QString method;
+};
+
+QVector<Row> generateRows(int count)
+{
+    QRandomGenerator random(42);
+    QVector<Row> rows;
+    rows.reserve(count);
+    QDateTime base(QDate(2024, 1, 1), QTime(8, 0));
+    for (int i = 0; i < count; ++i) {
+        QDateTime enter = base.addSecs(random.bounded(30 * 24 * 3600));
+        bool exited = random.bounded(4) != 0;
+        Row row;
+        row.id = i + 1;
+        row.plate = QString::fromUtf8("京A%1").arg(10000 + random.bounded(90000));
+        row.spaceId = 1 + random.bounded(500);
+        row.startTime = enter.toString(Qt::ISODate);
+        row.endTime = exited ? enter.addSecs(600 + random.bounded(8 * 3600)).toString(Qt::ISODate) : QString();
+        row.fee = exited ? random.bounded(1, 20) * 5.0 + (random.bounded(2) ? 0.5 : 0.0) : 0.0;
+        row.paid = exited && random.bounded(3) != 0;
+        row.method = row.paid ? QString("mobile") : QString();
+        rows.append(row);
+    }
+    return rows;
+}
+
+// 替换前的路径：构建 QJsonObject 树，经 ApiResponse 包装后 QJsonDocument::toJson
+QByteArray encodeWithDom(const QVector<Row>& rows)
+{
+    QJsonArray array;
+    for (const Row& row : rows) {
+        QJsonObject json;
+        json["id"] = row.id;
+        json["plate"] = row.plate;
+        json["spaceId"] = row.spaceId;
+        json["startTime"] = row.startTime;
+        json["endTime"] = row.endTime;
+        json["fee"] = row.fee;
+        json["paidAmount"] = row.fee;
+        json["paymentStatus"] = row.paid ? "paid" : "unpaid";
+        json["paymentMethod"] = row.method;
+        json["createdAt"] = row.startTime;
+        array.append(json);
+    }
+    QJsonObject data;
+    data["count"] = rows.size();
+    data["data"] = array;
+    data["message"] = "Records retrieved successfully";
+    data["success"] = true;
+    return QJsonDocument(ApiResponse::success(data)).toJson(QJsonDocument::Compact);
+}
+
+void writeRow(JsonWriter& writer, const Row& row)
+{
+    writer.beginObject();
+    writer.field("createdAt", row.startTime);
+    writer.field("endTime", row.endTime);
+    writer.field("fee", row.fee);
+    writer.field("id", row.id);
+    writer.field("paidAmount", row.fee);
+    writer.field("paymentMethod", row.method);
+    writer.field("paymentStatus", row.paid ? "paid" : "unpaid");
+    writer.field("plate", row.plate);
+    writer.field("spaceId", row.spaceId);
+    writer.field("startTime", row.startTime);
+    writer.endObject();
+}
+
+// 游标路径：条数在写完后补写
+QByteArray encodeWithDeferredCount(const QVector<Row>& rows)
+{
+    QByteArray out;
+    JsonWriter writer(out);
+    writer.beginApiList();
+    for (const Row& row : rows) {
+        writeRow(writer, row);
+    }
+    writer.endApiList("Records retrieved successfully", rows.size());
+    return out;
+}
+
+// 现在的路径：JsonWriter 按字母序写键，直接追加到响应缓冲区
+QByteArray encodeWithWriter(const QVector<Row>& rows)
+{
+    QByteArray out;
+    out.reserve(rows.size() * 256 + 128);
+    JsonWriter writer(out);
+    writer.beginApiList(rows.size());
+    for (const Row& row : rows) {
+        writeRow(writer, row);
+    }
+    writer.endApiList("Records retrieved successfully");
+    return out;
+}
+
+}
+
+class TestJsonWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesQJsonDocument_data();
+    void matchesQJsonDocument();
+    void deferredCountMatches_data();
+    void deferredCountMatches();
+    void escapesStrings();
+
+    void bytesAllocated_data();
+    void bytesAllocatedDom();
+    void bytesAllocatedWriter();
+    void compareAllocations_data();
+    void compareAllocations();
+
+    void benchmarkDom();
+    void benchmarkWriter();
+};
+
+void TestJsonWriter::matchesQJsonDocument_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::newRow("empty") << 0;
+    QTest::newRow("one") << 1;
+    QTest::newRow("thousand") << 1000;
+}
+
+void TestJsonWriter::matchesQJsonDocument()
+{
+    QFETCH(int, rows);
+    QVector<Row> data = generateRows(rows);
+    QCOMPARE(encodeWithWriter(data), encodeWithDom(data));
+}
+
+void TestJsonWriter::deferredCountMatches_data()
+{
+    matchesQJsonDocument_data();
+}
+
+void TestJsonWriter::deferredCountMatches()
+{
+    QFETCH(int, rows);
+    QVector<Row> data = generateRows(rows);
+    QCOMPARE(encodeWithDeferredCount(data), encodeWithDom(data));
+}
+
+void TestJsonWriter::escapesStrings()
+{
+    QString text = QString::fromUtf8("引号\" 反斜杠\\ 换行\n 制表\t 控制\x01 汉字");
+    QByteArray out;
+    JsonWriter writer(out);
+    writer.beginObject();
+    writer.field("large", qint64(1) << 40);
+    writer.field("negative", -1.25);
+    writer.field("text", text);
+    writer.endObject();
+
+    QJsonObject expected;
+    expected["text"] = text;
+    expected["negative"] = -1.25;
+    expected["large"] = qint64(1) << 40;
+
+    // 键按字母序写入，转义方式与 QJsonDocument 相同，逐字节一致
+    QCOMPARE(out, QJsonDocument(expected).toJson(QJsonDocument::Compact));
+}
+
+void TestJsonWriter::bytesAllocated_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::newRow("100 records") << 100;
+    QTest::newRow("1000 records") << 1000;
+    QTest::newRow("10000 records") << 10000;
+}
+
+// 单次响应的分配字节数，以 BytesAllocated 指标输出（-median 等参数不影响该值）
+void TestJsonWriter::bytesAllocatedDom()
+{
+    if (!AllocationCounter::isSupported()) {
+        QSKIP("Allocation counting requires glibc");
+    }
+    QFETCH(int, rows);
+    QVector<Row> data = generateRows(rows);
+    AllocationCounter counter;
+    QByteArray body = encodeWithDom(data);
+    qint64 bytes = counter.bytes();
+    QVERIFY(!body.isEmpty());
+    QTest::setBenchmarkResult(bytes, QTest::BytesAllocated);
+}
+
+void TestJsonWriter::bytesAllocatedWriter()
+{
+    if (!AllocationCounter::isSupported()) {
+        QSKIP("Allocation counting requires glibc");
+    }
+    QFETCH(int, rows);
+    QVector<Row> data = generateRows(rows);
+    AllocationCounter counter;
+    QByteArray body = encodeWithWriter(data);
+    qint64 bytes = counter.bytes();
+    QVERIFY(!body.isEmpty());
+    QTest::setBenchmarkResult(bytes, QTest::BytesAllocated);
+}
+
+void TestJsonWriter::compareAllocations_data()
+{
+    bytesAllocated_data();
+}
+
+void TestJsonWriter::compareAllocations()
+{
+    if (!AllocationCounter::isSupported()) {
+        QSKIP("Allocation counting requires glibc");
+    }
+    QFETCH(int, rows);
+    QVector<Row> data = generateRows(rows);
+
+    AllocationCounter domCounter;
+    QByteArray domBody = encodeWithDom(data);
+    qint64 domBytes = domCounter.bytes();
+    qint64 domCount = domCounter.count();
+
+    AllocationCounter writerCounter;
+    QByteArray writerBody = encodeWithWriter(data);
+    qint64 writerBytes = writerCounter.bytes();
+    qint64 writerCount = writerCounter.count();
+
+    qInfo("%d records, %d bytes body: DOM %lld bytes in %lld allocations, writer %lld bytes in %lld allocations",
+          rows, writerBody.size(), domBytes, domCount, writerBytes, writerCount);
+    QCOMPARE(writerBody, domBody);
+    QVERIFY(writerBytes < domBytes);
+    QVERIFY(writerCount < domCount);
+}
+
+void TestJsonWriter::benchmarkDom()
+{
+    QVector<Row> data = generateRows(1000);
+    QBENCHMARK {
+        QByteArray body = encodeWithDom(data);
+        Q_UNUSED(body);
+    }
+}
+
+void TestJsonWriter::benchmarkWriter()
+{
+    QVector<Row> data = generateRows(1000);
+    QBENCHMARK {
+        QByteArray body = encodeWithWriter(data);
+        Q_UNUSED(body);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestJsonWriter)
+
+#include "tst_jsonwriter.moc"
@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_plateid
+
+SOURCES += \
+    tst_plateid.cpp \
+    $$SRC_DIR/utils/PlateId.cpp
+
+HEADERS += \
+    $$SRC_DIR/utils/PlateId.h
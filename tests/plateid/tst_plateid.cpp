@@ -0,0 +1,174 @@
+#include <QtTest>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+#include "utils/PlateId.h"
+
+namespace {
+
+const int CORPUS_SIZE = 100000;
+const char ALNUM[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// 固定种子生成 7 位和 8 位车牌，汉字覆盖整个 CJK 基本区间
+QStringList generatePlates(int count)
+{
+    QRandomGenerator random(20240101);
+    QStringList plates;
+    plates.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        int length = random.bounded(4) == 0 ? 8 : 7;
+        QString plate(length, Qt::Uninitialized);
+        plate[0] = QChar(static_cast<ushort>(0x4E00 + random.bounded(0x9FA5 - 0x4E00 + 1)));
+        plate[1] = QChar(static_cast<ushort>('A' + random.bounded(26)));
+        for (int j = 2; j < length; ++j) {
+            plate[j] = QChar(ALNUM[random.bounded(36)]);
+        }
+        plates.append(plate);
+    }
+    return plates;
+}
+
+}
+
+class TestPlateId : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void roundTrip();
+    void preservesOrdering();
+    void rejectsInvalid_data();
+    void rejectsInvalid();
+
+    void benchmarkParse();
+    void benchmarkFormat();
+    void benchmarkParseQStringBaseline();
+    void benchmarkLookupPlateId();
+    void benchmarkLookupQString();
+
+private:
+    QStringList m_plates;
+    QVector<PlateId> m_ids;
+};
+
+void TestPlateId::initTestCase()
+{
+    m_plates = generatePlates(CORPUS_SIZE);
+    m_ids.reserve(m_plates.size());
+    for (const QString& plate : m_plates) {
+        m_ids.append(PlateId::fromString(plate));
+    }
+}
+
+void TestPlateId::roundTrip()
+{
+    for (int i = 0; i < m_plates.size(); ++i) {
+        QVERIFY2(m_ids[i].isValid(), qPrintable(m_plates[i]));
+        QCOMPARE(m_ids[i].length(), m_plates[i].size());
+        QCOMPARE(m_ids[i].toString(), m_plates[i]);
+    }
+}
+
+void TestPlateId::preservesOrdering()
+{
+    // 相邻比较覆盖等长和 7/8 位混合的情况
+    for (int i = 1; i < m_plates.size(); ++i) {
+        const QString& a = m_plates[i - 1];
+        const QString& b = m_plates[i];
+        QCOMPARE(m_ids[i - 1] < m_ids[i], a < b);
+        QCOMPARE(m_ids[i - 1] == m_ids[i], a == b);
+    }
+}
+
+void TestPlateId::rejectsInvalid_data()
+{
+    QTest::addColumn<QString>("plate");
+
+    QTest::newRow("empty") << QString();
+    QTest::newRow("too short") << QString::fromUtf8("京A1234");
+    QTest::newRow("too long") << QString::fromUtf8("京A1234567");
+    QTest::newRow("no han") << QString("AA12345");
+    QTest::newRow("lowercase letter") << QString::fromUtf8("京a12345");
+    QTest::newRow("digit second") << QString::fromUtf8("京112345");
+    QTest::newRow("lowercase tail") << QString::fromUtf8("京A1234b");
+    QTest::newRow("fullwidth digit") << QString::fromUtf8("京A1234５");
+    QTest::newRow("trailing space") << QString::fromUtf8("京A12345 ");
+}
+
+void TestPlateId::rejectsInvalid()
+{
+    QFETCH(QString, plate);
+    QVERIFY(!PlateId::fromString(plate).isValid());
+}
+
+void TestPlateId::benchmarkParse()
+{
+    quint64 checksum = 0;
+    QBENCHMARK {
+        for (const QString& plate : m_plates) {
+            checksum += PlateId::fromString(plate).value();
+        }
+    }
+    QVERIFY(checksum != 0);
+}
+
+void TestPlateId::benchmarkFormat()
+{
+    int length = 0;
+    QBENCHMARK {
+        for (const PlateId& id : m_ids) {
+            length += id.toString().size();
+        }
+    }
+    QVERIFY(length > 0);
+}
+
+void TestPlateId::benchmarkParseQStringBaseline()
+{
+    // 对照：以 QString 作键时每次查找都要做的深拷贝和哈希
+    uint checksum = 0;
+    QBENCHMARK {
+        for (const QString& plate : m_plates) {
+            QString key(plate.constData(), plate.size());
+            checksum += qHash(key);
+        }
+    }
+    Q_UNUSED(checksum);
+}
+
+void TestPlateId::benchmarkLookupPlateId()
+{
+    QHash<PlateId, int> table;
+    for (int i = 0; i < m_ids.size(); ++i) {
+        table.insert(m_ids[i], i);
+    }
+    qint64 sum = 0;
+    QBENCHMARK {
+        for (const PlateId& id : m_ids) {
+            sum += table.value(id);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+void TestPlateId::benchmarkLookupQString()
+{
+    QHash<QString, int> table;
+    for (int i = 0; i < m_plates.size(); ++i) {
+        table.insert(m_plates[i], i);
+    }
+    qint64 sum = 0;
+    QBENCHMARK {
+        for (const QString& plate : m_plates) {
+            sum += table.value(plate);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+QTEST_APPLESS_MAIN(TestPlateId)
+
+#include "tst_plateid.moc"
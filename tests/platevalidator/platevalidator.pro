@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_platevalidator
+
+SOURCES += \
+    tst_platevalidator.cpp \
+    $$SRC_DIR/utils/PlateValidator.cpp
+
+HEADERS += \
+    $$SRC_DIR/utils/PlateValidator.h
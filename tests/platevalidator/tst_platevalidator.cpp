@@ -0,0 +1,262 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QStringList>
+#include "utils/PlateValidator.h"
+
+namespace {
+
+const int CORPUS_SIZE = 200000;
+
+// 替换前 SpaceService/BillingService/CarService 使用的正则
+const QRegularExpression& legacyRegex()
+{
+    static QRegularExpression reg(R"(^[\x{4e00}-\x{9fa5}][A-Z][A-Z0-9]{5}$)");
+    return reg;
+}
+
+// 每个位置的候选字符：合法字符、区间边界、易混淆字符和空白
+QString randomChar(QRandomGenerator& random)
+{
+    static const ushort SPECIAL[] = {
+        0x4DFF, 0x4E00, 0x9FA5, 0x9FA6,          // 汉字区间边界
+        '@', '[', '`', '{', '/', ':',            // 紧邻 A-Z、a-z、0-9 的 ASCII
+        ' ', '\t', '\r', '\n', 0x3000, 0x00A0,   // 空白
+        '-', '.', 0x00B7,                        // 分隔符
+        0xFF10, 0xFF21, 0xFF41,                  // 全角 ０ Ａ ａ
+        0x00C0, 0x0410                           // 拉丁和西里尔大写字母
+    };
+
+    switch (random.bounded(8)) {
+    case 0:
+        return QString(QChar(static_cast<ushort>(0x4E00 + random.bounded(0x9FA5 - 0x4E00 + 1))));
+    case 1:
+    case 2:
+        return QString(QChar(static_cast<ushort>('A' + random.bounded(26))));
+    case 3:
+    case 4:
+        return QString(QChar(static_cast<ushort>('0' + random.bounded(10))));
+    case 5:
+        return QString(QChar(static_cast<ushort>('a' + random.bounded(26))));
+    case 6: {
+        // 合法代理对（基本平面以外的字符）
+        uint codePoint = 0x10000 + random.bounded(0x100000);
+        return QString::fromUcs4(&codePoint, 1);
+    }
+    default:
+        return QString(QChar(SPECIAL[random.bounded(static_cast<int>(sizeof(SPECIAL) / sizeof(SPECIAL[0])))]));
+    }
+}
+
+QString validClassic(QRandomGenerator& random)
+{
+    static const char ALNUM[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    QString plate(QChar(static_cast<ushort>(0x4E00 + random.bounded(0x9FA5 - 0x4E00 + 1))));
+    plate.append(QChar(static_cast<ushort>('A' + random.bounded(26))));
+    for (int i = 0; i < 5; ++i) {
+        plate.append(QChar(ALNUM[random.bounded(36)]));
+    }
+    return plate;
+}
+
+// 三分之一为合法车牌，三分之一为合法车牌的单点变异（替换、插入、删除、前后缀），其余为随机串
+QStringList generateCorpus(int count)
+{
+    QRandomGenerator random(20240229);
+    QStringList corpus;
+    corpus.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        int kind = random.bounded(3);
+        if (kind == 0) {
+            corpus.append(validClassic(random));
+        } else if (kind == 1) {
+            QString plate = validClassic(random);
+            int position = random.bounded(plate.size() + 1);
+            switch (random.bounded(5)) {
+            case 0:
+                plate.replace(qMin(position, plate.size() - 1), 1, randomChar(random));
+                break;
+            case 1:
+                plate.insert(position, randomChar(random));
+                break;
+            case 2:
+                plate.remove(qMin(position, plate.size() - 1), 1);
+                break;
+            case 3:
+                plate.prepend(randomChar(random));
+                break;
+            default:
+                plate.append(randomChar(random));
+                break;
+            }
+            corpus.append(plate);
+        } else {
+            QString text;
+            int length = random.bounded(10);
+            for (int j = 0; j < length; ++j) {
+                text.append(randomChar(random));
+            }
+            corpus.append(text);
+        }
+    }
+    return corpus;
+}
+
+}
+
+class TestPlateValidator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void agreesWithLegacyRegex();
+    void normalizeAcceptsLegacyInput();
+    void normalize_data();
+    void normalize();
+    void newEnergy_data();
+    void newEnergy();
+
+    void benchmarkLegacyRegex();
+    void benchmarkValidator();
+    void benchmarkLegacyTrimUpper();
+    void benchmarkNormalize();
+
+private:
+    QStringList m_corpus;
+};
+
+void TestPlateValidator::initTestCase()
+{
+    m_corpus = generateCorpus(CORPUS_SIZE);
+}
+
+void TestPlateValidator::agreesWithLegacyRegex()
+{
+    int accepted = 0;
+    for (const QString& text : m_corpus) {
+        bool expected = legacyRegex().match(text).hasMatch();
+        QVERIFY2(PlateValidator::isValidClassic(text) == expected,
+                 qPrintable(QString("mismatch on \"%1\" (%2), regex=%3")
+                            .arg(text, QString::fromLatin1(text.toUtf8().toHex())).arg(expected)));
+        if (expected) {
+            accepted++;
+        }
+    }
+    // 语料需同时覆盖接受和拒绝两种情况
+    QVERIFY(accepted > CORPUS_SIZE / 10);
+    QVERIFY(accepted < CORPUS_SIZE / 2);
+}
+
+void TestPlateValidator::normalizeAcceptsLegacyInput()
+{
+    // 原控制器先 trimmed().toUpper() 再匹配正则；凡是原来能通过的输入，规范化后仍须通过且结果相同
+    for (const QString& text : m_corpus) {
+        QString legacy = text.trimmed().toUpper();
+        if (!legacyRegex().match(legacy).hasMatch()) {
+            continue;
+        }
+        QString normalized = PlateValidator::normalize(text);
+        QVERIFY2(PlateValidator::isValid(normalized), qPrintable(text));
+        QCOMPARE(normalized, legacy);
+    }
+}
+
+void TestPlateValidator::normalize_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("plain") << QString::fromUtf8("京A12345") << QString::fromUtf8("京A12345");
+    QTest::newRow("crlf") << QString::fromUtf8("京A12345\r\n") << QString::fromUtf8("京A12345");
+    QTest::newRow("cr") << QString::fromUtf8("京A12345\r") << QString::fromUtf8("京A12345");
+    QTest::newRow("leading newline") << QString::fromUtf8("\n京A12345") << QString::fromUtf8("京A12345");
+    QTest::newRow("tabs") << QString::fromUtf8("\t京A12345\t") << QString::fromUtf8("京A12345");
+    QTest::newRow("vertical tab and form feed") << QString::fromUtf8("京A12345\v\f") << QString::fromUtf8("京A12345");
+    QTest::newRow("nbsp") << (QString::fromUtf8("京A") + QChar(0x00A0) + "12345") << QString::fromUtf8("京A12345");
+    QTest::newRow("ideographic space") << (QString::fromUtf8("京A") + QChar(0x3000) + "12345") << QString::fromUtf8("京A12345");
+    QTest::newRow("separators") << QString::fromUtf8("京A-123.45") << QString::fromUtf8("京A12345");
+    QTest::newRow("middle dot") << (QString::fromUtf8("京A") + QChar(0x00B7) + "12345") << QString::fromUtf8("京A12345");
+    QTest::newRow("fullwidth") << QString::fromUtf8("京Ａ１２３４５") << QString::fromUtf8("京A12345");
+    QTest::newRow("lowercase") << QString::fromUtf8("京a1234b") << QString::fromUtf8("京A1234B");
+}
+
+void TestPlateValidator::normalize()
+{
+    QFETCH(QString, input);
+    QFETCH(QString, expected);
+    QCOMPARE(PlateValidator::normalize(input), expected);
+    QVERIFY(PlateValidator::isValid(PlateValidator::normalize(input)));
+}
+
+void TestPlateValidator::newEnergy_data()
+{
+    QTest::addColumn<QString>("plate");
+    QTest::addColumn<bool>("valid");
+
+    QTest::newRow("small D") << QString::fromUtf8("京AD12345") << true;
+    QTest::newRow("small F alnum") << QString::fromUtf8("粤BFA1234") << true;
+    QTest::newRow("large D") << QString::fromUtf8("沪A12345D") << true;
+    QTest::newRow("large F") << QString::fromUtf8("苏E12345F") << true;
+    QTest::newRow("not province") << QString::fromUtf8("一AD12345") << false;
+    QTest::newRow("small letter tail") << QString::fromUtf8("京AD1234X") << false;
+    QTest::newRow("large no mark") << QString::fromUtf8("京A123456") << false;
+    QTest::newRow("large letter body") << QString::fromUtf8("京A1234XD") << false;
+    QTest::newRow("seven chars") << QString::fromUtf8("京AD1234") << false;
+}
+
+void TestPlateValidator::newEnergy()
+{
+    QFETCH(QString, plate);
+    QFETCH(bool, valid);
+    QCOMPARE(PlateValidator::isNewEnergy(plate), valid);
+}
+
+void TestPlateValidator::benchmarkLegacyRegex()
+{
+    int accepted = 0;
+    QBENCHMARK {
+        for (const QString& text : m_corpus) {
+            accepted += legacyRegex().match(text).hasMatch();
+        }
+    }
+    QVERIFY(accepted > 0);
+}
+
+void TestPlateValidator::benchmarkValidator()
+{
+    int accepted = 0;
+    QBENCHMARK {
+        for (const QString& text : m_corpus) {
+            accepted += PlateValidator::isValidClassic(text);
+        }
+    }
+    QVERIFY(accepted > 0);
+}
+
+void TestPlateValidator::benchmarkLegacyTrimUpper()
+{
+    int length = 0;
+    QBENCHMARK {
+        for (const QString& text : m_corpus) {
+            length += text.trimmed().toUpper().size();
+        }
+    }
+    QVERIFY(length > 0);
+}
+
+void TestPlateValidator::benchmarkNormalize()
+{
+    int length = 0;
+    QBENCHMARK {
+        for (const QString& text : m_corpus) {
+            length += PlateValidator::normalize(text).size();
+        }
+    }
+    QVERIFY(length > 0);
+}
+
+QTEST_APPLESS_MAIN(TestPlateValidator)
+
+#include "tst_platevalidator.moc"
@@ -0,0 +1,14 @@
+include(../tests.pri)
+
+QT += concurrent
+
+TARGET = tst_reportexecutor
+
+SOURCES += \
+    tst_reportexecutor.cpp \
+    $$SRC_DIR/services/ReportExecutor.cpp \
+    $$SRC_DIR/utils/Logger.cpp
+
+HEADERS += \
+    $$SRC_DIR/services/ReportExecutor.h \
+    $$SRC_DIR/utils/Logger.h
@@ -0,0 +1,154 @@
+#include <QtTest>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QThread>
+#include <memory>
+#include "services/ReportExecutor.h"
+
+namespace {
+
+const int DEADLINE_MS = 200;
+const int DRAIN_TIMEOUT_MS = 5000;
+const int STEP_MS = 20;
+const int SLOW_STEPS = 500;   // 不取消时约 10 秒
+
+ReportExecutor::Task fastTask(int value)
+{
+    return [value](const ReportExecutor::Cancellation&) -> QJsonValue {
+        return value;
+    };
+}
+
+qint64 statistic(const char* name)
+{
+    return ReportExecutor::instance().statistics().value(name).toVariant().toLongLong();
+}
+
+int activeThreads()
+{
+    return ReportExecutor::instance().statistics().value("activeThreads").toInt();
+}
+
+}
+
+class TestReportExecutor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void allTasksComplete();
+    void slowTaskIsCancelledAfterDeadline();
+    void failedTaskIsReported();
+    void rejectsWhenThreadsBusy();
+};
+
+void TestReportExecutor::allTasksComplete()
+{
+    ReportExecutor::TaskList tasks;
+    tasks.append({"a", fastTask(1)});
+    tasks.append({"b", fastTask(2)});
+
+    ReportExecutor::Outcome outcome = ReportExecutor::instance().run(tasks, DEADLINE_MS);
+    QVERIFY(!outcome.rejected);
+    QVERIFY(!outcome.isPartial());
+    QCOMPARE(outcome.results.value("a").toInt(), 1);
+    QCOMPARE(outcome.results.value("b").toInt(), 2);
+    QVERIFY(outcome.timings.contains("a"));
+}
+
+// 一个子报表逐步执行（模拟多次查询），截止时间到达后调用方立即返回部分结果，子报表在下一步前结束
+void TestReportExecutor::slowTaskIsCancelledAfterDeadline()
+{
+    auto steps = std::make_shared<QAtomicInt>(0);
+    auto stopped = std::make_shared<QAtomicInt>(0);
+    qint64 cancelledBefore = statistic("cancelled");
+
+    ReportExecutor::TaskList tasks;
+    tasks.append({"fast", fastTask(1)});
+    tasks.append({"slow", [steps, stopped](const ReportExecutor::Cancellation& cancellation) -> QJsonValue {
+        for (int i = 0; i < SLOW_STEPS; ++i) {
+            if (cancellation.isCancelled()) {
+                stopped->storeRelease(1);
+            }
+            cancellation.throwIfCancelled();
+            steps->fetchAndAddRelaxed(1);
+            QThread::msleep(STEP_MS);
+        }
+        return true;
+    }});
+
+    QElapsedTimer timer;
+    timer.start();
+    ReportExecutor::Outcome outcome = ReportExecutor::instance().run(tasks, DEADLINE_MS);
+    qint64 elapsed = timer.elapsed();
+
+    QVERIFY(!outcome.rejected);
+    QVERIFY(outcome.isPartial());
+    QCOMPARE(outcome.results.value("fast").toInt(), 1);
+    QVERIFY(!outcome.results.contains("slow"));
+    QCOMPARE(outcome.timedOut, QJsonArray{"slow"});
+    QVERIFY(outcome.failed.isEmpty());
+    QVERIFY2(elapsed < DEADLINE_MS + 1000, qPrintable(QString("returned after %1 ms").arg(elapsed)));
+
+    // 子报表在取消后的第一步结束，线程归还线程池
+    QTRY_COMPARE_WITH_TIMEOUT(stopped->loadAcquire(), 1, DRAIN_TIMEOUT_MS);
+    QTRY_COMPARE_WITH_TIMEOUT(activeThreads(), 0, DRAIN_TIMEOUT_MS);
+    QCOMPARE(statistic("cancelled"), cancelledBefore + 1);
+    QVERIFY(steps->loadAcquire() < SLOW_STEPS);
+}
+
+void TestReportExecutor::failedTaskIsReported()
+{
+    ReportExecutor::TaskList tasks;
+    tasks.append({"ok", fastTask(1)});
+    tasks.append({"broken", [](const ReportExecutor::Cancellation&) -> QJsonValue {
+        throw std::runtime_error("query failed");
+    }});
+
+    ReportExecutor::Outcome outcome = ReportExecutor::instance().run(tasks, DEADLINE_MS);
+    QVERIFY(outcome.isPartial());
+    QCOMPARE(outcome.failed, QJsonArray{"broken"});
+    QVERIFY(outcome.timedOut.isEmpty());
+    QCOMPARE(outcome.results.value("ok").toInt(), 1);
+}
+
+// 不检查取消的子报表在超时后继续占用全部线程，新的执行立即被拒绝而不排队
+void TestReportExecutor::rejectsWhenThreadsBusy()
+{
+    QTRY_COMPARE_WITH_TIMEOUT(activeThreads(), 0, DRAIN_TIMEOUT_MS);
+    auto release = std::make_shared<QSemaphore>(0);
+    qint64 rejectedBefore = statistic("rejected");
+
+    ReportExecutor::TaskList blocking;
+    for (int i = 0; i < ReportExecutor::MAX_THREADS; ++i) {
+        blocking.append({QString("blocking %1").arg(i), [release](const ReportExecutor::Cancellation&) -> QJsonValue {
+            release->acquire();
+            return true;
+        }});
+    }
+    ReportExecutor::Outcome first = ReportExecutor::instance().run(blocking, 50);
+    QVERIFY(!first.rejected);
+    QCOMPARE(first.timedOut.size(), ReportExecutor::MAX_THREADS);
+
+    ReportExecutor::TaskList tasks;
+    tasks.append({"fast", fastTask(1)});
+    QElapsedTimer timer;
+    timer.start();
+    ReportExecutor::Outcome outcome = ReportExecutor::instance().run(tasks, DEADLINE_MS);
+    QVERIFY(outcome.rejected);
+    QVERIFY(outcome.results.isEmpty());
+    QVERIFY2(timer.elapsed() < DEADLINE_MS, qPrintable(QString("rejected after %1 ms").arg(timer.elapsed())));
+    QCOMPARE(statistic("rejected"), rejectedBefore + 1);
+
+    release->release(ReportExecutor::MAX_THREADS);
+    QTRY_COMPARE_WITH_TIMEOUT(activeThreads(), 0, DRAIN_TIMEOUT_MS);
+
+    outcome = ReportExecutor::instance().run(tasks, DEADLINE_MS);
+    QVERIFY(!outcome.rejected);
+    QCOMPARE(outcome.results.value("fast").toInt(), 1);
+}
+
+QTEST_GUILESS_MAIN(TestReportExecutor)
+
+#include "tst_reportexecutor.moc"
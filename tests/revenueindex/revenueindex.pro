@@ -0,0 +1,33 @@
+include(../tests.pri)
+
+QT += sql
+
+TARGET = tst_revenueindex
+
+SOURCES += \
+    tst_revenueindex.cpp \
+    $$SRC_DIR/dao/RevenueIndex.cpp \
+    $$SRC_DIR/dao/DatabaseSchema.cpp \
+    $$SRC_DIR/dao/RollupRepository.cpp \
+    $$SRC_DIR/dao/ParkingRecordRepository.cpp \
+    $$SRC_DIR/dao/ParkingRecordCursor.cpp \
+    $$SRC_DIR/dao/ActiveSessionIndex.cpp \
+    $$SRC_DIR/models/ParkingRecord.cpp \
+    $$SRC_DIR/utils/DataVersion.cpp \
+    $$SRC_DIR/utils/DateTimeUtil.cpp \
+    $$SRC_DIR/utils/Logger.cpp \
+    $$SRC_DIR/utils/PlateId.cpp
+
+HEADERS += \
+    $$SRC_DIR/dao/RevenueIndex.h \
+    $$SRC_DIR/dao/DatabaseSchema.h \
+    $$SRC_DIR/dao/RollupRepository.h \
+    $$SRC_DIR/dao/ParkingRecordRepository.h \
+    $$SRC_DIR/dao/ParkingRecordCursor.h \
+    $$SRC_DIR/dao/ActiveSessionIndex.h \
+    $$SRC_DIR/dao/WriteResult.h \
+    $$SRC_DIR/models/ParkingRecord.h \
+    $$SRC_DIR/utils/DataVersion.h \
+    $$SRC_DIR/utils/DateTimeUtil.h \
+    $$SRC_DIR/utils/Logger.h \
+    $$SRC_DIR/utils/PlateId.h
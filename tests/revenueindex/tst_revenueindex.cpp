@@ -0,0 +1,284 @@
+#include <QtTest>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QVector>
+#include <algorithm>
+#include "dao/DatabaseSchema.h"
+#include "dao/RevenueIndex.h"
+#include "dao/ParkingRecordRepository.h"
+
+namespace {
+
+const char* const ORACLE_CONNECTION = "tst_revenueindex";
+const int RECORD_COUNT = 1000;
+const int SPACE_COUNT = 20;
+const int DATA_DAYS = 14;
+
+// 记录的进场时间分布在 [baseTime, baseTime + DATA_DAYS 天)，选在各地都没有夏令时切换的时段
+QDateTime baseTime()
+{
+    return QDateTime(QDate(2024, 6, 3), QTime(0, 0));
+}
+
+// 随机范围：起止点精确到毫秒，覆盖数据之前、之后和跨越整个数据区间的情况
+QVector<QPair<QDateTime, QDateTime>> generateRanges(int count, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QVector<QPair<QDateTime, QDateTime>> ranges;
+    ranges.reserve(count);
+    QDateTime from = baseTime().addDays(-1);
+    qint64 spanMSecs = qint64(DATA_DAYS + 2) * 24 * 3600 * 1000;
+    for (int i = 0; i < count; ++i) {
+        QDateTime start = from.addMSecs(random.bounded(spanMSecs));
+        QDateTime end = start.addMSecs(random.bounded(qint64(5) * 24 * 3600 * 1000));
+        ranges.append(qMakePair(start, end));
+    }
+    return ranges;
+}
+
+}
+
+class TestRevenueIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void matchesSql_data();
+    void matchesSql();
+    void wholeHoursReadOnlyIndex();
+    void matchesSqlAfterReload();
+
+    void benchmarkSumRange();
+    void benchmarkSql();
+
+private:
+    RevenueIndex::Sums sqlSums(const QDateTime& startTime, const QDateTime& endTime);
+    RevenueIndex::Sums indexSums(const QDateTime& startTime, const QDateTime& endTime);
+    void compareRange(const QDateTime& startTime, const QDateTime& endTime);
+    void populate();
+
+    QTemporaryDir m_dir;
+    QString m_previousDir;
+    QVector<QDateTime> m_enterTimes;
+    QDateTime m_latestEnter;          // 写入过的最晚进场时间（含已删除的记录）
+};
+
+void TestRevenueIndex::initTestCase()
+{
+    // 各仓库固定读取 <当前目录>/data/parking_server.db
+    QVERIFY(m_dir.isValid());
+    m_previousDir = QDir::currentPath();
+    QVERIFY(QDir(m_dir.path()).mkpath("data"));
+    QVERIFY(QDir::setCurrent(m_dir.path()));
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", ORACLE_CONNECTION);
+        db.setDatabaseName(QDir::currentPath() + "/data/parking_server.db");
+        QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+        // 与服务启动时相同的建表和升级流程；空库建表后汇总表即标记为已就绪
+        QVERIFY(DatabaseSchema::create(db));
+        QSqlQuery query(db);
+        for (int i = 1; i <= SPACE_COUNT; ++i) {
+            query.prepare("INSERT INTO parking_spaces (location, type) VALUES (?, ?)");
+            query.addBindValue(QString("%1-%2").arg(QChar('A' + i % 3)).arg(i));
+            query.addBindValue(i % 4 == 0 ? QString::fromUtf8("VIP") : QString::fromUtf8("普通"));
+            QVERIFY2(query.exec(), qPrintable(query.lastError().text()));
+        }
+    }
+
+    // 空库加载，之后的记录全部经由增量更新进入索引
+    QVERIFY(RevenueIndex::instance().load());
+    populate();
+}
+
+void TestRevenueIndex::cleanupTestCase()
+{
+    QSqlDatabase::removeDatabase(ORACLE_CONNECTION);
+    QDir::setCurrent(m_previousDir);
+}
+
+// 插入、出场计费、支付和删除都经由 ParkingRecordRepository，与服务中的写入路径相同
+// 进场时间乱序写入，早于索引起点的记录会触发桶的整体后移
+void TestRevenueIndex::populate()
+{
+    QRandomGenerator random(20240301);
+    QList<ParkingRecord> records;
+    for (int i = 0; i < RECORD_COUNT; ++i) {
+        ParkingRecord record(QString::fromUtf8("京A%1").arg(10000 + i), 1 + random.bounded(SPACE_COUNT));
+        QDateTime enter = baseTime().addSecs(random.bounded(DATA_DAYS * 24 * 3600));
+        record.setEnterTime(enter);
+        QVERIFY(ParkingRecordRepository::instance().insert(record));
+        records.append(record);
+        // 与索引一样包含之后被删除的记录，只作为上界
+        if (!m_latestEnter.isValid() || enter > m_latestEnter) {
+            m_latestEnter = enter;
+        }
+    }
+
+    for (ParkingRecord& record : records) {
+        int action = random.bounded(10);
+        if (action < 7) {
+            record.setExitTime(record.getEnterTime().addSecs(600 + random.bounded(8 * 3600)));
+            record.setFee(random.bounded(1, 20) * 5.0 + (random.bounded(2) ? 0.5 : 0.0));
+            QCOMPARE(ParkingRecordRepository::instance().compareAndUpdate(record), WRITE_OK);
+            if (action < 5) {
+                record.setIsPaid(true);
+                record.setPayTime(record.getExitTime());
+                record.setPayMethod("mobile");
+                QCOMPARE(ParkingRecordRepository::instance().compareAndUpdate(record), WRITE_OK);
+            }
+        } else if (action == 9) {
+            QVERIFY(ParkingRecordRepository::instance().remove(record.getId()));
+            continue;
+        }
+        m_enterTimes.append(record.getEnterTime());
+    }
+    std::sort(m_enterTimes.begin(), m_enterTimes.end());
+}
+
+RevenueIndex::Sums TestRevenueIndex::sqlSums(const QDateTime& startTime, const QDateTime& endTime)
+{
+    // 与报表按 enter_time 过滤的口径相同，金额逐条按分取整后求和
+    RevenueIndex::Sums sums;
+    QSqlQuery query(QSqlDatabase::database(ORACLE_CONNECTION));
+    query.prepare("SELECT COUNT(*), "
+                  "COALESCE(SUM(CASE WHEN is_paid THEN 1 ELSE 0 END), 0), "
+                  "COALESCE(SUM(CAST(ROUND(fee * 100) AS INTEGER)), 0), "
+                  "COALESCE(SUM(CASE WHEN is_paid THEN CAST(ROUND(fee * 100) AS INTEGER) ELSE 0 END), 0) "
+                  "FROM parking_records WHERE enter_time >= ? AND enter_time <= ?");
+    query.addBindValue(startTime);
+    query.addBindValue(endTime);
+    if (!query.exec() || !query.next()) {
+        qWarning("Oracle query failed: %s", qPrintable(query.lastError().text()));
+        return sums;
+    }
+    sums.entries = query.value(0).toLongLong();
+    sums.paidCount = query.value(1).toLongLong();
+    sums.billedCents = query.value(2).toLongLong();
+    sums.paidCents = query.value(3).toLongLong();
+    return sums;
+}
+
+RevenueIndex::Sums TestRevenueIndex::indexSums(const QDateTime& startTime, const QDateTime& endTime)
+{
+    RevenueIndex::Sums sums;
+    if (!RevenueIndex::instance().sumRange(startTime, endTime, sums)) {
+        qWarning("Revenue index is not loaded");
+    }
+    return sums;
+}
+
+void TestRevenueIndex::compareRange(const QDateTime& startTime, const QDateTime& endTime)
+{
+    RevenueIndex::Sums expected = sqlSums(startTime, endTime);
+    RevenueIndex::Sums actual = indexSums(startTime, endTime);
+    QCOMPARE(actual.entries, expected.entries);
+    QCOMPARE(actual.paidCount, expected.paidCount);
+    QCOMPARE(actual.billedCents, expected.billedCents);
+    QCOMPARE(actual.paidCents, expected.paidCents);
+}
+
+void TestRevenueIndex::matchesSql_data()
+{
+    QTest::addColumn<QDateTime>("startTime");
+    QTest::addColumn<QDateTime>("endTime");
+
+    QDateTime base = baseTime();
+    QDateTime first = m_enterTimes.first();
+    QDateTime middle = m_enterTimes.at(m_enterTimes.size() / 2);
+    QDateTime middleHour(middle.date(), QTime(middle.time().hour(), 0));
+
+    // 空范围
+    QTest::newRow("start after end") << base.addDays(3) << base.addDays(2);
+    QTest::newRow("before all records") << base.addDays(-3) << base.addSecs(-1);
+    QTest::newRow("after all records") << m_latestEnter.addSecs(1) << m_latestEnter.addDays(3);
+    QTest::newRow("instant without record") << first.addMSecs(-1) << first.addMSecs(-1);
+
+    // 单条记录、单个桶
+    QTest::newRow("instant at record") << middle << middle;
+    QTest::newRow("single bucket whole") << middleHour << middleHour.addSecs(3600).addMSecs(-1);
+    QTest::newRow("single bucket from record") << middle << middleHour.addSecs(3600).addMSecs(-1);
+    QTest::newRow("single bucket until record") << middleHour << middle;
+    QTest::newRow("single bucket inner") << middleHour.addSecs(60) << middleHour.addSecs(3540);
+
+    // 边界落在记录的进场时间上
+    QTest::newRow("starts at record") << middle << middle.addDays(2);
+    QTest::newRow("ends at record") << middle.addDays(-2) << middle;
+    QTest::newRow("ends at latest record") << base << m_latestEnter;
+    QTest::newRow("ends before latest record") << base << m_latestEnter.addMSecs(-1);
+    QTest::newRow("everything") << base.addDays(-1) << base.addDays(DATA_DAYS + 1);
+
+    int i = 0;
+    for (const auto& range : generateRanges(200, 42)) {
+        QTest::newRow(qPrintable(QString("random %1").arg(++i))) << range.first << range.second;
+    }
+}
+
+void TestRevenueIndex::matchesSql()
+{
+    QFETCH(QDateTime, startTime);
+    QFETCH(QDateTime, endTime);
+    compareRange(startTime, endTime);
+}
+
+// 整点起、终点不早于最晚进场时间的范围只做前缀和查询，不读取原始记录
+void TestRevenueIndex::wholeHoursReadOnlyIndex()
+{
+    QRandomGenerator random(7);
+    QDateTime base = baseTime();
+    QDateTime end = m_latestEnter.addSecs(3600);
+    qint64 scansBefore = RevenueIndex::instance().statistics().value("edgeScans").toVariant().toLongLong();
+    for (int i = 0; i < 100; ++i) {
+        QDateTime start = base.addSecs(qint64(random.bounded(-24, DATA_DAYS * 24 + 24)) * 3600);
+        compareRange(start, end);
+    }
+    qint64 scansAfter = RevenueIndex::instance().statistics().value("edgeScans").toVariant().toLongLong();
+    QCOMPARE(scansAfter, scansBefore);
+}
+
+// 由增量维护的 rollup_hourly 重新加载，结果不变
+void TestRevenueIndex::matchesSqlAfterReload()
+{
+    QVERIFY(RevenueIndex::instance().load());
+    for (const auto& range : generateRanges(200, 4242)) {
+        compareRange(range.first, range.second);
+        if (QTest::currentTestFailed()) {
+            qWarning("Range %s .. %s", qPrintable(range.first.toString(Qt::ISODateWithMs)),
+                     qPrintable(range.second.toString(Qt::ISODateWithMs)));
+            return;
+        }
+    }
+}
+
+void TestRevenueIndex::benchmarkSumRange()
+{
+    QVector<QPair<QDateTime, QDateTime>> ranges = generateRanges(100, 99);
+    QBENCHMARK {
+        for (const auto& range : ranges) {
+            RevenueIndex::Sums sums = indexSums(range.first, range.second);
+            Q_UNUSED(sums);
+        }
+    }
+}
+
+void TestRevenueIndex::benchmarkSql()
+{
+    QVector<QPair<QDateTime, QDateTime>> ranges = generateRanges(100, 99);
+    QBENCHMARK {
+        for (const auto& range : ranges) {
+            RevenueIndex::Sums sums = sqlSums(range.first, range.second);
+            Q_UNUSED(sums);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestRevenueIndex)
+
+#include "tst_revenueindex.moc"
@@ -0,0 +1,12 @@
+include(../tests.pri)
+
+TARGET = tst_spacesnapshot
+
+SOURCES += \
+    tst_spacesnapshot.cpp \
+    $$SRC_DIR/dao/SpaceSnapshot.cpp \
+    $$SRC_DIR/models/ParkingSpace.cpp
+
+HEADERS += \
+    $$SRC_DIR/dao/SpaceSnapshot.h \
+    $$SRC_DIR/models/ParkingSpace.h
@@ -0,0 +1,165 @@
+#include <QtTest>
+#include <QMap>
+#include <QRandomGenerator>
+#include "dao/SpaceSnapshot.h"
+
+namespace {
+
+ParkingSpace makeSpace(int id, ParkingSpace::Status status, int version)
+{
+    ParkingSpace space(id, QString("A-%1").arg(id), status);
+    space.setVersion(version);
+    return space;
+}
+
+ParkingSpace::Status statusAt(int i)
+{
+    static const ParkingSpace::Status statuses[] = {
+        ParkingSpace::AVAILABLE, ParkingSpace::OCCUPIED, ParkingSpace::RESERVED, ParkingSpace::DISABLED
+    };
+    return statuses[i % 4];
+}
+
+}
+
+class TestSpaceSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesModel();
+    void staleVersionIgnored();
+    void removalWinsOverStaleRefresh();
+    void removalWinsOverStaleRebuild();
+
+    void benchmarkPublish();
+
+private:
+    void compareWithModel(const QMap<int, ParkingSpace>& model);
+};
+
+void TestSpaceSnapshot::compareWithModel(const QMap<int, ParkingSpace>& model)
+{
+    std::shared_ptr<const SpaceSnapshot> snapshot = SpaceSnapshotStore::instance().current();
+    QVERIFY(snapshot);
+    QCOMPARE(snapshot->count(), model.size());
+
+    QList<ParkingSpace> all = snapshot->findAll();
+    QCOMPARE(all.size(), model.size());
+    int i = 0;
+    int counts[4] = {0, 0, 0, 0};
+    for (const ParkingSpace& expected : model) {
+        QCOMPARE(all.at(i).getId(), expected.getId());
+        QCOMPARE(all.at(i).getStatus(), expected.getStatus());
+        QCOMPARE(all.at(i).getVersion(), expected.getVersion());
+        QCOMPARE(snapshot->findById(expected.getId()).getVersion(), expected.getVersion());
+        counts[expected.getStatus()]++;
+        ++i;
+    }
+    for (int status = 0; status < 4; ++status) {
+        QCOMPARE(snapshot->countByStatus(statusAt(status)), counts[statusAt(status)]);
+        QCOMPARE(snapshot->findByStatus(statusAt(status)).size(), counts[statusAt(status)]);
+    }
+}
+
+// 随机的新增、更新和删除，覆盖块的拆分和删空
+void TestSpaceSnapshot::matchesModel()
+{
+    const int firstId = 1;
+    const int idRange = 3000;
+    QRandomGenerator random(32);
+
+    QMap<int, ParkingSpace> model;
+    QList<ParkingSpace> initial;
+    for (int id = firstId; id < firstId + idRange; id += 3) {
+        ParkingSpace space = makeSpace(id, statusAt(id), 0);
+        model.insert(id, space);
+        initial.append(space);
+    }
+    SpaceSnapshotStore::instance().rebuild(initial);
+    compareWithModel(model);
+
+    QSet<int> removed;
+    for (int step = 0; step < 20000; ++step) {
+        int id = firstId + random.bounded(idRange);
+        if (removed.contains(id)) {
+            continue;
+        }
+        if (random.bounded(10) == 0) {
+            SpaceSnapshotStore::instance().publishRemoval(id);
+            model.remove(id);
+            removed.insert(id);
+        } else {
+            int version = model.contains(id) ? model.value(id).getVersion() + 1 : 0;
+            ParkingSpace space = makeSpace(id, statusAt(random.bounded(4)), version);
+            SpaceSnapshotStore::instance().publish(space);
+            model.insert(id, space);
+        }
+        if (step % 1000 == 0) {
+            compareWithModel(model);
+            if (QTest::currentTestFailed()) {
+                return;
+            }
+        }
+    }
+    compareWithModel(model);
+}
+
+void TestSpaceSnapshot::staleVersionIgnored()
+{
+    const int id = 10001;
+    SpaceSnapshotStore::instance().publish(makeSpace(id, ParkingSpace::OCCUPIED, 5));
+    SpaceSnapshotStore::instance().publish(makeSpace(id, ParkingSpace::AVAILABLE, 4));
+    ParkingSpace space = SpaceSnapshotStore::instance().current()->findById(id);
+    QCOMPARE(space.getVersion(), 5);
+    QCOMPARE(space.getStatus(), ParkingSpace::OCCUPIED);
+}
+
+// 刷新在删除前读到了行，在删除发布之后才发布
+void TestSpaceSnapshot::removalWinsOverStaleRefresh()
+{
+    const int id = 10002;
+    SpaceSnapshotStore::instance().publish(makeSpace(id, ParkingSpace::AVAILABLE, 0));
+    ParkingSpace staleRow = makeSpace(id, ParkingSpace::AVAILABLE, 1);
+
+    SpaceSnapshotStore::instance().publishRemoval(id);
+    SpaceSnapshotStore::instance().publish(staleRow);
+    QCOMPARE(SpaceSnapshotStore::instance().current()->findById(id).getId(), 0);
+}
+
+// 全量重建在删除前读取了车位表
+void TestSpaceSnapshot::removalWinsOverStaleRebuild()
+{
+    const int id = 10003;
+    QList<ParkingSpace> staleRows = SpaceSnapshotStore::instance().current()->findAll();
+    staleRows.append(makeSpace(id, ParkingSpace::AVAILABLE, 0));
+    int expectedCount = staleRows.size() - 1;
+
+    SpaceSnapshotStore::instance().publishRemoval(id);
+    SpaceSnapshotStore::instance().rebuild(staleRows);
+    QCOMPARE(SpaceSnapshotStore::instance().current()->findById(id).getId(), 0);
+    QCOMPARE(SpaceSnapshotStore::instance().current()->count(), expectedCount);
+}
+
+// 单个车位更新的发布耗时，只复制块指针数组和一个块
+void TestSpaceSnapshot::benchmarkPublish()
+{
+    const int firstId = 20000;
+    const int count = 10000;
+    QList<ParkingSpace> spaces;
+    for (int i = 0; i < count; ++i) {
+        spaces.append(makeSpace(firstId + i, ParkingSpace::AVAILABLE, 0));
+    }
+    SpaceSnapshotStore::instance().rebuild(spaces);
+
+    int version = 0;
+    QBENCHMARK {
+        ++version;
+        SpaceSnapshotStore::instance().publish(makeSpace(firstId + count / 2, statusAt(version), version));
+    }
+    QCOMPARE(SpaceSnapshotStore::instance().current()->count(), count);
+}
+
+QTEST_APPLESS_MAIN(TestSpaceSnapshot)
+
+#include "tst_spacesnapshot.moc"
@@ -0,0 +1,8 @@
+# 各测试工程共用的配置，被测源码直接从主工程目录编译进测试程序
+QT += core testlib
+QT -= gui
+CONFIG += c++14 console testcase
+CONFIG -= app_bundle
+
+SRC_DIR = $$PWD/..
+INCLUDEPATH += $$SRC_DIR
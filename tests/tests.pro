@@ -0,0 +1,15 @@
+# 单元测试与基准测试
+# 构建并运行：qmake tests/tests.pro && make && make check
+# 基准测试（QBENCHMARK）随测试一起运行，单独运行某项：./tst_xxx benchmarkParse，可加 -iterations N / -callgrind 等 QTest 参数
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    plateid \
+    platevalidator \
+    jsonwriter \
+    jsonreader \
+    cbor \
+    revenueindex \
+    dashboard \
+    reportexecutor \
+    spacesnapshot
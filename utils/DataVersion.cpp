@@ -0,0 +1,18 @@
+#include "DataVersion.h"
+#include <QDateTime>
+
+DataVersion& DataVersion::instance()
+{
+    static DataVersion instance;
+    return instance;
+}
+
+DataVersion::DataVersion()
+    : m_version(static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000)
+{
+}
+
+QString DataVersion::etag(quint64 version)
+{
+    return QString("\"v%1\"").arg(version);
+}
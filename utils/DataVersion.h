@@ -0,0 +1,30 @@
+#ifndef DATAVERSION_H
+#define DATAVERSION_H
+
+#include <QAtomicInteger>
+#include <QString>
+
+// 全局数据版本：车位、停车记录、排队的每次写入后递增
+// 初值取启动时间（毫秒 x 1000），服务重启后版本号仍然单调，旧 ETag 不会误命中
+class DataVersion
+{
+public:
+    static DataVersion& instance();
+
+    quint64 current() const { return m_version.loadAcquire(); }
+
+    // 写入提交之后调用，返回新版本
+    quint64 bump() { return m_version.fetchAndAddOrdered(1) + 1; }
+
+    // 强 ETag，形如 "v1700000000000000"
+    static QString etag(quint64 version);
+
+private:
+    DataVersion();
+    DataVersion(const DataVersion&) = delete;
+    DataVersion& operator=(const DataVersion&) = delete;
+
+    QAtomicInteger<quint64> m_version;
+};
+
+#endif // DATAVERSION_H
@@ -0,0 +1,84 @@
+#include "GateLock.h"
+#include "PlateId.h"
+#include <QHash>
+#include <algorithm>
+
+namespace {
+
+// 车位与车牌使用不同的种子，避免两类键系统性地落在同一条带
+const uint SPACE_SEED = 0x5A17;
+const uint PLATE_SEED = 0x9E37;
+
+}
+
+GateLocks& GateLocks::instance()
+{
+    static GateLocks instance;
+    return instance;
+}
+
+int GateLocks::spaceStripe(int spaceId) const
+{
+    return qHash(spaceId, SPACE_SEED) % STRIPE_COUNT;
+}
+
+int GateLocks::plateStripe(const QString& plate) const
+{
+    PlateId id = PlateId::fromString(plate);
+    uint hash = id.isValid() ? qHash(id, PLATE_SEED) : qHash(plate, PLATE_SEED);
+    return hash % STRIPE_COUNT;
+}
+
+void GateLocks::lockStripes(const QVector<int>& stripes)
+{
+    for (int stripe : stripes) {
+        m_stripes[stripe].lock();
+    }
+}
+
+void GateLocks::unlockStripes(const QVector<int>& stripes)
+{
+    for (int i = stripes.size() - 1; i >= 0; --i) {
+        m_stripes[stripes[i]].unlock();
+    }
+}
+
+GateLocker::GateLocker(int spaceId)
+{
+    m_stripes.append(GateLocks::instance().spaceStripe(spaceId));
+    acquire();
+}
+
+GateLocker::GateLocker(const QString& plate)
+{
+    m_stripes.append(GateLocks::instance().plateStripe(plate));
+    acquire();
+}
+
+GateLocker::GateLocker(int spaceId, const QString& plate)
+{
+    m_stripes.append(GateLocks::instance().spaceStripe(spaceId));
+    m_stripes.append(GateLocks::instance().plateStripe(plate));
+    acquire();
+}
+
+GateLocker::~GateLocker()
+{
+    unlock();
+}
+
+void GateLocker::unlock()
+{
+    if (m_locked) {
+        GateLocks::instance().unlockStripes(m_stripes);
+        m_locked = false;
+    }
+}
+
+void GateLocker::acquire()
+{
+    std::sort(m_stripes.begin(), m_stripes.end());
+    m_stripes.erase(std::unique(m_stripes.begin(), m_stripes.end()), m_stripes.end());
+    GateLocks::instance().lockStripes(m_stripes);
+    m_locked = true;
+}
@@ -0,0 +1,56 @@
+#ifndef GATELOCK_H
+#define GATELOCK_H
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// 按车位ID和车牌分条带的锁，同一车位或同一车辆的出入口操作串行执行，
+// 无关操作可并行。多个条带总是按下标升序获取，避免死锁。
+// 条带锁不可重入：持有期间不得再调用会获取条带锁的方法。
+class GateLocks
+{
+public:
+    static GateLocks& instance();
+
+    int spaceStripe(int spaceId) const;
+    int plateStripe(const QString& plate) const;
+
+    // 按升序获取/按降序释放一组条带（调用方保证已去重排序）
+    void lockStripes(const QVector<int>& stripes);
+    void unlockStripes(const QVector<int>& stripes);
+
+    int stripeCount() const { return STRIPE_COUNT; }
+
+private:
+    GateLocks() = default;
+    GateLocks(const GateLocks&) = delete;
+    GateLocks& operator=(const GateLocks&) = delete;
+
+    static const int STRIPE_COUNT = 256;
+    QMutex m_stripes[STRIPE_COUNT];
+};
+
+// 条带锁的作用域持有者
+class GateLocker
+{
+public:
+    explicit GateLocker(int spaceId);
+    explicit GateLocker(const QString& plate);
+    GateLocker(int spaceId, const QString& plate);
+    ~GateLocker();
+
+    // 提前释放（例如在发出通知前）
+    void unlock();
+
+private:
+    GateLocker(const GateLocker&) = delete;
+    GateLocker& operator=(const GateLocker&) = delete;
+
+    void acquire();
+
+    QVector<int> m_stripes;
+    bool m_locked = false;
+};
+
+#endif // GATELOCK_H
@@ -0,0 +1,94 @@
+#include "PlateId.h"
+
+namespace {
+
+const ushort HAN_FIRST = 0x4E00;
+const ushort HAN_LAST = 0x9FA5;
+
+const int HAN_SHIFT = 41;
+const int LETTER_SHIFT = 36;
+const int SLOT_BITS = 6;
+const int SLOT_COUNT = 6;
+const quint64 SLOT_MASK = 0x3F;
+
+// '0'-'9' -> 1..10, 'A'-'Z' -> 11..36, 其他 -> 0
+inline quint64 encodeAlnum(ushort c)
+{
+    if (static_cast<ushort>(c - '0') < 10) return c - '0' + 1;
+    if (static_cast<ushort>(c - 'A') < 26) return c - 'A' + 11;
+    return 0;
+}
+
+inline ushort decodeAlnum(quint64 code)
+{
+    return code <= 10 ? static_cast<ushort>('0' + code - 1)
+                      : static_cast<ushort>('A' + code - 11);
+}
+
+inline int slotShift(int slot)
+{
+    return (SLOT_COUNT - 1 - slot) * SLOT_BITS;
+}
+
+}
+
+PlateId PlateId::fromString(const QString& plate)
+{
+    const int length = plate.size();
+    if (length < 7 || length > 8) {
+        return PlateId();
+    }
+
+    const ushort* chars = plate.utf16();
+
+    ushort han = chars[0];
+    if (han < HAN_FIRST || han > HAN_LAST) {
+        return PlateId();
+    }
+
+    ushort letter = chars[1];
+    if (static_cast<ushort>(letter - 'A') >= 26) {
+        return PlateId();
+    }
+
+    quint64 value = (static_cast<quint64>(han - HAN_FIRST + 1) << HAN_SHIFT)
+                  | (static_cast<quint64>(letter - 'A' + 1) << LETTER_SHIFT);
+
+    for (int i = 2; i < length; ++i) {
+        quint64 code = encodeAlnum(chars[i]);
+        if (code == 0) {
+            return PlateId();
+        }
+        value |= code << slotShift(i - 2);
+    }
+
+    return PlateId(value);
+}
+
+QString PlateId::toString() const
+{
+    if (!isValid()) {
+        return QString();
+    }
+
+    const int len = length();
+    QString plate(len, Qt::Uninitialized);
+    QChar* out = plate.data();
+
+    out[0] = QChar(static_cast<ushort>(HAN_FIRST + (m_value >> HAN_SHIFT) - 1));
+    out[1] = QChar(static_cast<ushort>('A' + ((m_value >> LETTER_SHIFT) & 0x1F) - 1));
+    for (int i = 2; i < len; ++i) {
+        out[i] = QChar(decodeAlnum((m_value >> slotShift(i - 2)) & SLOT_MASK));
+    }
+
+    return plate;
+}
+
+int PlateId::length() const
+{
+    if (!isValid()) {
+        return 0;
+    }
+    // 第6个槽为空时是7位普通车牌
+    return (m_value & SLOT_MASK) == 0 ? 7 : 8;
+}
@@ -0,0 +1,44 @@
+#ifndef PLATEID_H
+#define PLATEID_H
+
+#include <QString>
+#include <QHash>
+#include <QMetaType>
+
+// 车牌的紧凑64位表示
+// 布局（从高位到低位）：汉字偏移(15位) | 字母(5位) | 6个字母数字槽(各6位)
+// 编码保持与 QString 字典序一致，可直接用于排序和哈希
+class PlateId
+{
+public:
+    PlateId() : m_value(0) {}
+    explicit PlateId(quint64 value) : m_value(value) {}
+
+    // 解析：1个汉字 + 1个大写字母 + 5~6个大写字母或数字，否则返回无效ID
+    static PlateId fromString(const QString& plate);
+    QString toString() const;
+
+    bool isValid() const { return m_value != 0; }
+    quint64 value() const { return m_value; }
+    int length() const;
+
+    bool operator==(const PlateId& other) const { return m_value == other.m_value; }
+    bool operator!=(const PlateId& other) const { return m_value != other.m_value; }
+    bool operator<(const PlateId& other) const { return m_value < other.m_value; }
+    bool operator>(const PlateId& other) const { return m_value > other.m_value; }
+    bool operator<=(const PlateId& other) const { return m_value <= other.m_value; }
+    bool operator>=(const PlateId& other) const { return m_value >= other.m_value; }
+
+private:
+    quint64 m_value;
+};
+
+inline uint qHash(const PlateId& id, uint seed = 0)
+{
+    return qHash(id.value(), seed);
+}
+
+Q_DECLARE_TYPEINFO(PlateId, Q_PRIMITIVE_TYPE);
+Q_DECLARE_METATYPE(PlateId)
+
+#endif // PLATEID_H
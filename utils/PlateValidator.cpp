@@ -0,0 +1,186 @@
+#include "PlateValidator.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+const ushort HAN_FIRST = 0x4E00;
+const ushort HAN_LAST = 0x9FA5;
+
+// 全角 ASCII 区间及与半角的偏移
+const ushort FULLWIDTH_FIRST = 0xFF01;
+const ushort FULLWIDTH_LAST = 0xFF5E;
+const ushort FULLWIDTH_OFFSET = 0xFEE0;
+const ushort IDEOGRAPHIC_SPACE = 0x3000;
+const ushort MIDDLE_DOT = 0x00B7;
+
+// ASCII 字符类别
+enum CharClass : quint8 {
+    CLASS_DIGIT = 0x01,
+    CLASS_UPPER = 0x02,
+    CLASS_ENERGY = 0x04,     // 新能源标识 D/F
+    CLASS_SEPARATOR = 0x08   // 规范化时去除的分隔符
+};
+
+struct AsciiTable {
+    quint8 classes[128];
+
+    AsciiTable() : classes{}
+    {
+        for (int c = '0'; c <= '9'; ++c) classes[c] |= CLASS_DIGIT;
+        for (int c = 'A'; c <= 'Z'; ++c) classes[c] |= CLASS_UPPER;
+        classes['D'] |= CLASS_ENERGY;
+        classes['F'] |= CLASS_ENERGY;
+        classes[' '] |= CLASS_SEPARATOR;
+        classes['\t'] |= CLASS_SEPARATOR;
+        classes['-'] |= CLASS_SEPARATOR;
+        classes['.'] |= CLASS_SEPARATOR;
+    }
+};
+
+const AsciiTable& asciiTable()
+{
+    static const AsciiTable table;
+    return table;
+}
+
+inline bool hasClass(ushort c, quint8 mask)
+{
+    return c < 128 && (asciiTable().classes[c] & mask) != 0;
+}
+
+inline bool isUpper(ushort c) { return hasClass(c, CLASS_UPPER); }
+inline bool isDigit(ushort c) { return hasClass(c, CLASS_DIGIT); }
+inline bool isAlnum(ushort c) { return hasClass(c, CLASS_UPPER | CLASS_DIGIT); }
+inline bool isEnergyMark(ushort c) { return hasClass(c, CLASS_ENERGY); }
+
+// 省份简称，按码位升序排列以便二分查找
+const ushort PROVINCES[] = {
+    0x4E91, // 云
+    0x4EAC, // 京
+    0x5180, // 冀
+    0x5409, // 吉
+    0x5B81, // 宁
+    0x5DDD, // 川
+    0x65B0, // 新
+    0x664B, // 晋
+    0x6842, // 桂
+    0x6CAA, // 沪
+    0x6D25, // 津
+    0x6D59, // 浙
+    0x6E1D, // 渝
+    0x6E58, // 湘
+    0x743C, // 琼
+    0x7518, // 甘
+    0x7696, // 皖
+    0x7CA4, // 粤
+    0x82CF, // 苏
+    0x8499, // 蒙
+    0x85CF, // 藏
+    0x8C6B, // 豫
+    0x8D35, // 贵
+    0x8D63, // 赣
+    0x8FBD, // 辽
+    0x9102, // 鄂
+    0x95FD, // 闽
+    0x9655, // 陕
+    0x9752, // 青
+    0x9C81, // 鲁
+    0x9ED1  // 黑
+};
+
+}
+
+bool PlateValidator::isValidClassic(const QString& plate)
+{
+    // 原正则的 $ 也匹配末尾单个换行符之前的位置，这里保持一致
+    int size = plate.size();
+    const ushort* chars = plate.utf16();
+    if (size == 8 && chars[7] == '\n') {
+        size = 7;
+    }
+    if (size != 7) {
+        return false;
+    }
+
+    if (chars[0] < HAN_FIRST || chars[0] > HAN_LAST || !isUpper(chars[1])) {
+        return false;
+    }
+
+    for (int i = 2; i < 7; ++i) {
+        if (!isAlnum(chars[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PlateValidator::isNewEnergy(const QString& plate)
+{
+    if (plate.size() != 8) {
+        return false;
+    }
+
+    const ushort* chars = plate.utf16();
+    if (!isProvincePrefix(QChar(chars[0])) || !isUpper(chars[1])) {
+        return false;
+    }
+
+    // 小型车：D/F + 字母或数字 + 4位数字
+    if (isEnergyMark(chars[2])) {
+        if (!isAlnum(chars[3])) {
+            return false;
+        }
+        for (int i = 4; i < 8; ++i) {
+            if (!isDigit(chars[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 大型车：5位数字 + D/F
+    for (int i = 2; i < 7; ++i) {
+        if (!isDigit(chars[i])) {
+            return false;
+        }
+    }
+    return isEnergyMark(chars[7]);
+}
+
+bool PlateValidator::isValid(const QString& plate)
+{
+    return isValidClassic(plate) || isNewEnergy(plate);
+}
+
+bool PlateValidator::isProvincePrefix(QChar c)
+{
+    return std::binary_search(std::begin(PROVINCES), std::end(PROVINCES), c.unicode());
+}
+
+QString PlateValidator::normalize(const QString& plate)
+{
+    QString result;
+    result.reserve(plate.size());
+
+    for (QChar ch : plate) {
+        ushort c = ch.unicode();
+
+        if (c >= FULLWIDTH_FIRST && c <= FULLWIDTH_LAST) {
+            c -= FULLWIDTH_OFFSET;
+        } else if (c == IDEOGRAPHIC_SPACE) {
+            c = ' ';
+        }
+
+        // 空白按 QChar::isSpace 判定，包括导入数据和扫码枪输入末尾的 \r、\n
+        if (c == MIDDLE_DOT || hasClass(c, CLASS_SEPARATOR) || QChar(c).isSpace()) {
+            continue;
+        }
+        if (c >= 'a' && c <= 'z') {
+            c -= 'a' - 'A';
+        }
+        result.append(QChar(c));
+    }
+
+    return result;
+}
@@ -0,0 +1,31 @@
+#ifndef PLATEVALIDATOR_H
+#define PLATEVALIDATOR_H
+
+#include <QString>
+#include <QChar>
+
+// 车牌校验与规范化（查表实现，不依赖正则）
+class PlateValidator
+{
+public:
+    // 普通车牌：1个汉字 + 1个大写字母 + 5个大写字母或数字
+    // 与原正则 ^[\x{4e00}-\x{9fa5}][A-Z][A-Z0-9]{5}$ 判定完全一致（含 $ 接受末尾单个换行符）
+    static bool isValidClassic(const QString& plate);
+
+    // 新能源车牌：省份简称 + 1个大写字母 + 6位（D/F + 字母数字 + 4位数字，或 5位数字 + D/F）
+    static bool isNewEnergy(const QString& plate);
+
+    // 普通车牌或新能源车牌
+    static bool isValid(const QString& plate);
+
+    // 是否为省份简称
+    static bool isProvincePrefix(QChar c);
+
+    // 规范化：去除全部空白（QChar::isSpace，含换行回车）和分隔符，全角转半角，字母转大写
+    static QString normalize(const QString& plate);
+
+private:
+    PlateValidator() = default;
+};
+
+#endif // PLATEVALIDATOR_H